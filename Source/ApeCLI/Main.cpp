@@ -2,8 +2,15 @@
 // Licensed under GPLv3+
 // Refer to the LICENSE file included.
 
+#include <iomanip>
 #include <iostream>
+#include <stdexcept>
 
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/Exception.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/JIT.h"
 #include "Core/HW/FloppyDrive.h"
 #include "Core/Core.h"
 #include "Version.h"
@@ -21,6 +28,13 @@ int main(int argc, char** argv)
   p.AddString("floppy");
   p.AddString("com");
   p.AddCommand("help");
+  p.AddCommand("stats");
+  p.AddCommand("no-icache");
+  p.AddCommand("no-threading");
+  p.AddCommand("jit");
+  p.AddCommand("jit-lockstep");
+  p.AddCommand("unthrottled");
+  p.AddString("speed");
 
   if (!p.Parse(argc, argv)) {
     std::cerr << "Bad parameters provided. See --help" << std::endl;
@@ -28,30 +42,89 @@ int main(int argc, char** argv)
   }
 
   if (p.CheckCommand("help")) {
-    std::cerr << argv[0] << " (--floppy/--com) [file]" << std::endl;
+    std::cerr << argv[0] << " (--floppy/--com) [file] [--stats] [--no-icache]"
+              << " [--no-threading] [--jit] [--jit-lockstep] [--unthrottled]"
+              << " [--speed multiplier]" << std::endl;
 
     return 1;
   }
 
-  if (p.GetString("floppy") != "") {
+  Core::CPU::use_instruction_cache = !p.CheckCommand("no-icache");
+  Core::CPU::dispatch_mode = p.CheckCommand("no-threading")
+                                 ? Core::CPU::DispatchMode::Switch
+                                 : Core::CPU::DispatchMode::Threaded;
+  Core::CPU::jit_lockstep = p.CheckCommand("jit-lockstep");
+  Core::CPU::use_jit = p.CheckCommand("jit") || Core::CPU::jit_lockstep;
+  Core::CPU::unthrottled = p.CheckCommand("unthrottled");
 
-    if (!Core::HW::FloppyDrive::Insert(p.GetString("floppy"))) {
-      std::cerr << "Failed to mount floppy image " << argv[1] << "!"
+  if (p.GetString("speed") != "") {
+    double speed = 0;
+
+    try {
+      speed = std::stod(p.GetString("speed"));
+    } catch (const std::logic_error&) {
+    }
+
+    if (!(speed > 0)) {
+      std::cerr << "Bad speed multiplier " << p.GetString("speed") << "!"
                 << std::endl;
       return 1;
     }
 
-    if (!Core::HW::FloppyDrive::IsBootable()) {
-      std::cerr << argv[1] << " is not a bootable floppy image." << std::endl;
+    Core::CPU::speed_multiplier = speed;
+  }
+
+  bool success = false;
+
+  // Faults are only turned into exceptions once they leave the core
+  try {
+    if (p.GetString("floppy") != "") {
+
+      if (!Core::HW::FloppyDrive::Insert(p.GetString("floppy"))) {
+        std::cerr << "Failed to mount floppy image " << argv[1] << "!"
+                  << std::endl;
+        return 1;
+      }
+
+      if (!Core::HW::FloppyDrive::IsBootable()) {
+        std::cerr << argv[1] << " is not a bootable floppy image."
+                  << std::endl;
+        return 1;
+      }
+
+      success = Core::BootFloppy();
+    } else if (p.GetString("com") != "") {
+      success = Core::BootCOM(p.GetString("com"));
+    } else {
+      std::cerr << "Nothing to do! See --help" << std::endl;
       return 1;
     }
-
-    return Core::BootFloppy() ? 0 : 1;
-  } else if (p.GetString("com") != "") {
-    return !Core::BootCOM(p.GetString("com"));
+  } catch (const Core::CPU::CPUException& e) {
+    std::cerr << "A fatal error occurred and emulation cannot continue: "
+              << e.what() << std::endl;
   }
 
-  std::cerr << "Nothing to do! See --help" << std::endl;
+  if (p.CheckCommand("stats")) {
+    std::cerr << "Effective speed: " << std::fixed << std::setprecision(2)
+              << Core::CPU::GetEffectiveSpeed() / 1e6 << " MHz" << std::endl
+              << std::defaultfloat;
+
+    const auto stats = Core::CPU::GetInstructionCacheStats();
+
+    std::cerr << "Instruction cache: " << stats.hits << " hits, "
+              << stats.misses << " misses, " << stats.invalidations
+              << " invalidations" << std::endl;
+
+    if (Core::CPU::use_jit) {
+      const auto jit = Core::CPU::GetJITStats();
+
+      std::cerr << "JIT: " << jit.translations << " blocks translated, "
+                << jit.executions << " executed (" << jit.instructions
+                << " instructions), " << jit.links << " links, "
+                << jit.invalidations << " invalidations, " << jit.flushes
+                << " flushes" << std::endl;
+    }
+  }
 
-  return 1;
+  return success ? 0 : 1;
 }
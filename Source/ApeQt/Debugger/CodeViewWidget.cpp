@@ -4,10 +4,14 @@
 
 #include "ApeQt/Debugger/CodeViewWidget.h"
 
+#include <array>
 #include <cmath>
 
 #include <QHeaderView>
+#include <QInputDialog>
+#include <QLineEdit>
 #include <QMenu>
+#include <QMessageBox>
 #include <QTableWidgetItem>
 
 #include "ApeQt/QueueOnObject.h"
@@ -60,25 +64,25 @@ void CodeViewWidget::Update()
   for (int i = 0; i < rows; i++) {
     u16 base = offset;
     auto ins =
-        Core::CPU::Instruction(Core::Memory::Get<u8>(segment, offset++), base);
+        Core::CPU::Instruction(Core::Memory::Peek<u8>(segment, offset++), base);
 
     QString ins_str = tr("Unresolved");
 
-    if (ins.IsPrefix())
+    while (ins.IsPrefix())
       ins = Core::CPU::Instruction(
-          ins, Core::Memory::Get<u8>(segment, offset++), base);
+          ins, Core::Memory::Peek<u8>(segment, offset++), base);
 
     if (!ins.IsResolved()) {
-      u8 mod = static_cast<u8>(Core::Memory::Get<u8>(segment, offset++));
+      u8 mod = static_cast<u8>(Core::Memory::Peek<u8>(segment, offset++));
       u8 length = ins.GetLength(mod);
 
-      std::vector<u8> ins_data;
+      std::array<u8, Core::CPU::Instruction::MAX_DATA_LENGTH> ins_data;
 
       for (u16 j = 0; j < length; j++) {
-        ins_data.push_back(Core::Memory::Get<u8>(segment, offset++));
+        ins_data[j] = Core::Memory::Peek<u8>(segment, offset++);
       }
 
-      ins.Resolve(mod, ins_data);
+      ins.Resolve(mod, ins_data.data());
     }
 
     ins_str = QString::fromStdString(ins.ToString());
@@ -173,6 +177,54 @@ void CodeViewWidget::OnContextMenu()
     Update();
   });
 
+  menu->addAction(tr("Add conditional breakpoint..."), this,
+                  [this, segment, offset] {
+                    bool ok = false;
+                    const QString condition = QInputDialog::getText(
+                        this, tr("Conditional breakpoint"),
+                        tr("Break when (e.g. ax == 0x4c00):"),
+                        QLineEdit::Normal, QString(), &ok);
+
+                    if (!ok)
+                      return;
+
+                    std::string error;
+
+                    if (!Core::CPU::AddConditionalBreakpoint(
+                            {segment, offset}, condition.toStdString(),
+                            &error))
+                      QMessageBox::warning(this, tr("Invalid condition"),
+                                           QString::fromStdString(error));
+
+                    Update();
+                  });
+
+  menu->addAction(tr("Add tracepoint..."), this, [this, segment, offset] {
+    bool ok = false;
+    const QString values = QInputDialog::getText(
+        this, tr("Tracepoint"), tr("Values to record (e.g. ds, si):"),
+        QLineEdit::Normal, QString(), &ok);
+
+    if (!ok)
+      return;
+
+    const QString condition = QInputDialog::getText(
+        this, tr("Tracepoint"), tr("Only when (may be empty):"),
+        QLineEdit::Normal, QString(), &ok);
+
+    if (!ok)
+      return;
+
+    std::string error;
+
+    if (!Core::CPU::AddTracepoint({segment, offset}, condition.toStdString(),
+                                  values.toStdString(), &error))
+      QMessageBox::warning(this, tr("Invalid tracepoint"),
+                           QString::fromStdString(error));
+
+    Update();
+  });
+
   menu->addSeparator();
 
   menu->addAction(tr("Update"), this, &CodeViewWidget::Update);
@@ -6,6 +6,7 @@
 
 #include <cmath>
 
+#include <QCheckBox>
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QHBoxLayout>
@@ -14,6 +15,7 @@
 #include <QPushButton>
 #include <QSettings>
 #include <QSplitter>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
 
@@ -24,6 +26,7 @@
 #include "Core/CPU/Breakpoint.h"
 #include "Core/CPU/CPU.h"
 #include "Core/CPU/Instruction.h"
+#include "Core/CPU/Watchpoint.h"
 #include "Core/Memory.h"
 
 CodeWidget::CodeWidget()
@@ -36,6 +39,11 @@ CodeWidget::CodeWidget()
   Core::CPU::RegisterStateChangedCallback(
       [this](Core::CPU::State) { QueueOnObject(this, [this] { Update(); }); });
 
+  // Tracepoints don't pause, so nothing tells when they recorded something
+  m_trace_timer = new QTimer(this);
+  connect(m_trace_timer, &QTimer::timeout, this, &CodeWidget::UpdateTrace);
+  m_trace_timer->start(250);
+
   Update();
 }
 
@@ -79,6 +87,18 @@ void CodeWidget::CreateWidgets()
 
   splitter->addWidget(m_code_view);
   splitter->addWidget(stack_box);
+  splitter->addWidget(CreateWatchpointWidgets());
+
+  auto* trace_box = new QGroupBox(tr("Trace"));
+  auto* trace_layout = new QVBoxLayout;
+
+  trace_box->setLayout(trace_layout);
+
+  m_trace_list = new QListWidget;
+
+  trace_layout->addWidget(m_trace_list);
+
+  splitter->addWidget(trace_box);
 
   layout->addLayout(jump_layout);
   layout->addWidget(splitter);
@@ -86,6 +106,85 @@ void CodeWidget::CreateWidgets()
   setWidget(widget);
 }
 
+QWidget* CodeWidget::CreateWatchpointWidgets()
+{
+  auto* watch_box = new QGroupBox(tr("Watchpoints"));
+  auto* watch_layout = new QVBoxLayout;
+  auto* add_layout = new QHBoxLayout;
+  auto* flags_layout = new QHBoxLayout;
+
+  watch_box->setLayout(watch_layout);
+
+  m_watch_list = new QListWidget;
+  m_watch_segment_spin = new DebugSpinBox(sizeof(u16));
+  m_watch_offset_spin = new DebugSpinBox(sizeof(u16));
+  m_watch_size_spin = new DebugSpinBox(sizeof(u16));
+  m_watch_read = new QCheckBox(tr("Read"));
+  m_watch_write = new QCheckBox(tr("Write"));
+  m_watch_change = new QCheckBox(tr("Change"));
+  m_watch_hit_label = new QLabel;
+
+  m_watch_size_spin->setMinimum(1);
+  m_watch_write->setChecked(true);
+
+  auto* add_btn = new QPushButton(tr("Add"));
+  auto* remove_btn = new QPushButton(tr("Remove"));
+
+  connect(add_btn, &QPushButton::pressed, this, [this] {
+    u8 flags = 0;
+
+    if (m_watch_read->isChecked())
+      flags |= Core::CPU::WATCH_READ;
+    if (m_watch_write->isChecked())
+      flags |= Core::CPU::WATCH_WRITE;
+    if (m_watch_change->isChecked())
+      flags |= Core::CPU::WATCH_CHANGE;
+
+    if (flags == 0)
+      return;
+
+    Core::CPU::AddWatchpoint(
+        {Core::Memory::VirtToPhys(
+             static_cast<u16>(m_watch_segment_spin->value()),
+             static_cast<u16>(m_watch_offset_spin->value())),
+         static_cast<u32>(m_watch_size_spin->value()), flags});
+
+    UpdateWatchpoints();
+  });
+
+  connect(remove_btn, &QPushButton::pressed, this, [this] {
+    const int row = m_watch_list->currentRow();
+    const auto watchpoints = Core::CPU::GetWatchpoints();
+
+    if (row < 0 || row >= static_cast<int>(watchpoints.size()))
+      return;
+
+    Core::CPU::RemoveWatchpoint(watchpoints[row]);
+    UpdateWatchpoints();
+  });
+
+  add_layout->addWidget(m_watch_segment_spin);
+  add_layout->addWidget(new QLabel(":"));
+  add_layout->addWidget(m_watch_offset_spin);
+  add_layout->addWidget(new QLabel(tr("Size")));
+  add_layout->addWidget(m_watch_size_spin);
+  add_layout->addStretch();
+
+  flags_layout->addWidget(m_watch_read);
+  flags_layout->addWidget(m_watch_write);
+  flags_layout->addWidget(m_watch_change);
+  flags_layout->addStretch();
+  flags_layout->addWidget(add_btn);
+  flags_layout->addWidget(remove_btn);
+
+  watch_layout->addWidget(m_watch_list);
+  watch_layout->addLayout(add_layout);
+  watch_layout->addLayout(flags_layout);
+  watch_layout->addWidget(m_watch_hit_label);
+
+  return watch_box;
+}
+
 void CodeWidget::closeEvent(QCloseEvent*)
 {
   QSettings().setValue("debug/showcode", false);
@@ -106,9 +205,76 @@ void CodeWidget::Update()
         QStringLiteral("%1:%2 %3")
             .arg(Core::CPU::SS, 4, 16, QLatin1Char('0'))
             .arg(Core::CPU::SP + i * sizeof(u16), 4, 16, QLatin1Char('0'))
-            .arg(Core::Memory::Get<u16>(
+            .arg(Core::Memory::Peek<u16>(
                      Core::CPU::SS,
                      static_cast<u16>(Core::CPU::SP + i * sizeof(u16))),
                  4, 16, QLatin1Char('0'))));
   }
+
+  UpdateWatchpoints();
+}
+
+static QString WatchFlagsToString(u8 flags)
+{
+  QString string;
+
+  string += QLatin1Char(flags & Core::CPU::WATCH_READ ? 'r' : '-');
+  string += QLatin1Char(flags & Core::CPU::WATCH_WRITE ? 'w' : '-');
+  string += QLatin1Char(flags & Core::CPU::WATCH_CHANGE ? 'c' : '-');
+
+  return string;
+}
+
+void CodeWidget::UpdateWatchpoints()
+{
+  m_watch_list->clear();
+
+  for (const auto& w : Core::CPU::GetWatchpoints()) {
+    m_watch_list->addItem(new QListWidgetItem(
+        QStringLiteral("%1 +%2 %3")
+            .arg(w.address, 5, 16, QLatin1Char('0'))
+            .arg(w.size, 0, 16)
+            .arg(WatchFlagsToString(w.flags))));
+  }
+
+  const auto hit = Core::CPU::GetLastWatchpointHit();
+
+  if (!hit) {
+    m_watch_hit_label->clear();
+    return;
+  }
+
+  m_watch_hit_label->setText(
+      tr("Last hit: %1 by %2:%3 (%4)")
+          .arg(hit->watchpoint.address, 5, 16, QLatin1Char('0'))
+          .arg(hit->segment, 4, 16, QLatin1Char('0'))
+          .arg(hit->offset, 4, 16, QLatin1Char('0'))
+          .arg(WatchFlagsToString(hit->access)));
+}
+
+void CodeWidget::UpdateTrace()
+{
+  // Keep the list from growing without bounds
+  constexpr int MAX_TRACE_ITEMS = 1000;
+
+  const auto records = Core::CPU::TakeTraceRecords();
+
+  if (records.empty())
+    return;
+
+  for (const auto& record : records) {
+    QString text = QStringLiteral("%1:%2")
+                       .arg(record.segment, 4, 16, QLatin1Char('0'))
+                       .arg(record.offset, 4, 16, QLatin1Char('0'));
+
+    for (u8 i = 0; i < record.count; i++)
+      text += QStringLiteral(" %1").arg(record.values[i], 0, 16);
+
+    m_trace_list->addItem(text);
+  }
+
+  while (m_trace_list->count() > MAX_TRACE_ITEMS)
+    delete m_trace_list->takeItem(0);
+
+  m_trace_list->scrollToBottom();
 }
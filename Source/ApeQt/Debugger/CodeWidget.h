@@ -9,9 +9,12 @@
 #include "Common/Types.h"
 
 class CodeViewWidget;
+class QCheckBox;
+class QLabel;
 class QListWidget;
 class QResizeEvent;
 class QSpinBox;
+class QTimer;
 
 class CodeWidget : public QDockWidget
 {
@@ -29,8 +32,23 @@ private:
   QSpinBox* m_segment_spin;
   QSpinBox* m_offset_spin;
 
+  QListWidget* m_watch_list;
+  QSpinBox* m_watch_segment_spin;
+  QSpinBox* m_watch_offset_spin;
+  QSpinBox* m_watch_size_spin;
+  QCheckBox* m_watch_read;
+  QCheckBox* m_watch_write;
+  QCheckBox* m_watch_change;
+  QLabel* m_watch_hit_label;
+
+  QListWidget* m_trace_list;
+  QTimer* m_trace_timer;
+
   CodeViewWidget* m_code_view;
 
+  QWidget* CreateWatchpointWidgets();
   void CreateWidgets();
   void Update();
+  void UpdateWatchpoints();
+  void UpdateTrace();
 };
@@ -69,18 +69,39 @@ QSpinBox* RegisterWidget::Get8BitInput(u8* value)
   return spin;
 }
 
-QCheckBox* RegisterWidget::GetFlagInput(QString label, bool* value)
+// Reading a lazily computed flag the usual way derives it, which writes to the
+// CPU state
+static bool PeekFlag(const bool* flag) { return *flag; }
+
+template <u8 BIT> static bool PeekFlag(const Core::CPU::LazyFlag<BIT>* flag)
+{
+  return flag->Peek();
+}
+
+// Flags are either plain bools or lazily computed ones. They're only touched
+// while the CPU isn't running, it owns them otherwise
+template <typename Flag>
+QCheckBox* RegisterWidget::GetFlagInput(QString label, Flag* value)
 {
   auto* check = new QCheckBox(label);
 
-  check->setChecked(*value);
+  check->setChecked(PeekFlag(value));
 
   connect(this, &RegisterWidget::OnUpdate, this, [check, value] {
+    const bool running = Core::CPU::GetState() == Core::CPU::State::Running;
+
+    check->setEnabled(!running);
+
+    if (running)
+      return;
+
     QSignalBlocker blocker(check);
-    check->setChecked(*value);
+    check->setChecked(PeekFlag(value));
+  });
+  connect(check, &QCheckBox::toggled, this, [check, value] {
+    if (Core::CPU::GetState() != Core::CPU::State::Running)
+      *value = check->isChecked();
   });
-  connect(check, &QCheckBox::toggled, this,
-          [check, value] { *value = check->isChecked(); });
 
   return check;
 }
@@ -30,5 +30,5 @@ private:
 
   QSpinBox* Get16BitInput(u16* value);
   QSpinBox* Get8BitInput(u8* value);
-  QCheckBox* GetFlagInput(QString label, bool* value);
+  template <typename Flag> QCheckBox* GetFlagInput(QString label, Flag* value);
 };
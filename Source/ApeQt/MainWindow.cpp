@@ -7,6 +7,7 @@
 #include <memory>
 #include <random>
 
+#include <QActionGroup>
 #include <QFileDialog>
 #include <QLabel>
 #include <QMenuBar>
@@ -15,6 +16,7 @@
 #include <QSettings>
 #include <QStackedWidget>
 #include <QStatusBar>
+#include <QTimer>
 
 #include "ApeQt/Debugger/CodeWidget.h"
 #include "ApeQt/Debugger/RegisterWidget.h"
@@ -86,6 +88,34 @@ void MainWindow::CreateWidgets()
   m_machine_stop->setEnabled(false);
   m_machine_pause->setEnabled(false);
 
+  auto* speed_menu = machine_menu->addMenu(tr("Speed"));
+  auto* speed_group = new QActionGroup(this);
+
+  // 0 stands for unthrottled
+  const double speed = QSettings().value("cpu/speed", 1.0).toDouble();
+
+  for (const double multiplier : {0.5, 1.0, 2.0, 4.0, 0.0}) {
+    auto* action = speed_menu->addAction(
+        multiplier == 0 ? tr("Unthrottled")
+                        : tr("%1%").arg(static_cast<int>(multiplier * 100)));
+
+    action->setCheckable(true);
+    action->setChecked(multiplier == speed);
+    speed_group->addAction(action);
+
+    connect(action, &QAction::triggered, this, [multiplier] {
+      Core::CPU::unthrottled = multiplier == 0;
+
+      if (multiplier != 0)
+        Core::CPU::speed_multiplier = multiplier;
+
+      QSettings().setValue("cpu/speed", multiplier);
+    });
+
+    if (multiplier == speed)
+      action->trigger();
+  }
+
   auto* debug_menu = m_menu_bar->addMenu(tr("Debug"));
 
   auto* pause_on_boot = debug_menu->addAction(tr("Pause on Boot"));
@@ -139,8 +169,15 @@ void MainWindow::CreateWidgets()
   m_status_bar = new QStatusBar;
   m_status_label = new QLabel(tr("Ready"));
 
+  m_speed_label = new QLabel;
+
+  m_status_bar->addPermanentWidget(m_speed_label);
   m_status_bar->addPermanentWidget(m_status_label);
 
+  m_speed_timer = new QTimer(this);
+
+  connect(m_speed_timer, &QTimer::timeout, this, &MainWindow::UpdateSpeed);
+
   ShowStatus(tr("Welcome to Ape!"), 5000);
 
   setStatusBar(m_status_bar);
@@ -225,6 +262,12 @@ void MainWindow::StopMachine()
 
 void MainWindow::PauseMachine() { Core::Pause(); }
 
+void MainWindow::UpdateSpeed()
+{
+  m_speed_label->setText(
+      tr("%1 MHz").arg(Core::CPU::GetEffectiveSpeed() / 1e6, 0, 'f', 2));
+}
+
 void MainWindow::OnMachineStateChanged(Core::CPU::State state)
 {
   QString msg;
@@ -248,6 +291,13 @@ void MainWindow::OnMachineStateChanged(Core::CPU::State state)
     m_machine_pause->setText(state == Core::CPU::State::Paused ? tr("Resume")
                                                                : tr("Pause"));
     m_status_label->setText(msg);
+
+    if (state == Core::CPU::State::Running) {
+      m_speed_timer->start(500);
+    } else {
+      m_speed_timer->stop();
+      m_speed_label->clear();
+    }
   });
 }
 
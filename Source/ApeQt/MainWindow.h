@@ -19,6 +19,7 @@ class QAction;
 class QLabel;
 class QMenuBar;
 class QStatusBar;
+class QTimer;
 
 class MainWindow : public QMainWindow
 {
@@ -39,6 +40,7 @@ private:
 
   void StopMachine();
   void PauseMachine();
+  void UpdateSpeed();
 
   void HandleException(Core::CPU::CPUException e);
   void ShowStatus(const QString& status, int timeout = 0);
@@ -53,6 +55,8 @@ private:
 
   QStatusBar* m_status_bar;
   QLabel* m_status_label;
+  QLabel* m_speed_label;
+  QTimer* m_speed_timer;
 
   CodeWidget* m_code_widget;
   RegisterWidget* m_register_widget;
@@ -18,7 +18,7 @@ bool ParameterParser::Parse(int argc, char** argv)
     if (parameter.find('=') != std::string::npos) {
       value = parameter.substr(parameter.find('=') + 1);
       parameter = parameter.substr(0, parameter.find('='));
-    } else if (i + 1 < argc) {
+    } else if (i + 1 < argc && std::string(argv[i + 1]).substr(0, 2) != "--") {
       value = argv[++i];
     }
 
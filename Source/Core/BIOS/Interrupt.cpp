@@ -4,6 +4,8 @@
 
 #include "Core/CPU/CPU.h"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 
@@ -17,6 +19,39 @@
 
 using namespace Core;
 
+// Polls closer together than this belong to the same loop. Cycles spent
+// idling in between don't count, the guest didn't do anything else then
+constexpr u64 IDLE_POLL_DISTANCE = 10'000;
+// Polls in a row before the loop is considered idle
+constexpr u32 IDLE_POLL_THRESHOLD = 16;
+constexpr std::chrono::microseconds MIN_IDLE_TIME{500};
+constexpr std::chrono::microseconds MAX_IDLE_TIME{16'000};
+
+static u64 s_last_poll = 0;
+static u32 s_idle_polls = 0;
+static std::chrono::microseconds s_idle_time = MIN_IDLE_TIME;
+
+// Programs waiting for a key press tend to poll INT 16h AH=01 in a tight
+// loop. Once that's all they seem to do, give the host a break, which gets
+// longer the longer nothing happens
+static void DetectIdlePolling()
+{
+  const u64 busy_cycles = CPU::cycles - CPU::idle_cycles;
+
+  if (busy_cycles - s_last_poll > IDLE_POLL_DISTANCE) {
+    s_idle_polls = 0;
+    s_idle_time = MIN_IDLE_TIME;
+  }
+
+  s_last_poll = busy_cycles;
+
+  if (++s_idle_polls < IDLE_POLL_THRESHOLD)
+    return;
+
+  CPU::RequestIdle(s_idle_time);
+  s_idle_time = std::min(s_idle_time * 2, MAX_IDLE_TIME);
+}
+
 bool CPU::CallBIOSInterrupt(u8 vector)
 {
   switch (vector) {
@@ -52,7 +87,8 @@ bool CPU::CallBIOSInterrupt(u8 vector)
     } break;
     default:
       LOG("[INT 10h] Unknown parameter AH=" + String::ToHex(AH));
-      throw UnhandledInterruptException();
+      RaiseFault(FaultKind::UnhandledInterrupt,
+                 UnhandledInterruptException());
     }
     break;
   case 0x13: // Disc services
@@ -94,13 +130,17 @@ bool CPU::CallBIOSInterrupt(u8 vector)
         break;
       }
 
+      Memory::MarkWritten(ES, BX,
+                          sector_count * HW::FloppyDrive::GetSectorSize());
+
       AH = 0;
       CF = false;
       break;
     }
     default:
       LOG("[INT 13h] Unknown parameter AH=" + String::ToHex(AH));
-      throw UnhandledInterruptException();
+      RaiseFault(FaultKind::UnhandledInterrupt,
+                 UnhandledInterruptException());
     }
     break;
   case 0x16: { // Keyboard services
@@ -113,10 +153,12 @@ bool CPU::CallBIOSInterrupt(u8 vector)
     case 0x01: // Poll keys
       WARN("Key polling ignored");
       ZF = true;
+      DetectIdlePolling();
       break;
     default:
       LOG("[INT 16h] Unknown parameter AH=" + String::ToHex(AH));
-      throw UnhandledInterruptException();
+      RaiseFault(FaultKind::UnhandledInterrupt,
+                 UnhandledInterruptException());
     }
     break;
   case 0x17: // Printer services
@@ -130,7 +172,8 @@ bool CPU::CallBIOSInterrupt(u8 vector)
       break;
     default:
       LOG("[INT 17h] Unknown parameter AH=" + String::ToHex(AH));
-      throw UnhandledInterruptException();
+      RaiseFault(FaultKind::UnhandledInterrupt,
+                 UnhandledInterruptException());
     }
     break;
   }
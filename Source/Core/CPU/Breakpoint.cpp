@@ -5,38 +5,307 @@
 #include "Core/CPU/Breakpoint.h"
 
 #include <algorithm>
-#include <vector>
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 
 #include "Core/CPU/CPU.h"
+#include "Core/CPU/Cycles.h"
+#include "Core/CPU/Expression.h"
+#include "Core/Memory.h"
 
 namespace Core::CPU
 {
-std::vector<Breakpoint> breakpoints;
+namespace
+{
+// One bit per physical address. The CPU thread only ever reads it, updates
+// are single atomic bit operations, so there's nothing for it to lock
+std::array<std::atomic<u64>, Memory::SIZE / 64> s_bitmap{};
+
+struct Action {
+  //! Only does anything when this holds
+  std::optional<Expression> condition;
+  //! Record values instead of pausing
+  bool trace = false;
+  std::vector<Expression> values;
+
+  bool IsPlain() const { return !condition && !trace; }
+};
+
+// Actions by physical address, for the addresses where anything but plain
+// breakpoints is set. A set bit without an entry is a plain breakpoint
+using Actions = std::unordered_map<u32, std::vector<Action>>;
+
+// Bookkeeping of the threads adding and removing breakpoints
+std::mutex s_mutex;
+//! (segment << 16) | offset of every breakpoint
+std::map<u32, Action> s_breakpoints;
+//! Breakpoints per physical address, as different segment:offset pairs may
+//! name the same one
+std::unordered_map<u32, std::vector<u32>> s_aliases;
+
+// Replaced as a whole whenever it changes, the CPU thread only loads it
+// again when the generation changes
+std::shared_ptr<const Actions> s_actions;
+std::atomic<u32> s_generation = 0;
+
+// What the CPU thread last loaded
+std::shared_ptr<const Actions> s_loaded;
+u32 s_loaded_generation = 0;
+
+// Written by the CPU thread only, read by the one taking records
+std::array<TraceRecord, TRACE_BUFFER_SIZE> s_trace;
+std::atomic<u64> s_trace_head = 0;
+std::atomic<u64> s_trace_tail = 0;
+std::atomic<u64> s_trace_dropped = 0;
+
+u32 Key(Breakpoint b) { return (b.segment << 16) | b.offset; }
+
+// Addresses wrap around at 1 MiB, so FFFF:0010 hits a breakpoint at 0000:0000
+u32 Address(u16 segment, u16 offset)
+{
+  return Memory::VirtToPhys(segment, offset);
+}
+
+bool IsSet(u32 address)
+{
+  return s_bitmap[address / 64].load(std::memory_order_relaxed) &
+         (u64{1} << (address % 64));
+}
+
+// Update the actions at address after its breakpoints changed
+void Publish(u32 address)
+{
+  const std::shared_ptr<const Actions> current = std::atomic_load(&s_actions);
+
+  std::vector<Action> actions;
+  bool plain = true;
+
+  if (const auto it = s_aliases.find(address); it != s_aliases.end()) {
+    for (u32 key : it->second) {
+      actions.push_back(s_breakpoints.at(key));
+      plain = plain && actions.back().IsPlain();
+    }
+  }
+
+  if (plain && (current == nullptr || current->count(address) == 0))
+    return;
+
+  auto next = current != nullptr ? std::make_shared<Actions>(*current)
+                                 : std::make_shared<Actions>();
+
+  if (plain)
+    next->erase(address);
+  else
+    (*next)[address] = std::move(actions);
+
+  std::atomic_store(&s_actions, std::shared_ptr<const Actions>(next));
+  s_generation.fetch_add(1, std::memory_order_release);
+}
+
+void Add(Breakpoint b, Action action)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+
+  const u32 address = Address(b.segment, b.offset);
+  const bool inserted =
+      s_breakpoints.insert_or_assign(Key(b), std::move(action)).second;
+
+  if (inserted)
+    s_aliases[address].push_back(Key(b));
+
+  // Before the bit is set, so the CPU thread never sees the bit without the
+  // condition
+  Publish(address);
+
+  if (inserted && s_aliases[address].size() == 1)
+    s_bitmap[address / 64].fetch_or(u64{1} << (address % 64),
+                                    std::memory_order_release);
 
-void AddBreakpoint(Breakpoint b) { breakpoints.push_back(b); }
+  RequestWork(PENDING_BREAKPOINTS);
+}
+
+bool Compile(const std::string& text, std::optional<Expression>& expression,
+             std::string* error)
+{
+  expression = Expression::Compile(text, error);
+  return expression.has_value();
+}
+
+void Trace(const Action& action)
+{
+  const u64 head = s_trace_head.load(std::memory_order_relaxed);
+
+  if (head - s_trace_tail.load(std::memory_order_acquire) ==
+      TRACE_BUFFER_SIZE) {
+    s_trace_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  TraceRecord& record = s_trace[head % TRACE_BUFFER_SIZE];
+
+  record.cycles = cycles;
+  record.segment = CS;
+  record.offset = IP;
+  record.count = static_cast<u8>(action.values.size());
+
+  for (size_t i = 0; i < action.values.size(); i++)
+    record.values[i] = action.values[i].Evaluate();
+
+  s_trace_head.store(head + 1, std::memory_order_release);
+}
+
+// Slow path of IsBreakpointHit() for an address with its bit set
+bool Evaluate(u32 address)
+{
+  const u32 generation = s_generation.load(std::memory_order_acquire);
+
+  if (generation != s_loaded_generation) {
+    s_loaded = std::atomic_load(&s_actions);
+    s_loaded_generation = generation;
+  }
+
+  if (s_loaded == nullptr)
+    return true;
+
+  const auto it = s_loaded->find(address);
+
+  if (it == s_loaded->end())
+    return true;
+
+  bool hit = false;
+
+  for (const Action& action : it->second) {
+    if (action.condition && action.condition->Evaluate() == 0)
+      continue;
+
+    if (action.trace)
+      Trace(action);
+    else
+      hit = true;
+  }
+
+  return hit;
+}
+} // namespace
+
+void AddBreakpoint(Breakpoint b) { Add(b, {}); }
+
+bool AddConditionalBreakpoint(Breakpoint b, const std::string& condition,
+                              std::string* error)
+{
+  Action action;
+
+  if (!Compile(condition, action.condition, error))
+    return false;
+
+  Add(b, std::move(action));
+  return true;
+}
+
+bool AddTracepoint(Breakpoint b, const std::string& condition,
+                   const std::string& values, std::string* error)
+{
+  Action action;
+  action.trace = true;
+
+  if (condition.find_first_not_of(" \t") != std::string::npos &&
+      !Compile(condition, action.condition, error))
+    return false;
+
+  if (values.find_first_not_of(" \t") != std::string::npos) {
+    size_t start = 0;
+
+    while (start <= values.size()) {
+      size_t end = values.find(',', start);
+
+      if (end == std::string::npos)
+        end = values.size();
+
+      std::optional<Expression> value;
+
+      if (!Compile(values.substr(start, end - start), value, error))
+        return false;
+
+      if (action.values.size() == MAX_TRACE_VALUES) {
+        if (error != nullptr)
+          *error = "At most " + std::to_string(MAX_TRACE_VALUES) +
+                   " values can be traced";
+        return false;
+      }
+
+      action.values.push_back(std::move(*value));
+      start = end + 1;
+    }
+  }
+
+  Add(b, std::move(action));
+  return true;
+}
 
 void RemoveBreakpoint(Breakpoint b)
 {
-  auto it = std::find_if(
-      breakpoints.begin(), breakpoints.end(), [b](const Breakpoint& bp) {
-        return bp.offset == b.offset && bp.segment == b.segment;
-      });
+  std::lock_guard<std::mutex> lock(s_mutex);
 
-  if (it == breakpoints.end())
+  if (s_breakpoints.erase(Key(b)) == 0)
     return;
 
-  breakpoints.erase(it);
+  const u32 address = Address(b.segment, b.offset);
+  std::vector<u32>& aliases = s_aliases[address];
+
+  aliases.erase(std::find(aliases.begin(), aliases.end(), Key(b)));
+
+  if (aliases.empty()) {
+    s_aliases.erase(address);
+    s_bitmap[address / 64].fetch_and(~(u64{1} << (address % 64)),
+                                     std::memory_order_release);
+  }
+
+  Publish(address);
+
+  if (s_breakpoints.empty())
+    ClearWork(PENDING_BREAKPOINTS);
+}
+
+bool IsBreakpointHit()
+{
+  const u32 address = Address(CS, IP);
+
+  return IsSet(address) && Evaluate(address);
 }
 
-bool IsBreakpointHit() { return IsBreakpoint(CS, IP); }
+bool HasBreakpoints()
+{
+  return pending_work.load(std::memory_order_relaxed) & PENDING_BREAKPOINTS;
+}
 
 bool IsBreakpoint(u16 segment, u16 offset)
 {
-  for (const auto& bp : breakpoints) {
-    if (bp.segment == segment && bp.offset == offset)
-      return true;
-  }
+  return IsSet(Address(segment, offset));
+}
+
+std::vector<TraceRecord> TakeTraceRecords()
+{
+  const u64 tail = s_trace_tail.load(std::memory_order_relaxed);
+  const u64 head = s_trace_head.load(std::memory_order_acquire);
 
-  return false;
+  std::vector<TraceRecord> records;
+  records.reserve(head - tail);
+
+  for (u64 i = tail; i < head; i++)
+    records.push_back(s_trace[i % TRACE_BUFFER_SIZE]);
+
+  s_trace_tail.store(head, std::memory_order_release);
+
+  return records;
+}
+
+u64 GetDroppedTraceRecords()
+{
+  return s_trace_dropped.load(std::memory_order_relaxed);
 }
 } // namespace Core::CPU
@@ -3,6 +3,11 @@
 // Refer to the LICENSE file included.
 
 #pragma once
+//! \file
+
+#include <array>
+#include <string>
+#include <vector>
 
 #include "Common/Types.h"
 
@@ -12,9 +17,61 @@ struct Breakpoint {
   u16 segment, offset;
 };
 
+/**
+ * @brief Breakpoints may be added and removed from any thread, also while the
+ * CPU is running. They take effect at the physical address, so every
+ * segment:offset pair naming the same byte hits them.
+ *
+ * Adding a breakpoint where one is set already replaces it.
+ */
 void AddBreakpoint(Breakpoint b);
 void RemoveBreakpoint(Breakpoint b);
 
+/**
+ * @brief Breakpoint that only hits when condition, an Expression, evaluates
+ * to anything but 0. Returns false and describes the problem in error if
+ * condition doesn't compile
+ */
+bool AddConditionalBreakpoint(Breakpoint b, const std::string& condition,
+                              std::string* error = nullptr);
+
+/**
+ * @brief Instead of pausing, record the values of the comma separated
+ * expressions (may be none) in the trace buffer, if condition (may be empty)
+ * holds. Returns false and describes the problem in error if either doesn't
+ * compile
+ */
+bool AddTracepoint(Breakpoint b, const std::string& condition,
+                   const std::string& values, std::string* error = nullptr);
+
+//! Whether a breakpoint at CS:IP hits, recording tracepoints on the way. Only
+//! a bit test where there's none
 bool IsBreakpointHit();
-bool IsBreakpoint(u16 sgement, u16 offset);
+//! Whether any breakpoint is set at all
+bool HasBreakpoints();
+bool IsBreakpoint(u16 segment, u16 offset);
+
+//! Most values a tracepoint records
+constexpr size_t MAX_TRACE_VALUES = 8;
+
+//! Records the trace buffer holds until TakeTraceRecords() empties it
+constexpr size_t TRACE_BUFFER_SIZE = 4096;
+
+struct TraceRecord {
+  //! cycles at the time
+  u64 cycles;
+  u16 segment, offset;
+  u8 count;
+  std::array<u32, MAX_TRACE_VALUES> values;
+};
+
+/**
+ * @brief Take the records tracepoints made since the last call, oldest first.
+ * Records made while the buffer was full are dropped and only counted. Only
+ * one thread may take records
+ */
+std::vector<TraceRecord> TakeTraceRecords();
+
+//! Records dropped so far because the trace buffer was full
+u64 GetDroppedTraceRecords();
 } // namespace Core::CPU
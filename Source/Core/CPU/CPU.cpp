@@ -6,12 +6,20 @@
 
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
 #include <thread>
 #include <type_traits>
 
 #include "Core/CPU/Breakpoint.h"
+#include "Core/CPU/Dispatch.h"
 #include "Core/CPU/Flags.h"
 #include "Core/CPU/Instruction.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/JIT.h"
+#include "Core/CPU/Recompiled.h"
+#include "Core/CPU/Watchpoint.h"
 #include "Core/Core.h"
 #include "Core/HW/VGA.h"
 
@@ -51,14 +59,14 @@ u16 ES = 0;
 u16 LAST_CS = 0;
 u16 LAST_IP = 0;
 
-bool AF = false;
-bool CF = false;
+LazyFlag<FLAG_AF> AF;
+LazyFlag<FLAG_CF> CF;
 bool IF = false;
 bool DF = false;
-bool OF = false;
-bool PF = false;
-bool SF = false;
-bool ZF = false;
+LazyFlag<FLAG_OF> OF;
+LazyFlag<FLAG_PF> PF;
+LazyFlag<FLAG_SF> SF;
+LazyFlag<FLAG_ZF> ZF;
 
 bool simulate_msdos = false;
 bool pause_on_boot = false;
@@ -66,13 +74,99 @@ bool pause_on_boot = false;
 std::atomic<bool> running;
 std::atomic<bool> paused;
 
-// Treating this as if it were a 5 MHz 8088
-u64 clock_speed = 5'000'000;
+std::atomic<u32> pending_work;
+static std::atomic<u8> s_interrupt_vector;
+static std::atomic<u32> s_interrupt_sources;
+static std::atomic<std::chrono::microseconds> s_idle_time{};
 
-RepeatMode s_repeat_mode = RepeatMode::None;
+// Start() waits on this while paused. running and paused change under the
+// mutex, so no wakeup gets lost between checking them and waiting
+static std::mutex s_state_mutex;
+static std::condition_variable s_state_changed;
 
-void Stop() { running = false; }
-void SetPaused(bool value) { paused = value; }
+// The 8088 of the IBM PC runs at 4.77 MHz
+u64 clock_speed = 4'772'727;
+std::atomic<bool> unthrottled = false;
+std::atomic<double> speed_multiplier = 1.0;
+
+static std::atomic<double> s_effective_speed = 0.0;
+
+double GetEffectiveSpeed() { return s_effective_speed; }
+
+void Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(s_state_mutex);
+    running = false;
+  }
+
+  RequestWork(PENDING_STOP);
+  s_state_changed.notify_all();
+}
+
+void SetPaused(bool value)
+{
+  {
+    // Callers on different threads could leave the bit out of step with the
+    // flag otherwise, and Start() would spin on a pause that isn't one
+    std::lock_guard<std::mutex> lock(s_state_mutex);
+    paused = value;
+
+    if (value)
+      RequestWork(PENDING_PAUSE);
+    else
+      ClearWork(PENDING_PAUSE);
+  }
+
+  s_state_changed.notify_all();
+}
+
+// Park the calling thread until the CPU gets resumed or stopped
+static void WaitWhilePaused()
+{
+  std::unique_lock<std::mutex> lock(s_state_mutex);
+  s_state_changed.wait(lock, [] { return !paused || !running; });
+}
+
+// Park the calling thread until an interrupt gets requested, the CPU gets
+// paused or stopped, or until the time is up
+static void WaitForEvent(const std::chrono::microseconds* time)
+{
+  const auto woken = [] {
+    return !running || paused || (pending_work & PENDING_INTERRUPT);
+  };
+
+  std::unique_lock<std::mutex> lock(s_state_mutex);
+
+  if (time != nullptr)
+    s_state_changed.wait_for(lock, *time, woken);
+  else
+    s_state_changed.wait(lock, woken);
+}
+
+void RequestInterrupt(u8 vector)
+{
+  s_interrupt_vector = vector;
+
+  {
+    std::lock_guard<std::mutex> lock(s_state_mutex);
+    RequestWork(PENDING_INTERRUPT);
+  }
+
+  s_state_changed.notify_all();
+}
+
+void AddInterruptSource() { s_interrupt_sources++; }
+void RemoveInterruptSource() { s_interrupt_sources--; }
+bool HasInterruptSources() { return s_interrupt_sources > 0; }
+
+void RequestIdle(std::chrono::microseconds time)
+{
+  s_idle_time = time;
+  RequestWork(PENDING_IDLE);
+}
+
+std::chrono::microseconds GetIdleTime() { return s_idle_time; }
 
 bool IsRunning() { return running; }
 bool IsPaused() { return paused; }
@@ -113,18 +207,28 @@ void UnregisterStateChangedCallback(StateCallbackFunc fnc)
   }
 }
 
+// Tell the callbacks about the current state, unless it's the one they were
+// told about last
 void TriggerCallbacks()
 {
+  static State reported = State::Stopped;
+  const State state = GetState();
+
+  if (state == reported)
+    return;
+
+  reported = state;
+
   for (auto& fnc : fncs) {
-    fnc(GetState());
+    fnc(state);
   }
 }
 
-bool HandleRepetition()
+bool HandleRepetition(RepeatMode mode)
 {
-  if (s_repeat_mode != RepeatMode::None)
+  if (mode != RepeatMode::None)
     CX--;
-  switch (s_repeat_mode) {
+  switch (mode) {
   case RepeatMode::Repeat:
     return (CX != 0);
   case RepeatMode::Repeat_Zero:
@@ -138,13 +242,23 @@ bool HandleRepetition()
 
 Breakpoint just_hit = {0, 0};
 
-void Tick()
+// Whether execution has to stop at CS:IP. A breakpoint only gets hit once, so
+// execution can continue from it
+static bool CheckBreakpoint()
 {
-  const auto old_ip = IP;
-  LAST_CS = CS;
-  LAST_IP = IP;
+  if ((pending_work & PENDING_WATCHPOINTS) && IsWatchpointHit()) {
+    const WatchpointHit hit = *GetLastWatchpointHit();
+
+    LOG("Hit a watchpoint at " + String::ToHex(hit.watchpoint.address) +
+        " from " + String::ToHex(hit.segment) + ":" +
+        String::ToHex(hit.offset) + "!");
+    SetPaused(true);
+
+    return true;
+  }
 
-  if (IsBreakpointHit() && (just_hit.segment != CS || just_hit.offset != IP)) {
+  // Tracepoints there got recorded already when it was hit
+  if ((just_hit.segment != CS || just_hit.offset != IP) && IsBreakpointHit()) {
     LOG("Hit a breakpoint at " + String::ToHex(CS) + ":" + String::ToHex(IP) +
         "!");
     SetPaused(true);
@@ -152,52 +266,215 @@ void Tick()
     just_hit.segment = CS;
     just_hit.offset = IP;
 
-    return;
+    return true;
   }
 
   just_hit.segment = 0;
   just_hit.offset = 0;
 
-  u8 opcode = Memory::Get<u8>(CS, IP++);
-  Instruction ins(opcode, old_ip);
+  return false;
+}
 
-  if (ins.IsPrefix())
-    ins = Instruction(ins, Memory::Get<u8>(CS, IP++), old_ip);
+// Fetch and execute the instruction at CS:IP. Returns false if it couldn't
+// be fetched
+static bool Interpret()
+{
+  LAST_CS = CS;
+  LAST_IP = IP;
 
-  if (!ins.IsResolved()) {
-    u8 mod = Memory::Get<u8>(CS, IP++);
-    u8 length = ins.GetLength(mod);
+  Instruction ins;
 
-    std::vector<u8> data;
+  if (!TryFetchInstruction(CS, IP, ins))
+    return false;
+
+  IP += ins.GetSize();
+  cycles += ins.GetCycles();
+
+  // LOG(String::ToHex<u16>(CS) + ":" + String::ToHex<u16>(LAST_IP) + ": " +
+  //     ins.ToString());
 
-    for (u32 i = 0; i < length; i++)
-      data.push_back(Memory::Get<u8>(CS, IP++));
+  if (dispatch_mode == DispatchMode::Threaded)
+    ins.GetHandler()(ins);
+  else
+    Execute(ins);
 
-    if (!ins.Resolve(mod, data)) {
-      LOG("Failed to resolve " + String::ToHex(opcode) + " with mod " +
-          String::ToHex(mod));
-      throw InvalidParameterException(opcode, mod);
+  return true;
+}
+
+// Devices get to see what an instruction wrote before the next one runs
+static void NotifyDevices()
+{
+  if (pending_work.load(std::memory_order_acquire) & PENDING_DEVICES)
+    Memory::NotifyDevices();
+}
+
+RunStatus Step()
+{
+  if ((pending_work & (PENDING_BREAKPOINTS | PENDING_WATCHPOINTS)) &&
+      CheckBreakpoint())
+    return RunStatus::Breakpoint;
+
+  Interpret();
+  NotifyDevices();
+
+  return HasFault() ? RunStatus::Fault : RunStatus::Completed;
+}
+
+// Deal with the pending work that doesn't need to look at every instruction.
+// Returns Completed if execution may continue
+static RunStatus HandlePendingWork()
+{
+  // Before looking at the rest, as devices may request work themselves
+  NotifyDevices();
+
+  const u32 work = pending_work.load(std::memory_order_acquire);
+
+  if (work & PENDING_FAULT)
+    return RunStatus::Fault;
+
+  if (work & PENDING_STOP) {
+    ClearWork(PENDING_STOP);
+    return RunStatus::Stopped;
+  }
+
+  if (work & PENDING_PAUSE) {
+    std::lock_guard<std::mutex> lock(s_state_mutex);
+
+    if (paused)
+      return RunStatus::Paused;
+
+    ClearWork(PENDING_PAUSE);
+  }
+
+  if (work & PENDING_REFRESH) {
+    ClearWork(PENDING_REFRESH);
+    return RunStatus::Refresh;
+  }
+
+  if (work & PENDING_IDLE) {
+    ClearWork(PENDING_IDLE);
+    return RunStatus::Idle;
+  }
+
+  // Only interrupts end HLT
+  if (work & PENDING_HALT) {
+    if (!(work & PENDING_INTERRUPT) || !IF)
+      return RunStatus::Halted;
+
+    ClearWork(PENDING_HALT);
+  }
+
+  if ((work & PENDING_INTERRUPT) && IF) {
+    ClearWork(PENDING_INTERRUPT);
+    CallInterrupt(s_interrupt_vector);
+
+    if (HasFault())
+      return RunStatus::Fault;
+  }
+
+  return RunStatus::Completed;
+}
+
+// Runs until either limit is reached. cycle_limit is compared against the
+// cycles counter, it's not a number of cycles to run
+static RunResult RunUntil(u64 max_instructions, u64 cycle_limit)
+{
+  RunResult result;
+  const u64 start = cycles;
+
+  // Neither can be switched on by the code that's running
+  const bool native = use_jit || IsRecompiledCodeValid();
+
+  while (result.retired < max_instructions && cycles < cycle_limit) {
+    if (HasPendingWork()) {
+      result.status = HandlePendingWork();
+
+      if (result.status != RunStatus::Completed)
+        break;
+
+      // Breakpoints, watchpoints and interrupts waiting for IF need a look
+      // at every instruction
+      if (HasPendingWork()) {
+        if ((pending_work & (PENDING_BREAKPOINTS | PENDING_WATCHPOINTS)) &&
+            CheckBreakpoint()) {
+          result.status = RunStatus::Breakpoint;
+          break;
+        }
+
+        if (Interpret())
+          result.retired++;
+
+        continue;
+      }
+    }
+
+    if (native) {
+      const u32 left = static_cast<u32>(std::min<u64>(
+          max_instructions - result.retired, std::numeric_limits<u32>::max()));
+
+      if (const u32 retired = ExecuteRecompiled(left, cycle_limit)) {
+        result.retired += retired;
+        continue;
+      }
+
+      if (const u32 retired = ExecuteBlock()) {
+        result.retired += retired;
+        continue;
+      }
+
+      if (Interpret())
+        result.retired++;
+
+      continue;
+    }
+
+    while (result.retired < max_instructions && cycles < cycle_limit &&
+           !HasPendingWork()) {
+      if (!Interpret())
+        break;
+
+      result.retired++;
     }
   }
 
-  if (ins.GetType() == Instruction::Type::Invalid)
-    throw InvalidInstructionException(opcode);
+  // The last instruction of the batch may have faulted
+  if (HasFault())
+    result.status = RunStatus::Fault;
 
-  // LOG(String::ToHex<u16>(CS) + ":" + String::ToHex<u16>(old_ip) + ": " +
-  //     ins.ToString());
+  NotifyDevices();
+
+  result.cycles = cycles - start;
 
+  return result;
+}
+
+RunResult Run(u64 max_instructions)
+{
+  return RunUntil(max_instructions, std::numeric_limits<u64>::max());
+}
+
+RunResult RunCycles(u64 max_cycles)
+{
+  return RunUntil(std::numeric_limits<u64>::max(), cycles + max_cycles);
+}
+
+void Tick()
+{
+  if (Step() == RunStatus::Fault)
+    ThrowFault();
+}
+
+void Execute(const Instruction& ins)
+{
   using Type = Instruction::Type;
-  using PType = Instruction::Parameter::Type;
 
   switch (ins.GetType()) {
-  case Type::ADC: {
+  case Type::ADC:
     ADC(ins);
     break;
-  }
-  case Type::ADD: {
+  case Type::ADD:
     ADD(ins);
     break;
-  }
   case Type::AND:
     AND(ins);
     break;
@@ -208,109 +485,47 @@ void Tick()
     RET(ins);
     break;
   case Type::CBW:
-    // Copy the sign bit into all of AH
-    AH = AL & (0b1000'0000) ? 0xFF : 0x00;
+    CBW(ins);
     break;
   case Type::CLC:
-    CF = false;
+    CLC(ins);
     break;
   case Type::CMC:
-    CF = !CF;
+    CMC(ins);
     break;
   case Type::STC:
-    CF = true;
+    STC(ins);
     break;
   case Type::CLD:
-    DF = false;
+    CLD(ins);
     break;
   case Type::STD:
-    DF = true;
+    STD(ins);
     break;
   case Type::CLI:
-    IF = false;
+    CLI(ins);
     break;
   case Type::STI:
-    IF = true;
+    STI(ins);
     break;
-  case Type::CMP: {
-    auto& dst = ins.GetParameters()[0];
-    auto& src = ins.GetParameters()[1];
-
-    if (dst.IsWord()) {
-      u16 dst_u16 = ParameterTo<u16>(dst, ins.GetPrefix());
-      u16 src_u16;
-
-      i32 diff = static_cast<i16>(dst_u16);
-
-      if (src.IsWord()) {
-        src_u16 = ParameterTo<u16>(src, ins.GetPrefix());
-
-        // LOG("Comparing " + String::ToHex<u16>(dst_i16) + " with " +
-        //     String::ToHex<u16>(src16));
-      } else {
-        src_u16 = ParameterTo<u8>(src, ins.GetPrefix());
-
-        // LOG("Comparing " + String::ToHex<u16>(dst_i16) + " with " +
-        //     String::ToHex<u8>(src8));
-      }
-
-      diff -= static_cast<i16>(src_u16);
-
-      UpdateSF(static_cast<i16>(diff));
-      UpdateZF(static_cast<i16>(diff));
-      UpdatePF(static_cast<i16>(diff));
-      UpdateOF<i16>(diff);
-      UpdateCF<i16>(dst_u16 - src_u16);
-    } else {
-      u8 dst_u8 = ParameterTo<u8>(dst, ins.GetPrefix());
-      u8 src_u8 = ParameterTo<u8>(src, ins.GetPrefix());
-
-      i32 diff = static_cast<i8>(dst_u8) - static_cast<i8>(src_u8);
-
-      // LOG("Comparing " + String::ToHex<u8>(dst_i8) + " with " +
-      //     String::ToHex<u8>(src_i8));
-
-      UpdateSF(static_cast<i8>(diff));
-      UpdateZF(static_cast<i8>(diff));
-      UpdatePF(static_cast<i8>(diff));
-      UpdateOF<i8>(diff);
-      UpdateCF<i8>(dst_u8 - src_u8);
-    }
-
+  case Type::CMP:
+    CMP(ins);
     break;
-  }
   case Type::CMPSB:
     CMPSB(ins);
     break;
   case Type::CMPSW:
     CMPSW(ins);
     break;
-  case Type::HLT: {
-    LOG("[STUB] CPU halted, stopping for now...");
-    running = false;
+  case Type::HLT:
+    HLT(ins);
     break;
-  }
   case Type::INC:
     INC(ins);
     break;
-  case Type::DAA: {
-    if ((AL & 0xF) > 9 || AF) {
-      bool CF_before = CF;
-
-      UpdateCF<u8>(static_cast<u16>(AL) + 6);
-      CF |= CF_before;
-      AL += 6;
-      AF = true;
-    } else {
-      AF = false;
-    }
-
-    UpdateSF(AL);
-    UpdateZF(AL);
-    UpdatePF(AL);
-
+  case Type::DAA:
+    DAA(ins);
     break;
-  }
   case Type::DEC:
     DEC(ins);
     break;
@@ -318,11 +533,9 @@ void Tick()
   case Type::DIV:
     DIV(ins);
     break;
-  case Type::INT: {
-    auto& parameter = ins.GetParameters()[0];
-    CallInterrupt(parameter.GetData<u8>());
+  case Type::INT:
+    INT(ins);
     break;
-  }
   case Type::JMP:
     JMP(ins);
     break;
@@ -363,7 +576,7 @@ void Tick()
     JL(ins);
     break;
   case Type::JLE:
-    JL(ins);
+    JLE(ins);
     break;
   case Type::JO:
     JO(ins);
@@ -377,135 +590,30 @@ void Tick()
   case Type::JNZ:
     JNZ(ins);
     break;
-  case Type::LDS: {
-    auto& dst = ins.GetParameters()[0];
-    auto& src = ins.GetParameters()[1];
-
-    if (dst.IsWord() != src.IsWord())
-      throw ParameterLengthMismatchException(ins, dst, src);
-
-    if (!dst.IsWord())
-      throw UnsupportedParameterException(ins, dst);
-
-    u32 ptr;
-
-    ptr = *reinterpret_cast<u32*>(&ParameterTo<u16&>(src, ins.GetPrefix()));
-
-    u16 segment = (ptr & 0xFFFF0000) >> 16;
-    u16 offset = ptr & 0xFFFF;
-
-    DS = segment;
-    ParameterTo<u16&>(dst, ins.GetPrefix()) = offset;
-
+  case Type::LDS:
+    LDS(ins);
     break;
-  }
-  case Type::LEA: {
-    auto& dst = ins.GetParameters()[0];
-    auto& src = ins.GetParameters()[1];
-
-    if (dst.IsWord() != src.IsWord())
-      throw ParameterLengthMismatchException(ins, dst, src);
-
-    if (!dst.IsWord())
-      throw UnsupportedParameterException(ins, dst);
-
-    u16& dst16 = ParameterTo<u16&>(dst, ins.GetPrefix());
-    u16& src16 = ParameterTo<u16&>(src, ins.GetPrefix());
-
-    dst16 = static_cast<u16>(reinterpret_cast<intptr_t>(&src16) - reinterpret_cast<intptr_t>(Memory::GetPtr<u16>(DS, 0)));
-
+  case Type::LEA:
+    LEA(ins);
     break;
-  }
-  case Type::LES: {
-    auto& dst = ins.GetParameters()[0];
-    auto& src = ins.GetParameters()[1];
-
-    if (dst.IsWord() != src.IsWord())
-      throw ParameterLengthMismatchException(ins, dst, src);
-
-    if (!dst.IsWord())
-      throw UnsupportedParameterException(ins, dst);
-
-    u16& dst16 = ParameterTo<u16&>(dst, ins.GetPrefix());
-    u16& src16 = ParameterTo<u16&>(src, ins.GetPrefix());
-
-    u32 address = *reinterpret_cast<u32*>(&src16);
-
-    ES = (address & 0xFFFF0000) >> 16;
-    dst16 = address & 0xFFFF;
+  case Type::LES:
+    LES(ins);
     break;
-  }
   case Type::LODSB:
     LODSB(ins);
     break;
   case Type::LODSW:
     LODSW(ins);
     break;
-  case Type::LOOP: {
-    // LOG("CX = " + String::ToHex(CX));
-
-    CX--;
-
-    if (CX == 0)
-      break;
-
-    auto& parameter = ins.GetParameters()[0];
-
-    switch (parameter.GetType()) {
-    case PType::Literal_Offset:
-      IP += parameter.GetData<i8>();
-      break;
-    default:
-      LOG("[LOOP] Don't know what to do with parameter type: " +
-          ParameterTypeToString(parameter.GetType()));
-      throw UnhandledParameterException(parameter);
-    }
+  case Type::LOOP:
+    LOOP(ins);
     break;
-  }
-  case Type::LOOPNZ: {
-    CX--;
-
-    if (CX == 0 || !ZF)
-      break;
-
-    auto& parameter = ins.GetParameters()[0];
-
-    switch (parameter.GetType()) {
-    case PType::Literal_Offset:
-      IP += parameter.GetData<i8>();
-      break;
-    default:
-      LOG("[LOOPNZ] Don't know what to do with parameter type: " +
-          ParameterTypeToString(parameter.GetType()));
-      throw UnhandledParameterException(parameter);
-    }
+  case Type::LOOPNZ:
+    LOOPNZ(ins);
     break;
-  }
-  case Type::MOV: {
-    auto& dst = ins.GetParameters()[0];
-    auto& src = ins.GetParameters()[1];
-
-    if (dst.IsWord() != src.IsWord())
-      throw ParameterLengthMismatchException(ins, dst, src);
-
-    if (dst.IsWord()) {
-      u16& dst16 = ParameterTo<u16&>(dst, ins.GetPrefix());
-      u16 src16 = ParameterTo<u16>(src, ins.GetPrefix());
-
-      // LOG("Moving " + String::ToHex(src16) + " -> " + String::ToHex(dst16));
-
-      dst16 = src16;
-    } else {
-      u8& dst8 = ParameterTo<u8&>(dst, ins.GetPrefix());
-      u8 src8 = ParameterTo<u8>(src, ins.GetPrefix());
-
-      // LOG("Moving " + String::ToHex(src8) + " -> " + String::ToHex(dst8));
-
-      dst8 = src8;
-    }
-
+  case Type::MOV:
+    MOV(ins);
     break;
-  }
   case Type::MOVSB:
     MOVSB(ins);
     break;
@@ -513,92 +621,30 @@ void Tick()
     MOVSW(ins);
     break;
   case Type::IMUL: // TODO: This is a bad way to stub IMUL...
-  case Type::MUL: {
-    auto& mul = ins.GetParameters()[0];
-
-    if (mul.IsWord()) {
-      i32 result =
-          static_cast<i32>(AX) * ParameterTo<u16>(mul, ins.GetPrefix());
-
-      AX = result & 0xFFFF;
-      DX = (result & 0xFFFF0000) >> 16;
-
-      OF = CF = (AX & 0xff00) != 0;
-    } else {
-      AX = static_cast<i16>(AL) * ParameterTo<u8>(mul, ins.GetPrefix());
-
-      OF = CF = (AX & 0xff00) != 0;
-    }
-
+  case Type::MUL:
+    MUL(ins);
+    break;
+  case Type::NEG:
+    NEG(ins);
     break;
-  }
   case Type::NOP:
-    LOG("NOP? NOP.");
+    NOP(ins);
     break;
   case Type::OR:
     OR(ins);
     break;
-  case Type::PUSH: {
-    auto& data = ins.GetParameters()[0];
-
-    if (!data.IsWord())
-      throw UnsupportedParameterException(ins, data);
-
-    u16 data16 = ParameterTo<u16>(data, ins.GetPrefix());
-
-    SP -= sizeof(u16);
-    Memory::Get<u16>(SS, SP) = data16;
-
+  case Type::PUSH:
+    PUSH(ins);
     break;
-  }
-  case Type::PUSHF: {
-    u16 eflags = static_cast<u16>(CF) | (1 << 1) | (static_cast<u16>(PF) << 2) |
-                 (static_cast<u16>(AF) << 4) | (static_cast<u16>(ZF) << 6) |
-                 (static_cast<u16>(SF) << 7) | (/*TF*/ 0 << 8) |
-                 (static_cast<u16>(IF) << 9) | (static_cast<u16>(DF) << 10) |
-                 (static_cast<u16>(OF) << 11) | (1 << 14) | (1 << 15);
-
-    SP -= sizeof(u16);
-    Memory::Get<u16>(SS, SP) = eflags;
-
+  case Type::PUSHF:
+    PUSHF(ins);
     break;
-  }
-  case Type::POPF: {
-    u16 eflags = Memory::Get<u16>(SS, SP);
-
-    CF = eflags & 1;
-    PF = eflags & (1 << 2);
-    AF = eflags & (1 << 4);
-    ZF = eflags & (1 << 6);
-    SF = eflags & (1 << 7);
-    // TF = eflags & (1 << 8);
-    IF = eflags & (1 << 9);
-    DF = eflags & (1 << 10);
-    OF = eflags & (1 << 11);
-
-    SP -= sizeof(u16);
-
+  case Type::POPF:
+    POPF(ins);
     break;
-  }
-  case Type::POP: {
-    auto& dst = ins.GetParameters()[0];
-
-    if (!dst.IsWord())
-      throw UnsupportedParameterException(ins, dst);
-
-    u16& dst16 = ParameterTo<u16&>(dst, ins.GetPrefix());
-
-    dst16 = Memory::Get<u16>(SS, SP);
-    SP += sizeof(u16);
-
+  case Type::POP:
+    POP(ins);
     break;
-  }
-  case Type::REPZ:
-    s_repeat_mode = RepeatMode::Repeat_Zero;
-    return;
-  case Type::REPNZ:
-    s_repeat_mode = RepeatMode::Repeat_Non_Zero;
-    return;
   case Type::ROL:
     ROL(ins);
     break;
@@ -626,60 +672,179 @@ void Tick()
   case Type::TEST:
     TEST(ins);
     break;
-  case Type::XCHG: {
-    auto& dst = ins.GetParameters()[0];
-    auto& src = ins.GetParameters()[1];
-
-    if (dst.IsWord() != src.IsWord())
-      throw ParameterLengthMismatchException(ins, dst, src);
-
-    if (dst.IsWord()) {
-      u16& dst16 = ParameterTo<u16&>(dst, ins.GetPrefix());
-      u16& src16 = ParameterTo<u16&>(src, ins.GetPrefix());
-      std::swap(dst16, src16);
-    } else {
-      u8& dst8 = ParameterTo<u8&>(dst, ins.GetPrefix());
-      u8& src8 = ParameterTo<u8&>(src, ins.GetPrefix());
-      std::swap(dst8, src8);
-    }
-
+  case Type::XCHG:
+    XCHG(ins);
     break;
-  }
   case Type::XOR:
     XOR(ins);
     break;
   default:
-    throw UnhandledInstructionException(ins);
+    RaiseFault(FaultKind::UnhandledInstruction,
+               UnhandledInstructionException(ins));
   }
+}
+
+// Host time a budget of cycles gets run for before sleeping. The OS can't
+// sleep for much less, let alone for a single instruction
+constexpr std::chrono::microseconds TIME_SLICE{1000};
+// Budget per slice when running unthrottled, roughly what a slice gets at
+// 50 times the speed of an IBM PC
+constexpr u64 UNTHROTTLED_BUDGET = 1 << 18;
+// Falling behind further than this (e.g. because the host was busy) isn't
+// caught up with
+constexpr std::chrono::milliseconds MAX_DRIFT{50};
+// Changes to video memory are shown at most this often
+constexpr std::chrono::milliseconds REFRESH_INTERVAL{16};
+// Time GetEffectiveSpeed() averages over
+constexpr std::chrono::milliseconds SPEED_WINDOW{500};
+
+static void MeasureSpeed(u64 executed,
+                         std::chrono::steady_clock::duration time)
+{
+  const double seconds = std::chrono::duration<double>(time).count();
 
-  s_repeat_mode = RepeatMode::None;
+  if (seconds > 0)
+    s_effective_speed = executed / seconds;
 }
 
 void Start()
 {
+  using Clock = std::chrono::steady_clock;
+
   running = true;
-  TriggerCallbacks();
-  u8 counter = 0;
+  ClearWork(PENDING_STOP | PENDING_HALT | PENDING_IDLE);
 
   if (pause_on_boot)
-    paused = true;
+    SetPaused(true);
+
+  TriggerCallbacks();
+
+  Core::HW::VGA::Update();
+
+  // When the cycles run so far are due at the emulated clock speed
+  Clock::time_point deadline = Clock::now();
+  Clock::time_point last_refresh = deadline;
+  Clock::time_point window_start = deadline;
+  u64 window_cycles = 0;
+  bool refresh = false;
 
   while (running) {
-    if (counter++ == 0)
+    const bool throttled = !unthrottled;
+    const double hz = std::max(1.0, clock_speed * speed_multiplier);
+    const u64 budget =
+        throttled ? std::max<u64>(1, static_cast<u64>(
+                                         hz * TIME_SLICE.count() / 1'000'000))
+                  : UNTHROTTLED_BUDGET;
+
+    u64 executed = 0;
+    bool paused_now = false;
+    bool halted = false;
+    bool idle = false;
+
+    while (running && executed < budget && !paused_now && !halted && !idle) {
+      const RunResult result = RunCycles(budget - executed);
+      executed += result.cycles;
+
+      switch (result.status) {
+      case RunStatus::Fault:
+        running = false;
+        TriggerCallbacks();
+        ThrowFault();
+      case RunStatus::Refresh:
+        refresh = true;
+        break;
+      case RunStatus::Paused:
+      case RunStatus::Breakpoint:
+        paused_now = true;
+        break;
+      case RunStatus::Halted:
+        halted = true;
+        break;
+      case RunStatus::Idle:
+        idle = true;
+        break;
+      default:
+        break;
+      }
+    }
+
+    Clock::time_point now = Clock::now();
+
+    if (refresh && now - last_refresh >= REFRESH_INTERVAL) {
       Core::HW::VGA::Update();
+      last_refresh = now;
+      refresh = false;
+    }
 
-    if (paused)
+    if (paused_now) {
+      if (refresh)
+        Core::HW::VGA::Update();
+
+      refresh = false;
+      TriggerCallbacks();
+      WaitWhilePaused();
       TriggerCallbacks();
 
-    while (paused && running) {
+      // Time spent paused doesn't have to be caught up with
+      now = Clock::now();
+      deadline = now;
+      window_start = now;
+      window_cycles = 0;
+      continue;
     }
 
-    Tick();
+    window_cycles += executed;
 
-    std::this_thread::sleep_for(
-        std::chrono::nanoseconds(1000000000 / clock_speed));
+    if (now - window_start >= SPEED_WINDOW) {
+      MeasureSpeed(window_cycles, now - window_start);
+      window_start = now;
+      window_cycles = 0;
+    }
+
+    if (halted || idle) {
+      if (refresh)
+        Core::HW::VGA::Update();
+
+      refresh = false;
+
+      const std::chrono::microseconds idle_time = s_idle_time;
+      WaitForEvent(halted ? nullptr : &idle_time);
+
+      // The clock kept running while the CPU waited
+      const Clock::time_point woken = Clock::now();
+
+      if (throttled) {
+        const u64 waited = static_cast<u64>(
+            std::chrono::duration<double>(woken - now).count() * hz);
+
+        cycles += waited;
+        idle_cycles += waited;
+      }
+
+      deadline = woken;
+      continue;
+    }
+
+    if (!throttled) {
+      deadline = now;
+      continue;
+    }
+
+    // Sleep once per slice, for however far ahead of the emulated clock the
+    // slice got. Oversleeping gets made up for by the next slices.
+    deadline += std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(executed / hz));
+
+    if (deadline > now)
+      std::this_thread::sleep_until(deadline);
+    else if (now - deadline > MAX_DRIFT)
+      deadline = now;
   }
 
+  // Programs exiting right away never fill a whole window
+  if (window_cycles != 0)
+    MeasureSpeed(window_cycles, Clock::now() - window_start);
+
   TriggerCallbacks();
 
   // Update the output for the last time before stopping so all output gets
@@ -6,26 +6,158 @@
 //! \file
 
 #include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <functional>
 
 #include "Common/Logger.h"
 #include "Common/String.h"
 #include "Common/Types.h"
 
+#include "Core/CPU/Cycles.h"
+#include "Core/CPU/EffectiveAddress.h"
 #include "Core/CPU/Exception.h"
+#include "Core/CPU/Fault.h"
 #include "Core/CPU/Instruction.h"
+#include "Core/CPU/LazyFlags.h"
 #include "Core/Memory.h"
 
 //! Representation of the Central Processing Unit
 namespace Core::CPU
 {
-//! Execute one CPU cycle
+//! Why Run() or Step() returned
+enum class RunStatus : u8 {
+  //! Executed everything that was asked for
+  Completed,
+  //! Stop() got called
+  Stopped,
+  //! The CPU is paused
+  Paused,
+  //! Paused at a breakpoint before executing the instruction at CS:IP
+  Breakpoint,
+  //! Video memory changed, the output should be refreshed
+  Refresh,
+  //! Stopped by a fault, see GetFault()
+  Fault,
+  //! HLT is waiting for an interrupt
+  Halted,
+  //! The guest is only waiting for something to happen, see RequestIdle()
+  Idle,
+};
+
+struct RunResult {
+  RunStatus status = RunStatus::Completed;
+  //! Instructions executed, including one that faulted while executing
+  u64 retired = 0;
+  //! 8088 cycles those took, see InstructionCycles()
+  u64 cycles = 0;
+};
+
+//! Everything that makes Run() leave its inner loop, see RequestWork()
+enum PendingWork : u32 {
+  //! Stop() got called
+  PENDING_STOP = 1 << 0,
+  //! The CPU is paused
+  PENDING_PAUSE = 1 << 1,
+  //! Breakpoints are set, so every instruction has to be checked
+  PENDING_BREAKPOINTS = 1 << 2,
+  //! RequestInterrupt() got called
+  PENDING_INTERRUPT = 1 << 3,
+  //! Video memory changed
+  PENDING_REFRESH = 1 << 4,
+  //! A fault got raised
+  PENDING_FAULT = 1 << 5,
+  //! HLT got executed with interrupts enabled and a source of them around
+  PENDING_HALT = 1 << 6,
+  //! RequestIdle() got called
+  PENDING_IDLE = 1 << 7,
+  //! Watchpoints got added or removed, or a watched page got accessed
+  PENDING_WATCHPOINTS = 1 << 8,
+  //! Memory-mapped devices haven't seen everything written to them yet
+  PENDING_DEVICES = 1 << 9,
+};
+
+//! \cond PRIVATE
+extern std::atomic<u32> pending_work;
+//! \endcond PRIVATE
+
+//! Flag work for the CPU thread to look at before the next instruction. Safe
+//! to call from any thread
+inline void RequestWork(u32 work)
+{
+  pending_work.fetch_or(work, std::memory_order_release);
+}
+
+inline void ClearWork(u32 work)
+{
+  pending_work.fetch_and(~work, std::memory_order_release);
+}
+
+inline bool HasPendingWork()
+{
+  return pending_work.load(std::memory_order_relaxed) != 0;
+}
+
+/**
+ * @brief Execute one instruction in the interpreter, unless there's a
+ * breakpoint at CS:IP. Faults are recorded instead of thrown
+ */
+RunStatus Step();
+
+/**
+ * @brief Execute up to max_instructions instructions, using recompiled or
+ * translated code where available. Those run whole blocks, so they may
+ * overshoot a little.
+ *
+ * Instructions run back to back for as long as no PendingWork is flagged.
+ * Stops early when the CPU gets stopped or paused, at breakpoints and faults,
+ * and when video memory changed. Never throws.
+ */
+RunResult Run(u64 max_instructions);
+
+//! Like Run(), but stops once the instructions executed took at least
+//! max_cycles 8088 cycles
+RunResult RunCycles(u64 max_cycles);
+
+//! Raise a hardware interrupt, which is taken before the next instruction once
+//! IF is set. Only one can be pending at a time. Wakes up a halted CPU
+void RequestInterrupt(u8 vector);
+
+/**
+ * @brief Whatever calls RequestInterrupt() registers itself as a source of
+ * interrupts for as long as it may do so. Without any, HLT stops the CPU
+ * even with IF set, as nothing could ever end it
+ */
+void AddInterruptSource();
+void RemoveInterruptSource();
+bool HasInterruptSources();
+
+/**
+ * @brief Let Start() give the host thread a break of up to the time provided,
+ * e.g. because the guest polls for input in a loop. Ends early once an
+ * interrupt is requested
+ */
+void RequestIdle(std::chrono::microseconds time);
+
+//! Time the last RequestIdle() asked for
+std::chrono::microseconds GetIdleTime();
+
+/**
+ * @brief Execute one instruction in the interpreter
+ * @throws The CPUException of whatever fault it raised
+ */
 void Tick();
 
-//! Execute instructions until shutdown is requested
+//! Execute a decoded instruction by switching over its type
+void Execute(const Instruction& ins);
+
+/**
+ * @brief Execute instructions until shutdown is requested. Runs a budget of
+ * cycles per time slice and sleeps off the rest of the slice, see
+ * clock_speed, unthrottled and speed_multiplier
+ */
 void Start();
 
-enum class RepeatMode : u8 { None, Repeat, Repeat_Zero, Repeat_Non_Zero };
 enum class State : u8 { Stopped, Running, Paused };
 
 using StateCallbackFunc = std::function<void(State)>;
@@ -99,21 +231,21 @@ extern u16 LAST_CS;
 extern u16 LAST_IP;
 
 //! Adjust Flag
-extern bool AF;
+extern LazyFlag<FLAG_AF> AF;
 //! Carry Flag
-extern bool CF;
+extern LazyFlag<FLAG_CF> CF;
 //! Interrupt Flag
 extern bool IF;
 //! Direction Flag
 extern bool DF;
 //! Overflow Flag
-extern bool OF;
+extern LazyFlag<FLAG_OF> OF;
 //! Parity Flag
-extern bool PF;
+extern LazyFlag<FLAG_PF> PF;
 //! Sign Flag
-extern bool SF;
+extern LazyFlag<FLAG_SF> SF;
 //! Zero Flag
-extern bool ZF;
+extern LazyFlag<FLAG_ZF> ZF;
 
 //! Simulate MS-DOS (Handle its interrupts)
 extern bool simulate_msdos;
@@ -131,25 +263,53 @@ bool IsRunning();
 bool IsPaused();
 State GetState();
 
+//! Emulated clock speed in Hz, see InstructionCycles()
 extern u64 clock_speed;
 
+//! Run as fast as the host allows instead of at clock_speed
+extern std::atomic<bool> unthrottled;
+
+//! Factor applied to clock_speed while throttled, e.g. 2 to run twice as fast
+extern std::atomic<double> speed_multiplier;
+
+//! Emulated cycles per second Start() achieved lately, in Hz. Keeps the last
+//! value once the CPU stopped
+double GetEffectiveSpeed();
+
 u16 PrefixToValue(Instruction::SegmentPrefix prefix);
 
 //! \cond PRIVATE
+//! Operands a handler can't deal with are rejected by ValidateOperands() when
+//! decoding, so they never make it this far
+[[noreturn]] inline void UnvalidatedParameter()
+{
+#if !defined(NDEBUG)
+  std::abort();
+#elif defined(__GNUC__)
+  __builtin_unreachable();
+#elif defined(_MSC_VER)
+  __assume(0);
+#endif
+}
+
+/**
+ * @brief Access a parameter as T, which must be its width. References are
+ * only handed out to registers, memory parameters get written through
+ * WriteParameter() and ModifyParameter(), which wrap words at offset FFFF
+ * @param segment Segment of memory parameters, see Instruction::GetSegment()
+ */
 template <class T>
 T ParameterTo(const Instruction::Parameter& parameter,
-              Instruction::SegmentPrefix prefix)
+              Instruction::SegmentPrefix segment)
 {
-  [[maybe_unused]] u16 seg_val = PrefixToValue(prefix);
-
   if constexpr (std::is_same<T, i8>::value) {
-    return static_cast<i8>(ParameterTo<u8>(parameter, prefix));
+    return static_cast<i8>(ParameterTo<u8>(parameter, segment));
   } else if constexpr (std::is_same<T, i8&>::value) {
-    return *reinterpret_cast<i8*>(&ParameterTo<u8&>(parameter, prefix));
+    return *reinterpret_cast<i8*>(&ParameterTo<u8&>(parameter, segment));
   } else if constexpr (std::is_same<T, i16>::value) {
-    return static_cast<i16>(ParameterTo<u16>(parameter, prefix));
+    return static_cast<i16>(ParameterTo<u16>(parameter, segment));
   } else if constexpr (std::is_same<T, i16&>::value) {
-    return *reinterpret_cast<i16*>(&ParameterTo<u16&>(parameter, prefix));
+    return *reinterpret_cast<i16*>(&ParameterTo<u16&>(parameter, segment));
   } else {
     static_assert(std::is_same<T, u8>::value || std::is_same<T, u8&>::value ||
                       std::is_same<T, u16>::value ||
@@ -157,14 +317,16 @@ T ParameterTo(const Instruction::Parameter& parameter,
                   "Bad type provided!");
   }
 
+  if (parameter.IsMemory()) {
+    if constexpr (std::is_reference_v<T>)
+      UnvalidatedParameter();
+    else
+      return Memory::Read<T>(PrefixToValue(segment),
+                             EffectiveOffset(parameter));
+  }
+
   using PType = Instruction::Parameter::Type;
   if constexpr (std::is_same<T, u8>::value || std::is_same<T, u8&>::value) {
-    if (parameter.IsWord()) {
-      LOG("[BYTE] Tried to convert a WORD parameter to BYTE for " +
-          parameter.ToString(prefix) + "!");
-      throw ParameterLengthMismatchException(parameter);
-    }
-
     switch (parameter.GetType()) {
     case PType::AL:
       return AL;
@@ -186,54 +348,6 @@ T ParameterTo(const Instruction::Parameter& parameter,
     case PType::DH:
       return DH;
 
-    case PType::Value_WordAddress:
-      return Memory::Get<u8>(seg_val, parameter.GetData<u16>());
-    case PType::Value_BP_Offset:
-      return Memory::Get<u8>(seg_val, BP + parameter.GetData<u8>());
-    case PType::Value_BP_WordOffset:
-      return Memory::Get<u8>(seg_val, BP + parameter.GetData<u16>());
-    case PType::Value_BP_DI:
-      return Memory::Get<u8>(seg_val, BP + DI);
-    case PType::Value_BP_DI_Offset:
-      return Memory::Get<u8>(seg_val, BP + DI + parameter.GetData<u8>());
-    case PType::Value_BP_DI_WordOffset:
-      return Memory::Get<u8>(seg_val, BP + DI + parameter.GetData<u16>());
-    case PType::Value_BP_SI:
-      return Memory::Get<u8>(seg_val, BP + SI);
-    case PType::Value_BP_SI_Offset:
-      return Memory::Get<u8>(seg_val, BP + SI + parameter.GetData<u8>());
-    case PType::Value_BP_SI_WordOffset:
-      return Memory::Get<u8>(seg_val, BP + SI + parameter.GetData<u16>());
-    case PType::Value_BX:
-      return Memory::Get<u8>(seg_val, BX);
-    case PType::Value_BX_Offset:
-      return Memory::Get<u8>(seg_val, BX + parameter.GetData<u8>());
-    case PType::Value_BX_WordOffset:
-      return Memory::Get<u8>(seg_val, BX + parameter.GetData<u16>());
-    case PType::Value_BX_SI:
-      return Memory::Get<u8>(seg_val, BX + SI);
-    case PType::Value_BX_SI_Offset:
-      return Memory::Get<u8>(seg_val, BX + SI + parameter.GetData<u8>());
-    case PType::Value_BX_SI_WordOffset:
-      return Memory::Get<u8>(seg_val, BX + SI + parameter.GetData<u16>());
-    case PType::Value_BX_DI:
-      return Memory::Get<u8>(seg_val, BX + DI);
-    case PType::Value_BX_DI_Offset:
-      return Memory::Get<u8>(seg_val, BX + DI + parameter.GetData<u8>());
-    case PType::Value_BX_DI_WordOffset:
-      return Memory::Get<u8>(seg_val, BX + DI + parameter.GetData<u16>());
-    case PType::Value_DI:
-      return Memory::Get<u8>(seg_val, DI);
-    case PType::Value_DI_Offset:
-      return Memory::Get<u8>(seg_val, DI + parameter.GetData<u8>());
-    case PType::Value_DI_WordOffset:
-      return Memory::Get<u8>(seg_val, DI + parameter.GetData<u16>());
-    case PType::Value_SI:
-      return Memory::Get<u8>(seg_val, SI);
-    case PType::Value_SI_Offset:
-      return Memory::Get<u8>(seg_val, SI + parameter.GetData<u8>());
-    case PType::Value_SI_WordOffset:
-      return Memory::Get<u8>(seg_val, SI + parameter.GetData<u16>());
     default:
       if constexpr (std::is_same<T, u8>::value) {
         switch (parameter.GetType()) {
@@ -251,14 +365,10 @@ T ParameterTo(const Instruction::Parameter& parameter,
         }
       }
 
-      LOG("[BYTE] Unknown type: " + ParameterTypeToString(parameter.GetType()));
-      throw UnhandledParameterException(parameter);
+      UnvalidatedParameter();
     }
   } else if constexpr (std::is_same<T, u16>::value ||
                        std::is_same<T, u16&>::value) {
-    if (!parameter.IsWord())
-      throw ParameterLengthMismatchException(parameter);
-
     switch (parameter.GetType()) {
     case PType::AX:
       return AX;
@@ -289,85 +399,57 @@ T ParameterTo(const Instruction::Parameter& parameter,
     case PType::DI:
       return DI;
 
-    case PType::Value_WordAddress_Word:
-      return Memory::Get<u16>(seg_val, parameter.GetData<u16>());
-    case PType::Value_DI_Word:
-      return Memory::Get<u16>(seg_val, DI);
-    case PType::Value_DI_Offset_Word:
-      return Memory::Get<u16>(seg_val, DI + parameter.GetData<u8>());
-    case PType::Value_DI_WordOffset_Word:
-      return Memory::Get<u16>(seg_val, DI + parameter.GetData<u16>());
-    case PType::Value_SI_Word:
-      return Memory::Get<u16>(seg_val, SI);
-    case PType::Value_SI_Offset_Word:
-      return Memory::Get<u16>(seg_val, SI + parameter.GetData<u8>());
-    case PType::Value_SI_WordOffset_Word:
-      return Memory::Get<u16>(seg_val, SI + parameter.GetData<u16>());
-    case PType::Value_BP_Offset_Word:
-      return Memory::Get<u16>(seg_val, BP + parameter.GetData<u8>());
-    case PType::Value_BP_WordOffset_Word:
-      return Memory::Get<u16>(seg_val, BP + parameter.GetData<u16>());
-    case PType::Value_BP_DI_Word:
-      return Memory::Get<u16>(seg_val, BP + DI);
-    case PType::Value_BP_DI_Offset_Word:
-      return Memory::Get<u16>(seg_val, BP + DI + parameter.GetData<u8>());
-    case PType::Value_BP_DI_WordOffset_Word:
-      return Memory::Get<u16>(seg_val, BP + DI + parameter.GetData<u16>());
-    case PType::Value_BP_SI_Word:
-      return Memory::Get<u16>(seg_val, BP + SI);
-    case PType::Value_BP_SI_Offset_Word:
-      return Memory::Get<u16>(seg_val, BP + SI + parameter.GetData<u8>());
-    case PType::Value_BP_SI_WordOffset_Word:
-      return Memory::Get<u16>(seg_val, BP + SI + parameter.GetData<u16>());
-    case PType::Value_BX_Word:
-      return Memory::Get<u16>(seg_val, BX);
-    case PType::Value_BX_Offset_Word:
-      return Memory::Get<u16>(seg_val, BX + parameter.GetData<u8>());
-    case PType::Value_BX_WordOffset_Word:
-      return Memory::Get<u16>(seg_val, BX + parameter.GetData<u16>());
-    case PType::Value_BX_DI_Word:
-      return Memory::Get<u16>(seg_val, BX + DI);
-    case PType::Value_BX_DI_Offset_Word:
-      return Memory::Get<u16>(seg_val, BX + DI + parameter.GetData<u8>());
-    case PType::Value_BX_DI_WordOffset_Word:
-      return Memory::Get<u16>(seg_val, BX + DI + parameter.GetData<u16>());
-    case PType::Value_BX_SI_Word:
-      return Memory::Get<u16>(seg_val, BX + SI);
-    case PType::Value_BX_SI_Offset_Word:
-      return Memory::Get<u16>(seg_val, BX + SI + parameter.GetData<u8>());
-    case PType::Value_BX_SI_WordOffset_Word:
-      return Memory::Get<u16>(seg_val, BX + SI + parameter.GetData<u16>());
-
     default:
       if constexpr (std::is_same<T, u16>::value) {
         switch (parameter.GetType()) {
         case PType::Literal_Word:
-          return parameter.GetData<u16>();
         case PType::Literal_Word_Immediate:
-          return parameter.GetData<u16>();
         case PType::Literal_WordOffset:
           return parameter.GetData<u16>();
         default:
-          LOG("[WORD] Unknown type: " +
-              ParameterTypeToString(parameter.GetType()));
-          throw UnhandledParameterException(parameter);
           break;
         }
-      } else {
-        LOG("[WORD] Unknown type: " +
-            ParameterTypeToString(parameter.GetType()));
-        throw UnhandledParameterException(parameter);
       }
+
+      UnvalidatedParameter();
     }
   }
 }
 
-bool HandleRepetition();
+//! Overwrite a parameter of width T without reading it first
+template <typename T>
+void WriteParameter(const Instruction::Parameter& parameter,
+                    Instruction::SegmentPrefix segment, T value)
+{
+  if (parameter.IsMemory())
+    Memory::Write<T>(PrefixToValue(segment), EffectiveOffset(parameter), value);
+  else
+    ParameterTo<T&>(parameter, segment) = value;
+}
+
+//! Read, modify and write back a parameter of width T. modify gets a T&
+template <typename T, typename F>
+void ModifyParameter(const Instruction::Parameter& parameter,
+                     Instruction::SegmentPrefix segment, F modify)
+{
+  if (parameter.IsMemory())
+    Memory::Modify<T>(PrefixToValue(segment), EffectiveOffset(parameter),
+                      modify);
+  else
+    modify(ParameterTo<T&>(parameter, segment));
+}
+
+bool HandleRepetition(RepeatMode mode);
 
 //// Arithmetic
 void ADC(const Instruction& instruction);
 void ADD(const Instruction& instruction);
+void CBW(const Instruction& instruction);
+void CMP(const Instruction& instruction);
+void DAA(const Instruction& instruction);
 void DIV(const Instruction& instruction);
+void MUL(const Instruction& instruction);
+void NEG(const Instruction& instruction);
 void SBB(const Instruction& instruction);
 void SUB(const Instruction& instruction);
 
@@ -403,9 +485,37 @@ void JNS(const Instruction& instruction);
 void JZ(const Instruction& instruction);
 void JNZ(const Instruction& instruction);
 
+void LOOP(const Instruction& instruction);
+void LOOPNZ(const Instruction& instruction);
+
 void CALL(const Instruction& instruction);
 void RET(const Instruction& instruction);
 
+//// Data transfer
+void LDS(const Instruction& instruction);
+void LEA(const Instruction& instruction);
+void LES(const Instruction& instruction);
+void MOV(const Instruction& instruction);
+void XCHG(const Instruction& instruction);
+
+void PUSH(const Instruction& instruction);
+void POP(const Instruction& instruction);
+void PUSHF(const Instruction& instruction);
+void POPF(const Instruction& instruction);
+
+//// Processor control
+void CLC(const Instruction& instruction);
+void CMC(const Instruction& instruction);
+void STC(const Instruction& instruction);
+void CLD(const Instruction& instruction);
+void STD(const Instruction& instruction);
+void CLI(const Instruction& instruction);
+void STI(const Instruction& instruction);
+
+void HLT(const Instruction& instruction);
+void INT(const Instruction& instruction);
+void NOP(const Instruction& instruction);
+
 //// Bitwise operations
 void AND(const Instruction& instruction);
 void TEST(const Instruction& instruction);
@@ -431,11 +541,9 @@ void STOSB(const Instruction& instruction);
 void STOSW(const Instruction& instruction);
 //! \endcond PRIVATE
 
-void UpdateZF(u16 value);
-void UpdatePF(u16 value);
-void UpdateSF(i16 value);
-template <typename T> void UpdateOF(i32 value);
-template <typename T> void UpdateCF(i32 value);
+//! Set SF, ZF and PF from a result, for instructions that don't record
+//! their flags
+template <typename T> void UpdateSZP(T value);
 
 void CallInterrupt(u8 vector);
 bool CallBIOSInterrupt(u8 vector);
@@ -0,0 +1,22 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/CodeBytes.h"
+
+namespace Core::CPU
+{
+void CodeBytes::Mark(u32 address, u32 size)
+{
+  for (u32 i = address; i < address + size; i++)
+    m_bytes[i] = true;
+}
+
+void CodeBytes::ClearPage(u32 page)
+{
+  for (u32 i = 0; i < Memory::PAGE_SIZE; i++)
+    m_bytes[(page << Memory::PAGE_SHIFT) + i] = false;
+}
+
+void CodeBytes::Clear() { m_bytes.reset(); }
+} // namespace Core::CPU
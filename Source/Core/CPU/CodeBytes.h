@@ -0,0 +1,52 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include <bitset>
+
+#include "Common/Types.h"
+#include "Core/Memory.h"
+
+namespace Core::CPU
+{
+/**
+ * @brief The bytes of physical memory that instructions were taken from. Code
+ * and data usually share pages (especially in COM files), so writes are
+ * checked against the exact bytes instead of the whole page
+ */
+class CodeBytes
+{
+public:
+  //! Mark [address, address + size) as code
+  void Mark(u32 address, u32 size);
+
+  void ClearPage(u32 page);
+  void Clear();
+
+  /**
+   * @brief Call invalidate_page with every page in which [address, address +
+   * size) overlaps code. It's up to it to ClearPage() that page
+   */
+  template <typename F>
+  void Invalidate(u32 address, u32 size, F invalidate_page)
+  {
+    for (u32 i = address; i < address + size && i < Memory::SIZE; i++) {
+      if (!m_bytes[i])
+        continue;
+
+      const u32 page = i >> Memory::PAGE_SHIFT;
+
+      invalidate_page(page);
+
+      // Continue with the next page
+      i = ((page + 1) << Memory::PAGE_SHIFT) - 1;
+    }
+  }
+
+private:
+  std::bitset<Memory::SIZE> m_bytes;
+};
+} // namespace Core::CPU
@@ -0,0 +1,421 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/Cycles.h"
+
+#include <array>
+
+namespace Core::CPU
+{
+u64 cycles = 0;
+u64 idle_cycles = 0;
+
+namespace
+{
+using Type = Instruction::Type;
+using Parameter = Instruction::Parameter;
+using PType = Parameter::Type;
+
+// Effective address cycles by ModRM rm field, without and with displacement.
+// rm 110 without displacement is the direct address
+constexpr std::array<u8, 8> EA_CYCLES = {7, 8, 8, 7, 5, 5, 6, 5};
+constexpr std::array<u8, 8> EA_DISPLACEMENT_CYCLES = {11, 12, 12, 11,
+                                                      9,  9,  9,  9};
+
+// The 8088 moves words over its 8 bit bus one byte at a time
+constexpr u8 WORD_TRANSFER_CYCLES = 4;
+
+constexpr u8 SEGMENT_OVERRIDE_CYCLES = 2;
+
+// Setting up a REP prefixed string instruction
+constexpr u8 REPEAT_CYCLES = 9;
+
+enum class Operand { None, Register, Segment, Immediate, Memory, Other };
+
+Operand Classify(const Parameter& parameter)
+{
+  const PType type = parameter.GetType();
+
+  if (type == PType::None)
+    return Operand::None;
+
+  if (type >= PType::CS && type <= PType::SS)
+    return Operand::Segment;
+
+  if (type <= PType::SI && type != PType::IP)
+    return Operand::Register;
+
+  switch (type) {
+  case PType::Literal_Byte:
+  case PType::Literal_Byte_Immediate:
+  case PType::Literal_Word:
+  case PType::Literal_Word_Immediate:
+    return Operand::Immediate;
+  default:
+    return parameter.IsMemory() ? Operand::Memory : Operand::Other;
+  }
+}
+
+bool IsAccumulator(const Parameter& parameter)
+{
+  return parameter.GetType() == PType::AL || parameter.GetType() == PType::AX;
+}
+
+// Immediates of the short accumulator encodings (04, A8, B0 and friends)
+bool IsShortImmediate(const Parameter& parameter)
+{
+  return parameter.GetType() == PType::Literal_Byte_Immediate ||
+         parameter.GetType() == PType::Literal_Word_Immediate;
+}
+
+// Cycles of the operand bytes the bus has to move, on top of the 8086 timing
+u16 Transfers(bool word, u8 count)
+{
+  return word ? WORD_TRANSFER_CYCLES * count : 0;
+}
+
+// ADD, ADC, SUB, SBB, AND, OR and XOR
+u16 ArithmeticCycles(Operand dst, Operand src, bool word, u8 ea)
+{
+  if (dst == Operand::Memory)
+    return (src == Operand::Immediate ? 17 : 16) + ea + Transfers(word, 2);
+
+  if (src == Operand::Memory)
+    return 9 + ea + Transfers(word, 1);
+
+  return src == Operand::Immediate ? 4 : 3;
+}
+
+u16 CompareCycles(Operand dst, Operand src, bool word, u8 ea)
+{
+  if (dst == Operand::Memory)
+    return (src == Operand::Immediate ? 10 : 9) + ea + Transfers(word, 1);
+
+  if (src == Operand::Memory)
+    return 9 + ea + Transfers(word, 1);
+
+  return src == Operand::Immediate ? 4 : 3;
+}
+
+u16 TestCycles(const Instruction& ins, Operand dst, Operand src, bool word,
+               u8 ea)
+{
+  if (dst == Operand::Memory || src == Operand::Memory)
+    return (src == Operand::Immediate ? 11 : 9) + ea + Transfers(word, 1);
+
+  if (src != Operand::Immediate)
+    return 3;
+
+  return IsShortImmediate(ins.GetParameters()[1]) ? 4 : 5;
+}
+
+u16 MoveCycles(const Instruction& ins, Operand dst, Operand src, bool word,
+               u8 ea)
+{
+  const auto& parameters = ins.GetParameters();
+
+  // A0 - A3 have the address right in the opcode, no ModRM to decode
+  if ((IsAccumulator(parameters[0]) && src == Operand::Memory &&
+       parameters[1].GetAddressing() == 0b00'110) ||
+      (IsAccumulator(parameters[1]) && dst == Operand::Memory &&
+       parameters[0].GetAddressing() == 0b00'110))
+    return 10 + Transfers(word, 1);
+
+  if (dst == Operand::Memory)
+    return (src == Operand::Immediate ? 10 : 9) + ea + Transfers(word, 1);
+
+  if (src == Operand::Memory)
+    return 8 + ea + Transfers(word, 1);
+
+  return src == Operand::Immediate ? 4 : 2;
+}
+
+u16 MultiplyCycles(Type type, bool memory, bool word, u8 ea)
+{
+  u16 base = 0;
+
+  switch (type) {
+  case Type::MUL:
+    base = word ? 118 : 70;
+    break;
+  case Type::IMUL:
+    base = word ? 128 : 80;
+    break;
+  case Type::DIV:
+    base = word ? 144 : 80;
+    break;
+  default:
+    base = word ? 165 : 101;
+    break;
+  }
+
+  return memory ? base + 6 + ea + Transfers(word, 1) : base;
+}
+
+u16 StringCycles(Type type)
+{
+  switch (type) {
+  case Type::MOVSB:
+    return 18;
+  case Type::MOVSW:
+    return 18 + Transfers(true, 2);
+  case Type::CMPSB:
+    return 22;
+  case Type::CMPSW:
+    return 22 + Transfers(true, 2);
+  case Type::SCASB:
+    return 15;
+  case Type::SCASW:
+    return 15 + Transfers(true, 1);
+  case Type::LODSB:
+    return 12;
+  case Type::LODSW:
+    return 12 + Transfers(true, 1);
+  case Type::STOSB:
+    return 11;
+  default:
+    return 11 + Transfers(true, 1);
+  }
+}
+
+u16 BaseCycles(const Instruction& ins)
+{
+  const auto& parameters = ins.GetParameters();
+  const Operand dst = Classify(parameters[0]);
+  const Operand src = Classify(parameters[1]);
+  const bool word = parameters[0].IsWord();
+  const bool memory = dst == Operand::Memory || src == Operand::Memory;
+
+  u8 ea = 0;
+
+  if (dst == Operand::Memory)
+    ea = EffectiveAddressCycles(parameters[0]);
+  else if (src == Operand::Memory)
+    ea = EffectiveAddressCycles(parameters[1]);
+
+  switch (ins.GetType()) {
+  case Type::ADD:
+  case Type::ADC:
+  case Type::SUB:
+  case Type::SBB:
+  case Type::AND:
+  case Type::OR:
+  case Type::XOR:
+    return ArithmeticCycles(dst, src, word, ea);
+  case Type::CMP:
+    return CompareCycles(dst, src, word, ea);
+  case Type::TEST:
+    return TestCycles(ins, dst, src, word, ea);
+  case Type::MOV:
+    return MoveCycles(ins, dst, src, word, ea);
+
+  case Type::INC:
+  case Type::DEC:
+    if (memory)
+      return 15 + ea + Transfers(word, 2);
+
+    return word ? 2 : 3;
+  case Type::NEG:
+  case Type::NOT:
+    return memory ? 16 + ea + Transfers(word, 2) : 3;
+  case Type::MUL:
+  case Type::IMUL:
+  case Type::DIV:
+  case Type::IDIV:
+    return MultiplyCycles(ins.GetType(), memory, word, ea);
+
+  case Type::ROL:
+  case Type::ROR:
+  case Type::RCL:
+  case Type::RCR:
+  case Type::SHL:
+  case Type::SHR:
+    // Shifts by CL cost SHIFT_BIT_CYCLES per bit on top
+    if (parameters[1].GetType() == PType::CL)
+      return memory ? 20 + ea + Transfers(word, 2) : 8;
+
+    return memory ? 15 + ea + Transfers(word, 2) : 2;
+
+  case Type::PUSH:
+    if (memory)
+      return 16 + ea + Transfers(true, 2);
+
+    return (dst == Operand::Segment ? 10 : 11) + Transfers(true, 1);
+  case Type::POP:
+    return memory ? 17 + ea + Transfers(true, 2) : 8 + Transfers(true, 1);
+  case Type::PUSHF:
+    return 10 + Transfers(true, 1);
+  case Type::POPF:
+    return 8 + Transfers(true, 1);
+
+  case Type::XCHG:
+    if (memory)
+      return 17 + ea + Transfers(word, 2);
+
+    return IsAccumulator(parameters[1]) ? 3 : 4;
+  case Type::LEA:
+    return 2 + ea;
+  case Type::LDS:
+  case Type::LES:
+    return 16 + ea + Transfers(true, 2);
+  case Type::XLAT:
+    return 11;
+
+  case Type::CBW:
+  case Type::CLC:
+  case Type::STC:
+  case Type::CMC:
+  case Type::CLD:
+  case Type::STD:
+  case Type::CLI:
+  case Type::STI:
+  case Type::HLT:
+  case Type::LOCK:
+    return 2;
+  case Type::CWD:
+    return 5;
+  case Type::NOP:
+  case Type::WAIT:
+    return 3;
+  case Type::LAHF:
+  case Type::SAHF:
+  case Type::AAA:
+  case Type::AAS:
+  case Type::DAA:
+  case Type::DAS:
+    return 4;
+  case Type::AAM:
+    return 83;
+  case Type::AAD:
+    return 60;
+
+  case Type::IN:
+    return (src == Operand::Immediate ? 10 : 8) + Transfers(word, 1);
+  case Type::OUT:
+    return (dst == Operand::Immediate ? 10 : 8) +
+           Transfers(parameters[1].IsWord(), 1);
+
+  case Type::JMP:
+    if (memory)
+      return 18 + ea + Transfers(true, 1);
+
+    return dst == Operand::Register ? 11 : 15;
+  case Type::CALL:
+    if (memory)
+      return 21 + ea + Transfers(true, 2);
+
+    if (dst == Operand::Register)
+      return 16 + Transfers(true, 1);
+
+    if (parameters[0].GetType() == PType::Literal_LongAddress_Immediate)
+      return 28 + Transfers(true, 2);
+
+    return 19 + Transfers(true, 1);
+  case Type::RET:
+    return (dst == Operand::Immediate ? 12 : 8) + Transfers(true, 1);
+  case Type::RETF:
+    return (dst == Operand::Immediate ? 17 : 18) + Transfers(true, 2);
+  case Type::IRET:
+    return 24 + Transfers(true, 3);
+  case Type::INT:
+    return (parameters[0].GetType() == PType::Implied_3 ? 52 : 51) +
+           Transfers(true, 5);
+  case Type::INTO:
+    return 4;
+
+  // Taken branches cost BRANCH_TAKEN_CYCLES on top
+  case Type::JCXZ:
+  case Type::LOOPZ:
+    return 6;
+  case Type::LOOP:
+  case Type::LOOPNZ:
+    return 5;
+  case Type::JZ:
+  case Type::JNZ:
+  case Type::JC:
+  case Type::JNC:
+  case Type::JPE:
+  case Type::JNS:
+  case Type::JNO:
+  case Type::JNE:
+  case Type::JL:
+  case Type::JLE:
+  case Type::JG:
+  case Type::JGE:
+  case Type::JA:
+  case Type::JB:
+  case Type::JNB:
+  case Type::JPO:
+  case Type::JO:
+  case Type::JS:
+  case Type::JBE:
+    return 4;
+
+  case Type::MOVSB:
+  case Type::MOVSW:
+  case Type::CMPSB:
+  case Type::CMPSW:
+  case Type::SCASB:
+  case Type::SCASW:
+  case Type::LODSB:
+  case Type::LODSW:
+  case Type::STOSB:
+  case Type::STOSW:
+    if (ins.GetRepeatMode() != RepeatMode::None)
+      return REPEAT_CYCLES;
+
+    return StringCycles(ins.GetType());
+
+  default:
+    return 0;
+  }
+}
+} // namespace
+
+u8 EffectiveAddressCycles(const Parameter& parameter)
+{
+  const u8 addressing = parameter.GetAddressing();
+  const u8 rm = addressing & 0b111;
+
+  return (addressing >> 3) == 0 ? EA_CYCLES[rm] : EA_DISPLACEMENT_CYCLES[rm];
+}
+
+u16 InstructionCycles(const Instruction& ins)
+{
+  const u16 base = BaseCycles(ins);
+
+  if (ins.GetPrefix() != Instruction::SegmentPrefix::None)
+    return base + SEGMENT_OVERRIDE_CYCLES;
+
+  return base;
+}
+
+u8 RepeatedCycles(Type type)
+{
+  switch (type) {
+  case Type::MOVSB:
+    return 17;
+  case Type::MOVSW:
+    return 17 + Transfers(true, 2);
+  case Type::CMPSB:
+    return 22;
+  case Type::CMPSW:
+    return 22 + Transfers(true, 2);
+  case Type::SCASB:
+    return 15;
+  case Type::SCASW:
+    return 15 + Transfers(true, 1);
+  case Type::LODSB:
+    return 13;
+  case Type::LODSW:
+    return 13 + Transfers(true, 1);
+  case Type::STOSB:
+    return 10;
+  case Type::STOSW:
+    return 10 + Transfers(true, 1);
+  default:
+    return 0;
+  }
+}
+} // namespace Core::CPU
@@ -0,0 +1,47 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include "Common/Types.h"
+
+#include "Core/CPU/Instruction.h"
+
+namespace Core::CPU
+{
+//! 8088 clock cycles executed so far. Only ever grows
+extern u64 cycles;
+//! Part of cycles that passed while Start() waited for the guest to stop
+//! idling or halting, without executing anything
+extern u64 idle_cycles;
+
+/**
+ * @brief Cycles an 8088 takes for the instruction, including effective
+ * address calculation, segment override prefixes and the 4 extra cycles per
+ * word its 8 bit bus has to transfer. Attached to instructions when decoding.
+ *
+ * Whatever depends on the outcome (taken branches, REP iterations, shifts by
+ * CL) gets charged on top by the handlers. MUL and DIV always cost their
+ * minimum. Where the 8088 has a shorter accumulator encoding, the accumulator
+ * forms are assumed to use it, like assemblers do.
+ */
+u16 InstructionCycles(const Instruction& ins);
+
+//! Cycles the 8088 spends calculating the address of a memory parameter
+u8 EffectiveAddressCycles(const Instruction::Parameter& parameter);
+
+//! Cycles every iteration of a REP prefixed string instruction takes on top
+//! of what InstructionCycles() charged for setting up the repetition
+u8 RepeatedCycles(Instruction::Type type);
+
+//! Extra cycles of a conditional jump, JCXZ or LOOP that is taken
+constexpr u8 BRANCH_TAKEN_CYCLES = 12;
+
+//! Extra cycles of a taken LOOPNZ, which is a bit slower than the others
+constexpr u8 LOOPNZ_TAKEN_CYCLES = 14;
+
+//! Extra cycles per bit of a shift or rotate by CL
+constexpr u8 SHIFT_BIT_CYCLES = 4;
+} // namespace Core::CPU
@@ -0,0 +1,400 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/Dispatch.h"
+
+#include <array>
+
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Exception.h"
+#include "Core/CPU/Instructions/Forms.h"
+#include "Core/CPU/Instructions/Operations.h"
+
+namespace Core::CPU
+{
+DispatchMode dispatch_mode = DispatchMode::Threaded;
+
+namespace
+{
+using Type = Instruction::Type;
+using Parameter = Instruction::Parameter;
+using PType = Parameter::Type;
+using Handler = Instruction::Handler;
+
+enum class Operand { Register, Immediate, Memory, Other };
+
+Operand Classify(const Parameter& parameter)
+{
+  const PType type = parameter.GetType();
+
+  switch (type) {
+  case PType::AL:
+  case PType::AH:
+  case PType::BL:
+  case PType::BH:
+  case PType::CL:
+  case PType::CH:
+  case PType::DL:
+  case PType::DH:
+  case PType::AX:
+  case PType::BX:
+  case PType::CX:
+  case PType::DX:
+  case PType::CS:
+  case PType::DS:
+  case PType::ES:
+  case PType::SS:
+  case PType::BP:
+  case PType::SP:
+  case PType::DI:
+  case PType::SI:
+    return Operand::Register;
+  case PType::Literal_Byte:
+  case PType::Literal_Byte_Immediate:
+  case PType::Literal_Word:
+  case PType::Literal_Word_Immediate:
+    return Operand::Immediate;
+  default:
+    if (parameter.IsMemory())
+      return Operand::Memory;
+
+    return Operand::Other;
+  }
+}
+
+using namespace Forms;
+
+template <typename Op, typename T>
+Handler SelectBinary(Operand dst, Operand src)
+{
+  switch (dst) {
+  case Operand::Register:
+    switch (src) {
+    case Operand::Register:
+      return &Binary<Op, T, RegisterOperand, RegisterOperand>;
+    case Operand::Immediate:
+      return &Binary<Op, T, RegisterOperand, ImmediateOperand>;
+    case Operand::Memory:
+      return &Binary<Op, T, RegisterOperand, MemoryOperand>;
+    default:
+      return nullptr;
+    }
+  case Operand::Memory:
+    switch (src) {
+    case Operand::Register:
+      return &Binary<Op, T, MemoryOperand, RegisterOperand>;
+    case Operand::Immediate:
+      return &Binary<Op, T, MemoryOperand, ImmediateOperand>;
+    default:
+      return nullptr;
+    }
+  default:
+    return nullptr;
+  }
+}
+
+template <typename Op> Handler SelectBinary(const Instruction& ins)
+{
+  if (ins.GetParameterCount() != 2)
+    return nullptr;
+
+  const auto& dst = ins.GetParameters()[0];
+  const auto& src = ins.GetParameters()[1];
+
+  if (dst.IsWord() && src.IsWord())
+    return SelectBinary<Op, u16>(Classify(dst), Classify(src));
+
+  if (!dst.IsWord() && !src.IsWord())
+    return SelectBinary<Op, u8>(Classify(dst), Classify(src));
+
+  // Word operations with a byte immediate (83 /r)
+  if (dst.IsWord() && Classify(src) == Operand::Immediate) {
+    switch (Classify(dst)) {
+    case Operand::Register:
+      return &Binary<Op, u16, RegisterOperand, SignExtendedImmediateOperand>;
+    case Operand::Memory:
+      return &Binary<Op, u16, MemoryOperand, SignExtendedImmediateOperand>;
+    default:
+      return nullptr;
+    }
+  }
+
+  return nullptr;
+}
+
+template <typename Op> Handler SelectUnary(const Instruction& ins)
+{
+  const auto& dst = ins.GetParameters()[0];
+  const bool word = dst.IsWord();
+
+  switch (Classify(dst)) {
+  case Operand::Register:
+    return word ? &Unary<Op, u16, RegisterOperand>
+                : &Unary<Op, u8, RegisterOperand>;
+  case Operand::Memory:
+    return word ? &Unary<Op, u16, MemoryOperand>
+                : &Unary<Op, u8, MemoryOperand>;
+  default:
+    return nullptr;
+  }
+}
+
+template <typename Op, typename T, typename Count>
+Handler SelectShift(Operand dst)
+{
+  switch (dst) {
+  case Operand::Register:
+    return &Shift<Op, T, RegisterOperand, Count>;
+  case Operand::Memory:
+    return &Shift<Op, T, MemoryOperand, Count>;
+  default:
+    return nullptr;
+  }
+}
+
+template <typename Op> Handler SelectShift(const Instruction& ins)
+{
+  if (ins.GetParameterCount() != 2)
+    return nullptr;
+
+  const auto& dst = ins.GetParameters()[0];
+  const auto& count = ins.GetParameters()[1];
+
+  // Counts are either 1 (D0, D1) or CL (D2, D3)
+  if (count.GetType() == PType::Implied_1) {
+    return dst.IsWord() ? SelectShift<Op, u16, ImpliedOneOperand>(Classify(dst))
+                        : SelectShift<Op, u8, ImpliedOneOperand>(Classify(dst));
+  }
+
+  if (count.GetType() == PType::CL) {
+    return dst.IsWord() ? SelectShift<Op, u16, RegisterOperand>(Classify(dst))
+                        : SelectShift<Op, u8, RegisterOperand>(Classify(dst));
+  }
+
+  return nullptr;
+}
+
+void Unhandled(const Instruction& ins)
+{
+  RaiseFault(FaultKind::UnhandledInstruction,
+             UnhandledInstructionException(ins));
+}
+
+Handler SelectGenericHandler(Type type)
+{
+  switch (type) {
+  case Type::ADC:
+    return &ADC;
+  case Type::ADD:
+    return &ADD;
+  case Type::AND:
+    return &AND;
+  case Type::CALL:
+    return &CALL;
+  case Type::RET:
+    return &RET;
+  case Type::CBW:
+    return &CBW;
+  case Type::CLC:
+    return &CLC;
+  case Type::CMC:
+    return &CMC;
+  case Type::STC:
+    return &STC;
+  case Type::CLD:
+    return &CLD;
+  case Type::STD:
+    return &STD;
+  case Type::CLI:
+    return &CLI;
+  case Type::STI:
+    return &STI;
+  case Type::CMP:
+    return &CMP;
+  case Type::CMPSB:
+    return &CMPSB;
+  case Type::CMPSW:
+    return &CMPSW;
+  case Type::HLT:
+    return &HLT;
+  case Type::INC:
+    return &INC;
+  case Type::DAA:
+    return &DAA;
+  case Type::DEC:
+    return &DEC;
+  case Type::IDIV: // TODO: This is a bad way to stub IDIV...
+  case Type::DIV:
+    return &DIV;
+  case Type::INT:
+    return &INT;
+  case Type::JMP:
+    return &JMP;
+  case Type::JA:
+    return &JA;
+  case Type::JB:
+    return &JB;
+  case Type::JBE:
+    return &JBE;
+  case Type::JNB:
+    return &JNB;
+  case Type::JCXZ:
+    return &JCXZ;
+  case Type::JS:
+    return &JS;
+  case Type::JNS:
+    return &JNS;
+  case Type::JPE:
+    return &JPE;
+  case Type::JPO:
+    return &JPO;
+  case Type::JG:
+    return &JG;
+  case Type::JGE:
+    return &JGE;
+  case Type::JL:
+    return &JL;
+  case Type::JLE:
+    return &JLE;
+  case Type::JO:
+    return &JO;
+  case Type::JNO:
+    return &JNO;
+  case Type::JZ:
+    return &JZ;
+  case Type::JNZ:
+    return &JNZ;
+  case Type::LDS:
+    return &LDS;
+  case Type::LEA:
+    return &LEA;
+  case Type::LES:
+    return &LES;
+  case Type::LODSB:
+    return &LODSB;
+  case Type::LODSW:
+    return &LODSW;
+  case Type::LOOP:
+    return &LOOP;
+  case Type::LOOPNZ:
+    return &LOOPNZ;
+  case Type::MOV:
+    return &MOV;
+  case Type::MOVSB:
+    return &MOVSB;
+  case Type::MOVSW:
+    return &MOVSW;
+  case Type::IMUL: // TODO: This is a bad way to stub IMUL...
+  case Type::MUL:
+    return &MUL;
+  case Type::NEG:
+    return &NEG;
+  case Type::NOP:
+    return &NOP;
+  case Type::OR:
+    return &OR;
+  case Type::PUSH:
+    return &PUSH;
+  case Type::PUSHF:
+    return &PUSHF;
+  case Type::POPF:
+    return &POPF;
+  case Type::POP:
+    return &POP;
+  case Type::ROL:
+    return &ROL;
+  case Type::ROR:
+    return &ROR;
+  case Type::SHL:
+    return &SHL;
+  case Type::SHR:
+    return &SHR;
+  case Type::STOSB:
+    return &STOSB;
+  case Type::STOSW:
+    return &STOSW;
+  case Type::SBB:
+    return &SBB;
+  case Type::SUB:
+    return &SUB;
+  case Type::TEST:
+    return &TEST;
+  case Type::XCHG:
+    return &XCHG;
+  case Type::XOR:
+    return &XOR;
+  default:
+    return &Unhandled;
+  }
+}
+} // namespace
+
+Instruction::Handler SelectHandler(const Instruction& ins)
+{
+  Handler handler = nullptr;
+
+  switch (ins.GetType()) {
+  case Type::MOV:
+    handler = SelectBinary<Operations::Mov>(ins);
+    break;
+  case Type::ADD:
+    handler = SelectBinary<Operations::Add>(ins);
+    break;
+  case Type::ADC:
+    handler = SelectBinary<Operations::Adc>(ins);
+    break;
+  case Type::SUB:
+    handler = SelectBinary<Operations::Sub>(ins);
+    break;
+  case Type::SBB:
+    handler = SelectBinary<Operations::Sbb>(ins);
+    break;
+  case Type::CMP:
+    handler = SelectBinary<Operations::Cmp>(ins);
+    break;
+  case Type::AND:
+    handler = SelectBinary<Operations::And>(ins);
+    break;
+  case Type::TEST:
+    handler = SelectBinary<Operations::Test>(ins);
+    break;
+  case Type::OR:
+    handler = SelectBinary<Operations::Or>(ins);
+    break;
+  case Type::XOR:
+    handler = SelectBinary<Operations::Xor>(ins);
+    break;
+  case Type::INC:
+    handler = SelectUnary<Operations::Inc>(ins);
+    break;
+  case Type::DEC:
+    handler = SelectUnary<Operations::Dec>(ins);
+    break;
+  case Type::NEG:
+    handler = SelectUnary<Operations::Neg>(ins);
+    break;
+  case Type::ROL:
+    handler = SelectShift<Operations::Rol>(ins);
+    break;
+  case Type::ROR:
+    handler = SelectShift<Operations::Ror>(ins);
+    break;
+  case Type::SHL:
+    handler = SelectShift<Operations::Shl>(ins);
+    break;
+  case Type::SHR:
+    handler = SelectShift<Operations::Shr>(ins);
+    break;
+  default:
+    break;
+  }
+
+  return handler != nullptr ? handler : SelectGenericHandler(ins.GetType());
+}
+
+bool HasHandler(const Instruction& ins)
+{
+  return SelectGenericHandler(ins.GetType()) != &Unhandled;
+}
+} // namespace Core::CPU
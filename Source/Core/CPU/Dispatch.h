@@ -0,0 +1,33 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include "Common/Types.h"
+
+#include "Core/CPU/Instruction.h"
+
+namespace Core::CPU
+{
+enum class DispatchMode : u8 {
+  //! Switch over the instruction type, then over every parameter type
+  Switch,
+  //! Call the handler selected when the instruction was decoded
+  Threaded
+};
+
+//! How Tick() gets from a decoded instruction to its implementation
+extern DispatchMode dispatch_mode;
+
+/**
+ * @brief Select the function executing a decoded instruction. Common
+ * instructions get handlers specialised on their operand kinds (register,
+ * immediate or memory), everything else runs the generic handler.
+ */
+Instruction::Handler SelectHandler(const Instruction& ins);
+
+//! Whether the interpreter implements the instruction's type at all
+bool HasHandler(const Instruction& ins);
+} // namespace Core::CPU
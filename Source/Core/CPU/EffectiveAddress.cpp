@@ -0,0 +1,56 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/EffectiveAddress.h"
+
+#include "Core/CPU/CPU.h"
+
+namespace Core::CPU
+{
+//! \cond PRIVATE
+// mod 0 has no displacement, except for rm 6 which is a plain address
+static u16 BX_SI(u16) { return BX + SI; }
+static u16 BX_DI(u16) { return BX + DI; }
+static u16 BP_SI(u16) { return BP + SI; }
+static u16 BP_DI(u16) { return BP + DI; }
+static u16 SI_(u16) { return SI; }
+static u16 DI_(u16) { return DI; }
+static u16 Direct(u16 address) { return address; }
+static u16 BX_(u16) { return BX; }
+
+// mod 1 has a sign extended byte displacement
+static u16 Disp8(u16 displacement)
+{
+  return static_cast<u16>(static_cast<i8>(displacement));
+}
+
+static u16 BX_SI_Disp8(u16 d) { return BX + SI + Disp8(d); }
+static u16 BX_DI_Disp8(u16 d) { return BX + DI + Disp8(d); }
+static u16 BP_SI_Disp8(u16 d) { return BP + SI + Disp8(d); }
+static u16 BP_DI_Disp8(u16 d) { return BP + DI + Disp8(d); }
+static u16 SI_Disp8(u16 d) { return SI + Disp8(d); }
+static u16 DI_Disp8(u16 d) { return DI + Disp8(d); }
+static u16 BP_Disp8(u16 d) { return BP + Disp8(d); }
+static u16 BX_Disp8(u16 d) { return BX + Disp8(d); }
+
+// mod 2 has a word displacement
+static u16 BX_SI_Disp16(u16 d) { return BX + SI + d; }
+static u16 BX_DI_Disp16(u16 d) { return BX + DI + d; }
+static u16 BP_SI_Disp16(u16 d) { return BP + SI + d; }
+static u16 BP_DI_Disp16(u16 d) { return BP + DI + d; }
+static u16 SI_Disp16(u16 d) { return SI + d; }
+static u16 DI_Disp16(u16 d) { return DI + d; }
+static u16 BP_Disp16(u16 d) { return BP + d; }
+static u16 BX_Disp16(u16 d) { return BX + d; }
+//! \endcond PRIVATE
+
+const std::array<EAFunction, 24> ea_functions = {
+    BX_SI,        BX_DI,        BP_SI,        BP_DI,
+    SI_,          DI_,          Direct,       BX_,
+    BX_SI_Disp8,  BX_DI_Disp8,  BP_SI_Disp8,  BP_DI_Disp8,
+    SI_Disp8,     DI_Disp8,     BP_Disp8,     BX_Disp8,
+    BX_SI_Disp16, BX_DI_Disp16, BP_SI_Disp16, BP_DI_Disp16,
+    SI_Disp16,    DI_Disp16,    BP_Disp16,    BX_Disp16,
+};
+} // namespace Core::CPU
@@ -0,0 +1,31 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include <array>
+
+#include "Common/Types.h"
+
+#include "Core/CPU/Instruction.h"
+
+namespace Core::CPU
+{
+//! Computes the offset of a memory operand from its displacement
+using EAFunction = u16 (*)(u16 displacement);
+
+/**
+ * @brief Effective address calculation of every ModRM memory form, indexed
+ * by Instruction::Parameter::GetAddressing(). mod 3 selects a register and
+ * has no entry.
+ */
+extern const std::array<EAFunction, 24> ea_functions;
+
+//! Offset of a memory parameter within its segment
+inline u16 EffectiveOffset(const Instruction::Parameter& parameter)
+{
+  return ea_functions[parameter.GetAddressing()](parameter.GetData<u16>());
+}
+} // namespace Core::CPU
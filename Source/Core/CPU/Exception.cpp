@@ -80,3 +80,11 @@ UnhandledParameterException::UnhandledParameterException(
                    String::ToHex(CPU::LAST_IP))
 {
 }
+
+JITMismatchException::JITMismatchException(u16 segment, u16 offset,
+                                           const std::string& what)
+    : CPUException("Translated block at " + String::ToHex(segment) + ":" +
+                   String::ToHex(offset) + " disagrees with the interpreter: " +
+                   what)
+{
+}
@@ -2,6 +2,7 @@
 //! \file
 
 #include <exception>
+#include <stdexcept>
 
 #include "Core/CPU/Instruction.h"
 
@@ -71,9 +72,11 @@ class UnhandledInterruptException : public CPUException
 {
 };
 
-//! Thrown whenever non-existant memory is accessed
-class MemoryOutOfRangeException : public CPUException
+//! Thrown in lockstep mode when translated code and the interpreter disagree
+class JITMismatchException : public CPUException
 {
+public:
+  JITMismatchException(u16 segment, u16 offset, const std::string& what);
 };
 
 } // namespace Core::CPU
@@ -0,0 +1,551 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/Expression.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <utility>
+
+#include "Core/CPU/CPU.h"
+#include "Core/Memory.h"
+
+namespace Core::CPU
+{
+enum class Expression::Op : u8 {
+  Constant,
+  Word,
+  Byte,
+  Flag,
+  // Physical address on the stack
+  ReadByte,
+  ReadWord,
+  // Segment and offset on the stack
+  ReadFarByte,
+  ReadFarWord,
+
+  Not,
+  Complement,
+  Negate,
+
+  Multiply,
+  Divide,
+  Modulo,
+  Add,
+  Subtract,
+  ShiftLeft,
+  ShiftRight,
+  Less,
+  LessEqual,
+  Greater,
+  GreaterEqual,
+  Equal,
+  NotEqual,
+  And,
+  Xor,
+  Or,
+  LogicalAnd,
+  LogicalOr,
+};
+
+namespace
+{
+enum class Flag : u32 { CF, PF, AF, ZF, SF, IF, DF, OF };
+
+bool ReadFlag(Flag flag)
+{
+  switch (flag) {
+  case Flag::CF:
+    return CF;
+  case Flag::PF:
+    return PF;
+  case Flag::AF:
+    return AF;
+  case Flag::ZF:
+    return ZF;
+  case Flag::SF:
+    return SF;
+  case Flag::IF:
+    return IF;
+  case Flag::DF:
+    return DF;
+  default:
+    return OF;
+  }
+}
+
+// Reads past the end of memory result in 0 instead of a fault
+template <typename T> u32 ReadMemory(u32 address)
+{
+  if (address > Memory::SIZE - sizeof(T))
+    return 0;
+
+  T value;
+  std::memcpy(&value, Memory::Get().data() + address, sizeof(T));
+  return value;
+}
+} // namespace
+
+// Recursive descent over the text, emitting the program in postfix order
+class ExpressionCompiler
+{
+public:
+  using Op = Expression::Op;
+  using Step = Expression::Step;
+
+  explicit ExpressionCompiler(const std::string& text) : m_text(text) {}
+
+  bool Compile(std::vector<Step>& code, std::string& error)
+  {
+    if (!Binary(0))
+      return Fail(code, error);
+
+    SkipSpace();
+
+    if (m_pos != m_text.size()) {
+      m_error = "Unexpected '" + std::string(1, m_text[m_pos]) + "'";
+      return Fail(code, error);
+    }
+
+    if (m_max_depth > Expression::MAX_DEPTH) {
+      m_error = "Too deeply nested";
+      return Fail(code, error);
+    }
+
+    code = std::move(m_code);
+    return true;
+  }
+
+private:
+  const std::string& m_text;
+  size_t m_pos = 0;
+  std::vector<Step> m_code;
+  size_t m_depth = 0;
+  size_t m_max_depth = 0;
+  std::string m_error;
+
+  bool Fail(std::vector<Step>& code, std::string& error)
+  {
+    code.clear();
+    error = m_error + " at column " + std::to_string(m_pos + 1);
+    return false;
+  }
+
+  void SkipSpace()
+  {
+    while (m_pos < m_text.size() && std::isspace(m_text[m_pos]))
+      m_pos++;
+  }
+
+  bool Accept(char c)
+  {
+    SkipSpace();
+
+    if (m_pos >= m_text.size() || m_text[m_pos] != c)
+      return false;
+
+    m_pos++;
+    return true;
+  }
+
+  bool Expect(char c)
+  {
+    if (Accept(c))
+      return true;
+
+    m_error = "Expected '" + std::string(1, c) + "'";
+    return false;
+  }
+
+  void Emit(Op op, u32 value = 0, const void* pointer = nullptr)
+  {
+    m_code.push_back({op, value, pointer});
+
+    switch (op) {
+    case Op::Constant:
+    case Op::Word:
+    case Op::Byte:
+    case Op::Flag:
+      m_max_depth = std::max(m_max_depth, ++m_depth);
+      break;
+    case Op::ReadByte:
+    case Op::ReadWord:
+    case Op::Not:
+    case Op::Complement:
+    case Op::Negate:
+      break;
+    default:
+      m_depth--;
+      break;
+    }
+  }
+
+  // Binary operator at the current position and its precedence, longest
+  // match first
+  std::pair<Op, int> PeekBinary(size_t& length)
+  {
+    struct Operator {
+      const char* text;
+      Op op;
+      int precedence;
+    };
+
+    static const std::array<Operator, 18> OPERATORS = {{
+        {"||", Op::LogicalOr, 1},  {"&&", Op::LogicalAnd, 2},
+        {"==", Op::Equal, 6},      {"!=", Op::NotEqual, 6},
+        {"<=", Op::LessEqual, 7},  {">=", Op::GreaterEqual, 7},
+        {"<<", Op::ShiftLeft, 8},  {">>", Op::ShiftRight, 8},
+        {"|", Op::Or, 3},          {"^", Op::Xor, 4},
+        {"&", Op::And, 5},         {"<", Op::Less, 7},
+        {">", Op::Greater, 7},     {"+", Op::Add, 9},
+        {"-", Op::Subtract, 9},    {"*", Op::Multiply, 10},
+        {"/", Op::Divide, 10},     {"%", Op::Modulo, 10},
+    }};
+
+    SkipSpace();
+
+    for (const Operator& op : OPERATORS) {
+      length = std::strlen(op.text);
+
+      if (m_text.compare(m_pos, length, op.text) == 0)
+        return {op.op, op.precedence};
+    }
+
+    return {Op::Constant, 0};
+  }
+
+  bool Binary(int min_precedence)
+  {
+    if (!Unary())
+      return false;
+
+    while (true) {
+      size_t length = 0;
+      const auto [op, precedence] = PeekBinary(length);
+
+      if (precedence == 0 || precedence < min_precedence)
+        return true;
+
+      m_pos += length;
+
+      if (!Binary(precedence + 1))
+        return false;
+
+      Emit(op);
+    }
+  }
+
+  bool Unary()
+  {
+    Op op;
+
+    if (Accept('!'))
+      op = Op::Not;
+    else if (Accept('~'))
+      op = Op::Complement;
+    else if (Accept('-'))
+      op = Op::Negate;
+    else
+      return Primary();
+
+    if (!Unary())
+      return false;
+
+    Emit(op);
+    return true;
+  }
+
+  bool Primary()
+  {
+    if (Accept('('))
+      return Binary(0) && Expect(')');
+
+    SkipSpace();
+
+    if (m_pos >= m_text.size()) {
+      m_error = "Unexpected end";
+      return false;
+    }
+
+    if (std::isdigit(m_text[m_pos]))
+      return Number();
+
+    if (std::isalpha(m_text[m_pos]))
+      return Name();
+
+    m_error = "Unexpected '" + std::string(1, m_text[m_pos]) + "'";
+    return false;
+  }
+
+  bool Number()
+  {
+    int base = 10;
+
+    if (m_text.compare(m_pos, 2, "0x") == 0 ||
+        m_text.compare(m_pos, 2, "0X") == 0) {
+      base = 16;
+      m_pos += 2;
+    }
+
+    u64 value = 0;
+    size_t digits = 0;
+
+    for (; m_pos < m_text.size() && std::isxdigit(m_text[m_pos]); m_pos++) {
+      const char c = static_cast<char>(std::tolower(m_text[m_pos]));
+      const u32 digit = std::isdigit(c) ? c - '0' : c - 'a' + 10;
+
+      if (digit >= static_cast<u32>(base))
+        break;
+
+      value = value * base + digit;
+      digits++;
+
+      if (value > 0xFFFFFFFF) {
+        m_error = "Number too large";
+        return false;
+      }
+    }
+
+    if (digits == 0) {
+      m_error = "Expected digits";
+      return false;
+    }
+
+    Emit(Op::Constant, static_cast<u32>(value));
+    return true;
+  }
+
+  bool Name()
+  {
+    const size_t start = m_pos;
+    std::string name;
+
+    while (m_pos < m_text.size() && std::isalpha(m_text[m_pos]))
+      name += static_cast<char>(std::tolower(m_text[m_pos++]));
+
+    if (name == "byte" || name == "word")
+      return Read(name == "word");
+
+    // The registers are references, so this can't be done statically
+    const std::array<std::pair<const char*, const u16*>, 13> words = {{
+        {"ax", &AX},
+        {"bx", &BX},
+        {"cx", &CX},
+        {"dx", &DX},
+        {"si", &SI},
+        {"di", &DI},
+        {"bp", &BP},
+        {"sp", &SP},
+        {"ip", &IP},
+        {"cs", &CS},
+        {"ds", &DS},
+        {"es", &ES},
+        {"ss", &SS},
+    }};
+
+    const std::array<std::pair<const char*, const u8*>, 8> bytes = {{
+        {"al", &AL},
+        {"ah", &AH},
+        {"bl", &BL},
+        {"bh", &BH},
+        {"cl", &CL},
+        {"ch", &CH},
+        {"dl", &DL},
+        {"dh", &DH},
+    }};
+
+    static const std::array<std::pair<const char*, Flag>, 8> FLAGS = {{
+        {"cf", Flag::CF},
+        {"pf", Flag::PF},
+        {"af", Flag::AF},
+        {"zf", Flag::ZF},
+        {"sf", Flag::SF},
+        {"if", Flag::IF},
+        {"df", Flag::DF},
+        {"of", Flag::OF},
+    }};
+
+    for (const auto& [text, pointer] : words) {
+      if (name == text) {
+        Emit(Op::Word, 0, pointer);
+        return true;
+      }
+    }
+
+    for (const auto& [text, pointer] : bytes) {
+      if (name == text) {
+        Emit(Op::Byte, 0, pointer);
+        return true;
+      }
+    }
+
+    for (const auto& [text, flag] : FLAGS) {
+      if (name == text) {
+        Emit(Op::Flag, static_cast<u32>(flag));
+        return true;
+      }
+    }
+
+    m_pos = start;
+    m_error = "Unknown name '" + name + "'";
+    return false;
+  }
+
+  bool Read(bool word)
+  {
+    if (!Expect('[') || !Binary(0))
+      return false;
+
+    bool far = false;
+
+    if (Accept(':')) {
+      if (!Binary(0))
+        return false;
+
+      far = true;
+    }
+
+    if (!Expect(']'))
+      return false;
+
+    if (far)
+      Emit(word ? Op::ReadFarWord : Op::ReadFarByte);
+    else
+      Emit(word ? Op::ReadWord : Op::ReadByte);
+
+    return true;
+  }
+};
+
+std::optional<Expression> Expression::Compile(const std::string& text,
+                                              std::string* error)
+{
+  Expression expression;
+  std::string message;
+
+  if (!ExpressionCompiler(text).Compile(expression.m_code, message)) {
+    if (error != nullptr)
+      *error = message;
+
+    return std::nullopt;
+  }
+
+  expression.m_text = text;
+
+  return expression;
+}
+
+u32 Expression::Evaluate() const
+{
+  std::array<u32, MAX_DEPTH> stack;
+  size_t top = 0;
+
+  for (const Step& step : m_code) {
+    switch (step.op) {
+    case Op::Constant:
+      stack[top++] = step.value;
+      continue;
+    case Op::Word:
+      stack[top++] = *static_cast<const u16*>(step.pointer);
+      continue;
+    case Op::Byte:
+      stack[top++] = *static_cast<const u8*>(step.pointer);
+      continue;
+    case Op::Flag:
+      stack[top++] = ReadFlag(static_cast<Flag>(step.value));
+      continue;
+    case Op::ReadByte:
+      stack[top - 1] = ReadMemory<u8>(stack[top - 1]);
+      continue;
+    case Op::ReadWord:
+      stack[top - 1] = ReadMemory<u16>(stack[top - 1]);
+      continue;
+    case Op::Not:
+      stack[top - 1] = !stack[top - 1];
+      continue;
+    case Op::Complement:
+      stack[top - 1] = ~stack[top - 1];
+      continue;
+    case Op::Negate:
+      stack[top - 1] = 0 - stack[top - 1];
+      continue;
+    default:
+      break;
+    }
+
+    // Everything else takes two values
+    const u32 b = stack[--top];
+    u32& a = stack[top - 1];
+
+    switch (step.op) {
+    case Op::ReadFarByte:
+      a = ReadMemory<u8>(
+          Memory::VirtToPhys(static_cast<u16>(a), static_cast<u16>(b)));
+      break;
+    case Op::ReadFarWord:
+      a = ReadMemory<u16>(
+          Memory::VirtToPhys(static_cast<u16>(a), static_cast<u16>(b)));
+      break;
+    case Op::Multiply:
+      a *= b;
+      break;
+    case Op::Divide:
+      a = b == 0 ? 0 : a / b;
+      break;
+    case Op::Modulo:
+      a = b == 0 ? 0 : a % b;
+      break;
+    case Op::Add:
+      a += b;
+      break;
+    case Op::Subtract:
+      a -= b;
+      break;
+    case Op::ShiftLeft:
+      a = b >= 32 ? 0 : a << b;
+      break;
+    case Op::ShiftRight:
+      a = b >= 32 ? 0 : a >> b;
+      break;
+    case Op::Less:
+      a = a < b;
+      break;
+    case Op::LessEqual:
+      a = a <= b;
+      break;
+    case Op::Greater:
+      a = a > b;
+      break;
+    case Op::GreaterEqual:
+      a = a >= b;
+      break;
+    case Op::Equal:
+      a = a == b;
+      break;
+    case Op::NotEqual:
+      a = a != b;
+      break;
+    case Op::And:
+      a &= b;
+      break;
+    case Op::Xor:
+      a ^= b;
+      break;
+    case Op::Or:
+      a |= b;
+      break;
+    case Op::LogicalAnd:
+      a = a && b;
+      break;
+    default:
+      a = a || b;
+      break;
+    }
+  }
+
+  return stack[0];
+}
+} // namespace Core::CPU
@@ -0,0 +1,60 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Common/Types.h"
+
+namespace Core::CPU
+{
+/**
+ * @brief Expression over the CPU state, compiled once to a small stack
+ * machine program so evaluating it doesn't have to look at the text again.
+ *
+ * The syntax is C's, on 32 bit unsigned values:
+ * - numbers, decimal or with a 0x prefix
+ * - registers (AX, AL, SI, CS, IP, ...) and flags (CF, ZF, IF, ...)
+ * - byte[segment:offset] and word[segment:offset], or with a physical
+ *   address in the brackets. Reading memory never triggers watchpoints
+ * - unary ! ~ -, binary * / % + - << >> < <= > >= == != & ^ | && || and
+ *   parentheses. Division by zero results in 0
+ *
+ * Names are case insensitive, e.g. "ax == 0x4c00 && byte[ds:si] != 0".
+ */
+class Expression
+{
+public:
+  //! Compile text, or return nothing and describe the problem in error
+  static std::optional<Expression> Compile(const std::string& text,
+                                           std::string* error = nullptr);
+
+  u32 Evaluate() const;
+
+  const std::string& GetText() const { return m_text; }
+
+private:
+  enum class Op : u8;
+
+  struct Step {
+    Op op;
+    //! Constant or flag, depending on op
+    u32 value;
+    //! Register, depending on op
+    const void* pointer;
+  };
+
+  //! Most values on the stack at once
+  static constexpr size_t MAX_DEPTH = 32;
+
+  std::string m_text;
+  std::vector<Step> m_code;
+
+  friend class ExpressionCompiler;
+};
+} // namespace Core::CPU
@@ -0,0 +1,43 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/Fault.h"
+
+#include <utility>
+
+#include "Core/CPU/CPU.h"
+
+namespace Core::CPU
+{
+Fault current_fault;
+
+void RaiseFault(FaultKind kind, std::exception_ptr exception)
+{
+  if (HasFault())
+    return;
+
+  current_fault.kind = kind;
+  current_fault.segment = LAST_CS;
+  current_fault.offset = LAST_IP;
+  current_fault.exception = std::move(exception);
+
+  RequestWork(PENDING_FAULT);
+}
+
+const Fault& GetFault() { return current_fault; }
+
+void ClearFault()
+{
+  current_fault = {};
+  ClearWork(PENDING_FAULT);
+}
+
+void ThrowFault()
+{
+  const std::exception_ptr exception = current_fault.exception;
+
+  ClearFault();
+  std::rethrow_exception(exception);
+}
+} // namespace Core::CPU
@@ -0,0 +1,66 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include <exception>
+
+#include "Common/Types.h"
+
+namespace Core::CPU
+{
+//! Why the CPU can't continue
+enum class FaultKind : u8 {
+  None,
+  //! The instruction at CS:IP couldn't be decoded or validated
+  Decode,
+  //! The interpreter doesn't implement the instruction
+  UnhandledInstruction,
+  //! Neither software nor hardware handles the interrupt
+  UnhandledInterrupt,
+  //! Translated code and the interpreter disagree (lockstep mode only)
+  JITMismatch,
+};
+
+/**
+ * @brief Faults are recorded instead of thrown while executing, so the run
+ * loop never has to unwind. Only ThrowFault() turns them into a CPUException,
+ * which is what the API boundary (Tick(), Start()) does
+ */
+struct Fault {
+  FaultKind kind = FaultKind::None;
+  //! Instruction that faulted (LAST_CS:LAST_IP at the time)
+  u16 segment = 0;
+  u16 offset = 0;
+  //! What ThrowFault() throws
+  std::exception_ptr exception;
+};
+
+//! \cond PRIVATE
+extern Fault current_fault;
+//! \endcond PRIVATE
+
+/**
+ * @brief Record a fault, which stops Run() at the end of the current
+ * instruction. Only the first fault is kept until the fault gets cleared
+ */
+void RaiseFault(FaultKind kind, std::exception_ptr exception);
+
+//! Record a fault, see above
+template <typename E> void RaiseFault(FaultKind kind, const E& exception)
+{
+  RaiseFault(kind, std::make_exception_ptr(exception));
+}
+
+inline bool HasFault() { return current_fault.kind != FaultKind::None; }
+
+const Fault& GetFault();
+
+//! Forget the recorded fault, e.g. to continue after reporting it
+void ClearFault();
+
+//! Clear the recorded fault and throw its exception
+[[noreturn]] void ThrowFault();
+} // namespace Core::CPU
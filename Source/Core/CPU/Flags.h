@@ -4,15 +4,7 @@
 
 using namespace Core;
 
-template <typename T> void CPU::UpdateOF(i32 value)
+template <typename T> void CPU::UpdateSZP(T value)
 {
-  OF = value < std::numeric_limits<T>().min() ||
-       value > std::numeric_limits<T>().max();
-}
-
-// TODO: Check if this actually works properly.
-template <typename T> void CPU::UpdateCF(i32 value)
-{
-  // Check if there has been a carry or borrow from the last byte
-  CF = value & (1 << (sizeof(T) * 8));
+  SetFlags(FLAG_SF | FLAG_ZF | FLAG_PF, SZPFlags(value));
 }
@@ -555,42 +555,9 @@ std::string Instruction::Parameter::ToString(SegmentPrefix prefix,
   }
 }
 
-bool Core::CPU::ParameterNeedsResolving(
-    const Instruction::Parameter::Type& type)
-{
-  using Type = Instruction::Parameter::Type;
-  constexpr std::array resolved_params{
-      Type::AL,          Type::AH,
-      Type::BL,          Type::BH,
-      Type::CL,          Type::CH,
-      Type::DL,          Type::DH,
-      Type::AX,          Type::BX,
-      Type::CX,          Type::DX,
-      Type::CS,          Type::DS,
-      Type::ES,          Type::SS,
-      Type::IP,          Type::BP,
-      Type::SP,          Type::DI,
-      Type::SI,          Type::Implied_0,
-      Type::Implied_1,   Type::Implied_3,
-      Type::Value_BP_SI, Type::Value_BP_SI_Word,
-      Type::Value_BP_DI, Type::Value_BP_DI_Word,
-      Type::Value_BX_SI, Type::Value_BX_SI_Word,
-      Type::Value_BX_DI, Type::Value_BX_DI_Word,
-      Type::Value_BX,    Type::Value_BX_Word,
-      Type::Value_DI,    Type::Value_DI_Word,
-      Type::Value_SI,    Type::Value_SI_Word,
-      Type::None,
-  };
-
-  return std::find(resolved_params.begin(), resolved_params.end(), type) ==
-         resolved_params.end();
-}
-
 bool Instruction::IsResolved()
 {
-  auto type = GetType();
-  if (type == Type::GRP1 || type == Type::GRP2 || type == Type::GRP3a ||
-      type == Type::GRP3b || type == Type::GRP4 || type == Type::GRP5)
+  if (IsGroup())
     return false;
 
   for (const auto& param : m_parameters) {
@@ -604,7 +571,32 @@ bool Instruction::IsResolved()
 bool Instruction::IsPrefix() const
 {
   return m_type == Type::PREFIX_CS || m_type == Type::PREFIX_DS ||
-         m_type == Type::PREFIX_ES || m_type == Type::PREFIX_SS;
+         m_type == Type::PREFIX_ES || m_type == Type::PREFIX_SS ||
+         m_type == Type::REPZ || m_type == Type::REPNZ;
+}
+
+//! Read a little-endian word from a possibly unaligned location
+static u16 ReadWord(const u8* data)
+{
+  return static_cast<u16>(data[0] | data[1] << 8);
+}
+
+//! Amount of displacement bytes following a ModRM byte
+static u8 GetDisplacementLength(u8 modrm)
+{
+  const u8 mod_bits = (modrm & 0xC0) >> 6;
+
+  if (mod_bits == 0b00 && (modrm & 0b111) == 0b110)
+    return sizeof(u16);
+
+  switch (mod_bits) {
+  case 0b01:
+    return sizeof(u8);
+  case 0b10:
+    return sizeof(u16);
+  default:
+    return 0;
+  }
 }
 
 static bool ResolveRM8(Instruction::Parameter& param, u8 rm_bits, u8 modrm)
@@ -681,7 +673,12 @@ static bool ResolveRM16(Instruction::Parameter& param, u8 rm_bits, u8 modrm)
   return true;
 }
 
-bool Instruction::Resolve(u8 modrm, std::vector<u8> data)
+bool Instruction::Resolve(u8 modrm, const std::vector<u8>& data)
+{
+  return Resolve(modrm, data.data());
+}
+
+bool Instruction::Resolve(u8 modrm, const u8* data)
 {
   using PType = Parameter::Type;
 
@@ -695,146 +692,33 @@ bool Instruction::Resolve(u8 modrm, std::vector<u8> data)
   u8 rm_bits = modrm & 0x07;
   u8 mod_cmb = mod_bits | rm_bits;
 
-  if (m_type == Type::GRP1) {
-    switch (reg_bits) {
-    case 0x00:
-      m_type = Type::ADD;
-      break;
-    case 0x01:
-      m_type = Type::OR;
-      break;
-    case 0x02:
-      m_type = Type::ADC;
-      break;
-    case 0x03:
-      m_type = Type::SBB;
-      break;
-    case 0x04:
-      m_type = Type::AND;
-      break;
-    case 0x05:
-      m_type = Type::SUB;
-      break;
-    case 0x06:
-      m_type = Type::XOR;
-      break;
-    case 0x07:
-      m_type = Type::CMP;
-      break;
-    default:
-      std::cerr << "(GRP1) Don't know what to do with "
-                << String::ToHex(reg_bits) << std::endl;
-      return false;
-    }
-  }
+  m_size += 1 + GetLength(modrm);
 
-  if (m_type == Type::GRP2) {
-
-    switch (reg_bits) {
-    case 0x00:
-      m_type = Type::ROL;
-      break;
-    case 0x01:
-      m_type = Type::ROR;
-      break;
-    case 0x02:
-      m_type = Type::RCL;
-      break;
-    case 0x03:
-      m_type = Type::RCR;
-      break;
-    case 0x04:
-      m_type = Type::SHL;
-      break;
-    case 0x05:
-      m_type = Type::SHR;
-      break;
-    case 0x07: // TODO: Should be SAR
-      m_type = Type::SHR;
-      break;
-    default:
-      std::cerr << "(GRP2) Don't know what to do with "
-                << String::ToHex(reg_bits) << std::endl;
-      return false;
-    }
-  }
+  if (IsGroup()) {
+    const Type group = m_type;
+    m_type = GroupToType(group, reg_bits);
 
-  if (m_type == Type::GRP3a || m_type == Type::GRP3b) {
-    switch (reg_bits) {
-    case 0x00:
-      m_type = Type::TEST;
-      m_parameters.push_back(Parameter(PType::Literal_Word_Immediate));
-      break;
-    case 0x02:
-      m_type = Type::NOT;
-      break;
-    case 0x03:
-      m_type = Type::NEG;
-      break;
-    case 0x04:
-      m_type = Type::MUL;
-      break;
-    case 0x05:
-      m_type = Type::IMUL;
-      break;
-    case 0x06:
-      m_type = Type::DIV;
-      break;
-    case 0x07:
-      m_type = Type::IDIV;
-      break;
-    default:
-      std::cerr << "(GRP3a/b) Don't know what to do with "
+    if (m_type == Type::Invalid) {
+      std::cerr << "(" << TypeToString(group) << ") Don't know what to do with "
                 << String::ToHex(reg_bits) << std::endl;
       return false;
     }
-  }
 
-  if (GetType() == Type::GRP4) {
-    switch (reg_bits) {
-    case 0x00:
-      m_type = Type::INC;
-      break;
-    case 0x01:
-      m_type = Type::DEC;
-      break;
-    default:
-      std::cerr << "(GRP4) Don't know what to do with "
-                << String::ToHex(reg_bits) << std::endl;
-      return false;
+    if (m_type == Type::TEST) {
+      AddParameter(Parameter(group == Type::GRP3a ? PType::Literal_Byte
+                                                  : PType::Literal_Word));
     }
   }
 
-  if (GetType() == Type::GRP5) {
-    switch (reg_bits) {
-    case 0x00:
-      m_type = Type::INC;
-      break;
-    case 0x01:
-      m_type = Type::DEC;
-      break;
-    case 0x02:
-    case 0x03:
-      m_type = Type::CALL;
-      break;
-    case 0x04:
-    case 0x05:
-      m_type = Type::JMP;
-      break;
-    case 0x06:
-      m_type = Type::PUSH;
-      break;
-    default:
-      std::cerr << "(GRP5) Don't know what to do with "
-                << String::ToHex(reg_bits) << std::endl;
-      return false;
-    }
-  }
+  // Immediates are stored after the displacement
+  const u8* immediate = data + GetDisplacementLength(modrm);
 
   if (GetType() == Type::Invalid)
     return false;
 
-  for (auto& param : m_parameters) {
+  for (u8 i = 0; i < m_parameter_count; i++) {
+    auto& param = m_parameters[i];
+
     if (!param.IsResolved()) {
       switch (param.GetType()) {
       case PType::Modifier_Register_Byte:
@@ -892,76 +776,59 @@ bool Instruction::Resolve(u8 modrm, std::vector<u8> data)
           param.Resolve(PType::Value_DI);
           break;
         case 0b00'110: // [Addr16]
-          param.Resolve(PType::Value_WordAddress,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_WordAddress, ReadWord(data));
           break;
         case 0b00'111: // [BX]
           param.Resolve(PType::Value_BX);
           break;
         case 0b01'000: // [BX+SI+offset]
-          param.Resolve(PType::Value_BX_SI_Offset,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BX_SI_Offset, data[0]);
           break;
         case 0b01'001: // [BX + DI + offset]
-          param.Resolve(PType::Value_BX_DI_Offset,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BX_DI_Offset, data[0]);
           break;
         case 0b01'010: // [BP+SI+offset]
-          param.Resolve(PType::Value_BP_SI_Offset,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BP_SI_Offset, data[0]);
           break;
         case 0b01'011: // [BP+DI+offset]
-          param.Resolve(PType::Value_BP_DI_Offset,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BP_DI_Offset, data[0]);
           break;
         case 0b01'100: // [SI+offset]
-          param.Resolve(PType::Value_SI_Offset,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_SI_Offset, data[0]);
           break;
         case 0b01'101: // [DI+offset]
-          param.Resolve(PType::Value_DI_Offset,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_DI_Offset, data[0]);
           break;
         case 0b01'110: // [BP+offset]
-          param.Resolve(PType::Value_BP_Offset,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BP_Offset, data[0]);
           break;
         case 0b01'111: // [BX+offset]
-          param.Resolve(PType::Value_BX_Offset,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BX_Offset, data[0]);
           break;
 
         case 0b10'000: // [BX+SI+wOffset]
-          param.Resolve(PType::Value_BX_SI_WordOffset,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BX_SI_WordOffset, ReadWord(data));
           break;
         case 0b10'001: // [BX+DI+wOffset]
-          param.Resolve(PType::Value_BX_DI_WordOffset,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BX_DI_WordOffset, ReadWord(data));
           break;
         case 0b10'010: // [BP+SI+wOffset]
-          param.Resolve(PType::Value_BP_SI_WordOffset,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BP_SI_WordOffset, ReadWord(data));
           break;
         case 0b10'011: // [BP+DI+wOffset]
-          param.Resolve(PType::Value_BP_DI_WordOffset,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BP_DI_WordOffset, ReadWord(data));
           break;
         case 0b10'100: // [SI+wOffset]
-          param.Resolve(PType::Value_SI_WordOffset,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_SI_WordOffset, ReadWord(data));
           break;
         case 0b10'101: // [DI+wOffset]
-          param.Resolve(PType::Value_DI_WordOffset,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_DI_WordOffset, ReadWord(data));
           break;
         case 0b10'110: // [BP+wOffset]
-          param.Resolve(PType::Value_BP_WordOffset,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BP_WordOffset, ReadWord(data));
           break;
         case 0b10'111: // [BX+wOffset]
-          param.Resolve(PType::Value_BX_WordOffset,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BX_WordOffset, ReadWord(data));
           break;
         default:
           std::cerr << "Don't know how to resolve the AB modifier "
@@ -996,76 +863,59 @@ bool Instruction::Resolve(u8 modrm, std::vector<u8> data)
           param.Resolve(PType::Value_DI_Word);
           break;
         case 0b00'110: // [Addr16]
-          param.Resolve(PType::Value_WordAddress_Word,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_WordAddress_Word, ReadWord(data));
           break;
         case 0b00'111: // [BX]
           param.Resolve(PType::Value_BX_Word);
           break;
         case 0b01'000: // [BX+SI+offset]
-          param.Resolve(PType::Value_BX_SI_Offset_Word,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BX_SI_Offset_Word, data[0]);
           break;
         case 0b01'001: // [BX + DI + offset]
-          param.Resolve(PType::Value_BX_DI_Offset_Word,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BX_DI_Offset_Word, data[0]);
           break;
         case 0b01'010: // [BP+SI+offset]
-          param.Resolve(PType::Value_BP_SI_Offset_Word,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BP_SI_Offset_Word, data[0]);
           break;
         case 0b01'011: // [BP+DI+offset]
-          param.Resolve(PType::Value_BP_DI_Offset_Word,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BP_DI_Offset_Word, data[0]);
           break;
         case 0b01'100: // [SI+offset]
-          param.Resolve(PType::Value_SI_Offset_Word,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_SI_Offset_Word, data[0]);
           break;
         case 0b01'101: // [DI+offset]
-          param.Resolve(PType::Value_DI_Offset_Word,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_DI_Offset_Word, data[0]);
           break;
         case 0b01'110: // [BP+offset]
-          param.Resolve(PType::Value_BP_Offset_Word,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BP_Offset_Word, data[0]);
           break;
         case 0b01'111: // [BX+offset]
-          param.Resolve(PType::Value_BX_Offset_Word,
-                        *reinterpret_cast<u8*>(data.data()));
+          param.Resolve(PType::Value_BX_Offset_Word, data[0]);
           break;
 
         case 0b10'000: // [BX+SI+wOffset]
-          param.Resolve(PType::Value_BX_SI_WordOffset_Word,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BX_SI_WordOffset_Word, ReadWord(data));
           break;
         case 0b10'001: // [BX+DI+wOffset]
-          param.Resolve(PType::Value_BX_DI_WordOffset_Word,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BX_DI_WordOffset_Word, ReadWord(data));
           break;
         case 0b10'010: // [BP+SI+wOffset]
-          param.Resolve(PType::Value_BP_SI_WordOffset_Word,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BP_SI_WordOffset_Word, ReadWord(data));
           break;
         case 0b10'011: // [BP+DI+wOffset]
-          param.Resolve(PType::Value_BP_DI_WordOffset_Word,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BP_DI_WordOffset_Word, ReadWord(data));
           break;
         case 0b10'100: // [SI+wOffset]
-          param.Resolve(PType::Value_SI_WordOffset_Word,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_SI_WordOffset_Word, ReadWord(data));
           break;
         case 0b10'101: // [DI+wOffset]
-          param.Resolve(PType::Value_DI_WordOffset_Word,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_DI_WordOffset_Word, ReadWord(data));
           break;
         case 0b10'110: // [BP+wOffset]
-          param.Resolve(PType::Value_BP_WordOffset_Word,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BP_WordOffset_Word, ReadWord(data));
           break;
         case 0b10'111: // [BX+wOffset]
-          param.Resolve(PType::Value_BX_WordOffset_Word,
-                        *reinterpret_cast<u16*>(data.data()));
+          param.Resolve(PType::Value_BX_WordOffset_Word, ReadWord(data));
           break;
 
         default:
@@ -1076,29 +926,29 @@ bool Instruction::Resolve(u8 modrm, std::vector<u8> data)
         }
         break;
       case PType::Value_BP_WordOffset:
-        param.Resolve(*reinterpret_cast<u8*>(data.data()) | (modrm << 8));
+        param.Resolve(data[0] | (modrm << 8));
         break;
       case PType::Literal_Offset:
         param.Resolve(modrm);
         break;
       case PType::Literal_Word_Immediate:
-        param.Resolve(*reinterpret_cast<u8*>(data.data()) << 8 | modrm);
+        param.Resolve(data[0] << 8 | modrm);
         break;
       case PType::Literal_Byte_Immediate:
         param.Resolve(modrm);
         break;
       case PType::Literal_Word:
-        param.Resolve(*reinterpret_cast<u16*>(data.data()));
+        param.Resolve(ReadWord(immediate));
         break;
       case PType::Literal_WordOffset:
-        param.Resolve(*reinterpret_cast<u8*>(data.data()) << 8 | modrm);
+        param.Resolve(data[0] << 8 | modrm);
         break;
       case PType::Literal_Byte:
-        param.Resolve(*reinterpret_cast<u16*>(data.data()));
+        param.Resolve(immediate[0]);
         break;
       case PType::Value_WordAddress:
       case PType::Value_WordAddress_Word:
-        param.Resolve(*reinterpret_cast<u8*>(data.data()) << 8 | modrm);
+        param.Resolve(data[0] << 8 | modrm);
         break;
       case PType::Literal_LongAddress_Immediate:
         param.Resolve(modrm << 24 | data[0] << 16 | data[1] << 8 | data[2]);
@@ -1112,12 +962,9 @@ bool Instruction::Resolve(u8 modrm, std::vector<u8> data)
     }
   }
 
-  return true;
-}
+  UpdateSegment();
 
-Instruction::Parameter::Parameter(Parameter::Type type) : m_type(type)
-{
-  this->m_resolved = !ParameterNeedsResolving(type);
+  return true;
 }
 
 void Instruction::Parameter::Resolve(u32 data)
@@ -1135,6 +982,7 @@ void Instruction::Parameter::Resolve(Parameter::Type type, u32 data)
     return;
 
   this->m_type = type;
+  this->m_addressing = ParameterAddressing(type);
   this->m_data = data;
   this->m_resolved = true;
 }
@@ -1145,6 +993,14 @@ Instruction::Parameter::Type Instruction::Parameter::GetType() const
 }
 bool Instruction::Parameter::IsResolved() const { return m_resolved; }
 
+bool Instruction::Parameter::IsMemory() const
+{
+  return m_type >= Type::Value_BP_Offset &&
+         m_type <= Type::Value_WordAddress_Word;
+}
+
+u8 Instruction::Parameter::GetAddressing() const { return m_addressing; }
+
 bool Instruction::Parameter::IsWord() const
 {
   auto t = m_type;
@@ -1191,11 +1047,14 @@ u8 Instruction::GetLength(u8 mod)
 {
   u8 length = 0;
 
-  u8 mod_bits = (mod & 0xC0) >> 3;
-  u8 rm_bits = mod & 7;
-  u8 mod_cmb = mod_bits | rm_bits;
+  // TEST is the only group member with an additional immediate
+  if ((m_type == Type::GRP3a || m_type == Type::GRP3b) &&
+      GroupToType(m_type, (mod & 0x38) >> 3) == Type::TEST)
+    length += m_type == Type::GRP3a ? sizeof(u8) : sizeof(u16);
+
+  for (u8 i = 0; i < m_parameter_count; i++) {
+    const auto& p = m_parameters[i];
 
-  for (const auto& p : m_parameters) {
     if (ParameterNeedsResolving(p.GetType())) {
       using PType = Parameter::Type;
       switch (p.GetType()) {
@@ -1220,23 +1079,7 @@ u8 Instruction::GetLength(u8 mod)
         break;
       case PType::Modifier_Any_Byte:
       case PType::Modifier_Any_Word:
-
-        if (mod_cmb == 0b00'110) {
-          length += sizeof(u16);
-          break;
-        }
-
-        switch (mod_bits) {
-        case 0b00'000:
-        case 0b11'000:
-          break;
-        case 0b01'000:
-          length += sizeof(u8);
-          break;
-        case 0b10'000:
-          length += sizeof(u16);
-          break;
-        }
+        length += GetDisplacementLength(mod);
         break;
       default:
         std::cerr << "(IL) Don't know how to resolve "
@@ -1252,12 +1095,14 @@ u8 Instruction::GetLength(u8 mod)
 
 Instruction::Instruction(Type type) : m_type(type), m_offset(0) {}
 Instruction::Instruction(const Instruction& ins, u8 opcode, u32 offset)
-    : m_offset(offset)
+    : Instruction(opcode, offset)
 {
   if (!ins.IsPrefix())
     throw "Error";
 
-  *this = Instruction(opcode);
+  m_prefix = ins.m_prefix;
+  m_repeat_mode = ins.m_repeat_mode;
+  m_size = ins.m_size + 1;
 
   switch (ins.GetType()) {
   case Type::PREFIX_CS:
@@ -1272,8 +1117,46 @@ Instruction::Instruction(const Instruction& ins, u8 opcode, u32 offset)
   case Type::PREFIX_SS:
     m_prefix = SegmentPrefix::SS;
     break;
+  case Type::REPNZ:
+    m_repeat_mode = RepeatMode::Repeat_Non_Zero;
+    break;
+  case Type::REPZ:
+    m_repeat_mode = RepeatMode::Repeat_Zero;
+    break;
   default:
-    m_prefix = SegmentPrefix::None;
+    break;
+  }
+
+  // F3 only checks ZF for CMPS and SCAS, everything else just repeats
+  if (m_repeat_mode == RepeatMode::Repeat_Zero && m_type != Type::CMPSB &&
+      m_type != Type::CMPSW && m_type != Type::SCASB && m_type != Type::SCASW)
+    m_repeat_mode = RepeatMode::Repeat;
+
+  UpdateSegment();
+}
+
+void Instruction::UpdateSegment()
+{
+  if (m_prefix != SegmentPrefix::None) {
+    m_segment = m_prefix;
+    return;
+  }
+
+  m_segment = SegmentPrefix::DS;
+
+  for (u8 i = 0; i < m_parameter_count; i++) {
+    const auto& p = m_parameters[i];
+
+    if (!p.IsMemory())
+      continue;
+
+    // [BP+SI], [BP+DI] and [BP+disp], but not [disp16] which takes the place
+    // of [BP] with mod 0
+    const u8 mod = p.GetAddressing() >> 3;
+    const u8 rm = p.GetAddressing() & 0b111;
+
+    if (rm == 0b010 || rm == 0b011 || (rm == 0b110 && mod != 0))
+      m_segment = SegmentPrefix::SS;
   }
 }
 
@@ -1281,17 +1164,51 @@ Instruction::Type Instruction::GetType() const { return m_type; }
 
 Instruction::SegmentPrefix Instruction::GetPrefix() const { return m_prefix; }
 
+Instruction::SegmentPrefix Instruction::GetSegment() const
+{
+  return m_segment;
+}
+
+Core::CPU::RepeatMode Instruction::GetRepeatMode() const
+{
+  return m_repeat_mode;
+}
+
+u8 Instruction::GetSize() const { return m_size; }
+
+Instruction::Handler Instruction::GetHandler() const { return m_handler; }
+
+void Instruction::SetHandler(Handler handler) { m_handler = handler; }
+
+u16 Instruction::GetCycles() const { return m_cycles; }
+
+void Instruction::SetCycles(u16 cycles) { m_cycles = cycles; }
+
 std::string Instruction::ToString() const
 {
-  std::string disasm = TypeToString(m_type) + " ";
+  std::string disasm;
+
+  switch (m_repeat_mode) {
+  case RepeatMode::Repeat:
+    disasm = "REP ";
+    break;
+  case RepeatMode::Repeat_Zero:
+    disasm = "REPZ ";
+    break;
+  case RepeatMode::Repeat_Non_Zero:
+    disasm = "REPNZ ";
+    break;
+  default:
+    break;
+  }
+
+  disasm += TypeToString(m_type) + " ";
 
   bool no_parameters = true;
 
-  for (const auto& p : m_parameters) {
-    if (p.GetType() == Parameter::Type::None)
-      break;
-    else
-      no_parameters = false;
+  for (u8 i = 0; i < m_parameter_count; i++) {
+    const auto& p = m_parameters[i];
+    no_parameters = false;
 
     disasm += p.ToString(m_prefix, m_offset);
     disasm += ", ";
@@ -1308,14 +1225,19 @@ void Instruction::AddParameter(Parameter parameter)
   if (parameter.GetType() == Parameter::Type::None)
     return;
 
-  m_parameters.push_back(parameter);
+  if (m_parameter_count == MAX_PARAMETERS)
+    throw std::length_error("Instruction parameter limit exceeded");
+
+  m_parameters[m_parameter_count++] = parameter;
 }
 
-const std::vector<Instruction::Parameter>& Instruction::GetParameters() const
+const Instruction::Parameters& Instruction::GetParameters() const
 {
   return m_parameters;
 }
 
+u8 Instruction::GetParameterCount() const { return m_parameter_count; }
+
 Instruction::Parameter& Instruction::GetParameter(size_t index)
 {
   return m_parameters[index];
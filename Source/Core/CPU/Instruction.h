@@ -5,8 +5,9 @@
 #pragma once
 //! \file
 
-#include <map>
+#include <array>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "Common/Types.h"
@@ -15,6 +16,9 @@ namespace Core
 {
 namespace CPU
 {
+//! Repeat prefix (``REP``/``REPZ``/``REPNZ``) attached to an instruction
+enum class RepeatMode : u8 { None, Repeat, Repeat_Zero, Repeat_Non_Zero };
+
 //! High-Level representation of a instruction
 class Instruction
 {
@@ -278,7 +282,7 @@ public:
     };
 
     //! Create a parameter with the Instruction::Parameter::Type provided
-    explicit Parameter(Parameter::Type type);
+    constexpr explicit Parameter(Parameter::Type type);
 
     //! Provide the parameter with its missing data
     void Resolve(u32 data);
@@ -300,6 +304,15 @@ public:
     //! Returns ``true`` if this parameter points to or is a word
     bool IsWord() const;
 
+    //! Returns ``true`` if this parameter is in memory
+    bool IsMemory() const;
+
+    /**
+     * @brief Get the addressing form of a memory parameter, (mod << 3) | rm
+     * of the ModRM byte it was (or would have been) decoded from
+     */
+    u8 GetAddressing() const;
+
     //! Get a human readable form of this parameter
     std::string ToString(SegmentPrefix prefix = SegmentPrefix::None,
                          u32 offset = 0) const;
@@ -307,9 +320,23 @@ public:
   private:
     Type m_type;
     bool m_resolved = false;
+    u8 m_addressing = 0;
     u32 m_data = 0;
   };
 
+  //! Maximum amount of parameters a single instruction can have
+  static constexpr size_t MAX_PARAMETERS = 2;
+
+  //! Maximum amount of bytes following the ModRM byte (displacement and
+  //! immediate)
+  static constexpr size_t MAX_DATA_LENGTH = 4;
+
+  //! Inline parameter storage. Unused slots hold Parameter::Type::None
+  using Parameters = std::array<Parameter, MAX_PARAMETERS>;
+
+  //! Function executing an instruction
+  using Handler = void (*)(const Instruction& instruction);
+
   Instruction() = default;
 
   /**
@@ -318,7 +345,11 @@ public:
    */
   explicit Instruction(u8 opcode, u32 offset = 0);
 
-  //! One but with prefixes
+  /**
+   * @brief Decode the opcode following one or more prefixes
+   * @param ins Prefix decoded so far. Its segment override and repeat mode
+   * carry over to the new instruction
+   */
   explicit Instruction(const Instruction& ins, u8 opcode, u32 offset = 0);
 
   //! Get the Type associated with this instruction
@@ -327,12 +358,41 @@ public:
   //! Get the SegmentPrefix associated with this instruction
   SegmentPrefix GetPrefix() const;
 
+  /**
+   * @brief Get the segment memory parameters are relative to. That's the
+   * segment prefix if there is one, SS if the address is based on BP, DS
+   * otherwise
+   */
+  SegmentPrefix GetSegment() const;
+
+  //! Get the repeat prefix associated with this instruction
+  RepeatMode GetRepeatMode() const;
+
+  //! Get the size of the encoded instruction in bytes (including prefixes)
+  u8 GetSize() const;
+
+  //! Get the handler selected for this instruction at decode time
+  Handler GetHandler() const;
+
+  //! Set the handler to be used by the threaded interpreter
+  void SetHandler(Handler handler);
+
+  //! Get the 8088 cycles selected for this instruction at decode time, see
+  //! InstructionCycles()
+  u16 GetCycles() const;
+
+  //! Set the cycles charged for executing this instruction
+  void SetCycles(u16 cycles);
+
   //! Checks whether this Instruction needs further resolving
   bool IsResolved();
 
   //! Checks if this instruction is actually a prefix
   bool IsPrefix() const;
 
+  //! Checks if the actual operation is selected by the ModRM reg field
+  bool IsGroup() const;
+
   /**
    * @brief Resolves the Instruction
    * @param mod Modifier byte. The byte after the opcode regardless if it is
@@ -341,7 +401,17 @@ public:
    * GetInstructionLength()
    * @return Returns ``false`` if there was an error during resolving.
    */
-  bool Resolve(u8 mod, std::vector<u8> data);
+  bool Resolve(u8 mod, const std::vector<u8>& data);
+
+  /**
+   * @brief Resolves the Instruction without copying its operand bytes
+   * @param mod Modifier byte. The byte after the opcode regardless if it is
+   * used as such
+   * @param data must point to at least as many bytes as specified in
+   * GetLength(). May point straight into guest memory.
+   * @return Returns ``false`` if there was an error during resolving.
+   */
+  bool Resolve(u8 mod, const u8* data);
 
   /**
    * @brief Get the length of the instruction provided
@@ -352,10 +422,13 @@ public:
   //! Get a disassembly for the Instruction provided
   std::string ToString() const;
 
-  //! Get a vector of parameters
-  const std::vector<Parameter>& GetParameters() const;
+  //! Get all parameters
+  const Parameters& GetParameters() const;
+
+  //! Get the amount of parameters in use
+  u8 GetParameterCount() const;
 
-  //! Get a specific vector
+  //! Get a specific parameter
   Parameter& GetParameter(size_t index);
 
   //! Add a new parameter
@@ -364,9 +437,23 @@ public:
 private:
   Instruction(Instruction::Type type);
 
-  std::vector<Parameter> m_parameters;
+  //! Look up the operation selected by reg within an opcode group
+  static Type GroupToType(Type group, u8 reg);
+
+  //! Pick the segment of the memory parameters once the prefix and
+  //! parameters are known
+  void UpdateSegment();
+
+  Parameters m_parameters{Parameter(Parameter::Type::None),
+                          Parameter(Parameter::Type::None)};
+  u8 m_parameter_count = 0;
   Type m_type = Type::Invalid;
   SegmentPrefix m_prefix = SegmentPrefix::None;
+  SegmentPrefix m_segment = SegmentPrefix::DS;
+  RepeatMode m_repeat_mode = RepeatMode::None;
+  u8 m_size = 1;
+  u16 m_cycles = 0;
+  Handler m_handler = nullptr;
   u32 m_offset = 0;
 };
 
@@ -379,6 +466,145 @@ std::string ParameterTypeToString(
     Instruction::SegmentPrefix prefix = Instruction::SegmentPrefix::None);
 
 //! Checks whether this Parameter::Type needs resolving
-bool ParameterNeedsResolving(const Instruction::Parameter::Type& parameter);
+constexpr bool
+ParameterNeedsResolving(const Instruction::Parameter::Type& parameter)
+{
+  using Type = Instruction::Parameter::Type;
+  switch (parameter) {
+  case Type::AL:
+  case Type::AH:
+  case Type::BL:
+  case Type::BH:
+  case Type::CL:
+  case Type::CH:
+  case Type::DL:
+  case Type::DH:
+  case Type::AX:
+  case Type::BX:
+  case Type::CX:
+  case Type::DX:
+  case Type::CS:
+  case Type::DS:
+  case Type::ES:
+  case Type::SS:
+  case Type::IP:
+  case Type::BP:
+  case Type::SP:
+  case Type::DI:
+  case Type::SI:
+  case Type::Implied_0:
+  case Type::Implied_1:
+  case Type::Implied_3:
+  case Type::Value_BP_SI:
+  case Type::Value_BP_SI_Word:
+  case Type::Value_BP_DI:
+  case Type::Value_BP_DI_Word:
+  case Type::Value_BX_SI:
+  case Type::Value_BX_SI_Word:
+  case Type::Value_BX_DI:
+  case Type::Value_BX_DI_Word:
+  case Type::Value_BX:
+  case Type::Value_BX_Word:
+  case Type::Value_DI:
+  case Type::Value_DI_Word:
+  case Type::Value_SI:
+  case Type::Value_SI_Word:
+  case Type::None:
+    return false;
+  default:
+    return true;
+  }
+}
+
+//! (mod << 3) | rm of the ModRM byte encoding a memory parameter type
+constexpr u8 ParameterAddressing(const Instruction::Parameter::Type& parameter)
+{
+  using Type = Instruction::Parameter::Type;
+  switch (parameter) {
+  case Type::Value_BX_SI:
+  case Type::Value_BX_SI_Word:
+    return 0b00'000;
+  case Type::Value_BX_DI:
+  case Type::Value_BX_DI_Word:
+    return 0b00'001;
+  case Type::Value_BP_SI:
+  case Type::Value_BP_SI_Word:
+    return 0b00'010;
+  case Type::Value_BP_DI:
+  case Type::Value_BP_DI_Word:
+    return 0b00'011;
+  case Type::Value_SI:
+  case Type::Value_SI_Word:
+    return 0b00'100;
+  case Type::Value_DI:
+  case Type::Value_DI_Word:
+    return 0b00'101;
+  case Type::Value_WordAddress:
+  case Type::Value_WordAddress_Word:
+    return 0b00'110;
+  case Type::Value_BX:
+  case Type::Value_BX_Word:
+    return 0b00'111;
+  case Type::Value_BX_SI_Offset:
+  case Type::Value_BX_SI_Offset_Word:
+    return 0b01'000;
+  case Type::Value_BX_DI_Offset:
+  case Type::Value_BX_DI_Offset_Word:
+    return 0b01'001;
+  case Type::Value_BP_SI_Offset:
+  case Type::Value_BP_SI_Offset_Word:
+    return 0b01'010;
+  case Type::Value_BP_DI_Offset:
+  case Type::Value_BP_DI_Offset_Word:
+    return 0b01'011;
+  case Type::Value_SI_Offset:
+  case Type::Value_SI_Offset_Word:
+    return 0b01'100;
+  case Type::Value_DI_Offset:
+  case Type::Value_DI_Offset_Word:
+    return 0b01'101;
+  case Type::Value_BP_Offset:
+  case Type::Value_BP_Offset_Word:
+    return 0b01'110;
+  case Type::Value_BX_Offset:
+  case Type::Value_BX_Offset_Word:
+    return 0b01'111;
+  case Type::Value_BX_SI_WordOffset:
+  case Type::Value_BX_SI_WordOffset_Word:
+    return 0b10'000;
+  case Type::Value_BX_DI_WordOffset:
+  case Type::Value_BX_DI_WordOffset_Word:
+    return 0b10'001;
+  case Type::Value_BP_SI_WordOffset:
+  case Type::Value_BP_SI_WordOffset_Word:
+    return 0b10'010;
+  case Type::Value_BP_DI_WordOffset:
+  case Type::Value_BP_DI_WordOffset_Word:
+    return 0b10'011;
+  case Type::Value_SI_WordOffset:
+  case Type::Value_SI_WordOffset_Word:
+    return 0b10'100;
+  case Type::Value_DI_WordOffset:
+  case Type::Value_DI_WordOffset_Word:
+    return 0b10'101;
+  case Type::Value_BP_WordOffset:
+  case Type::Value_BP_WordOffset_Word:
+    return 0b10'110;
+  case Type::Value_BX_WordOffset:
+  case Type::Value_BX_WordOffset_Word:
+    return 0b10'111;
+  default:
+    return 0;
+  }
+}
+
+constexpr Instruction::Parameter::Parameter(Parameter::Type type)
+    : m_type(type), m_resolved(!ParameterNeedsResolving(type)),
+      m_addressing(ParameterAddressing(type))
+{
+}
+
+static_assert(std::is_trivially_copyable_v<Instruction>,
+              "Decoded instructions must be cheap to copy around");
 } // namespace CPU
 } // namespace Core
@@ -0,0 +1,226 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/InstructionCache.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+#include "Common/Logger.h"
+#include "Common/String.h"
+#include "Core/CPU/CodeBytes.h"
+#include "Core/CPU/Cycles.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/Exception.h"
+#include "Core/CPU/Fault.h"
+#include "Core/CPU/Validation.h"
+#include "Core/Memory.h"
+
+namespace Core::CPU
+{
+bool use_instruction_cache = true;
+
+// Direct mapped by the low bits of the physical address. Entries are only
+// valid as long as the generation of their page did not change
+constexpr u32 CACHE_SIZE = 1 << 14;
+
+static CodeBytes s_code_bytes;
+
+struct CacheEntry {
+  u32 address = ~0u;
+  u32 generation = 0;
+  Instruction instruction;
+};
+
+static std::unique_ptr<std::array<CacheEntry, CACHE_SIZE>> s_cache =
+    std::make_unique<std::array<CacheEntry, CACHE_SIZE>>();
+static std::array<u32, Memory::PAGE_COUNT> s_generations{};
+
+static InstructionCacheStats s_stats;
+
+namespace
+{
+// Instruction bytes at segment:offset. As long as neither the segment nor
+// memory wraps around they're read straight from RAM, which is decided once
+// for the whole instruction instead of for every byte
+class CodeWindow
+{
+public:
+  CodeWindow(u16 segment, u16 offset) : m_segment(segment), m_offset(offset)
+  {
+    const u32 address = Memory::VirtToPhys(segment, offset);
+
+    m_direct = &Memory::Get()[address];
+    m_left = std::min<u32>(0x10000 - offset, Memory::SIZE - address);
+  }
+
+  u8 Next()
+  {
+    if (m_left == 0)
+      return Memory::Peek<u8>(m_segment, m_offset++);
+
+    m_left--;
+    m_offset++;
+    return *m_direct++;
+  }
+
+  //! Pointer to the next length bytes, which get skipped
+  const u8* Take(u8 length)
+  {
+    if (m_left >= length) {
+      const u8* data = m_direct;
+
+      m_left -= length;
+      m_offset += length;
+      m_direct += length;
+      return data;
+    }
+
+    for (u32 i = 0; i < length; i++)
+      m_data[i] = Next();
+
+    return m_data.data();
+  }
+
+private:
+  u16 m_segment;
+  u16 m_offset;
+  const u8* m_direct;
+  //! Bytes at m_direct before anything wraps
+  u32 m_left;
+  std::array<u8, Instruction::MAX_DATA_LENGTH> m_data;
+};
+} // namespace
+
+Instruction DecodeInstruction(u16 segment, u16 offset)
+{
+  CodeWindow code(segment, offset);
+
+  u8 opcode = code.Next();
+  Instruction ins(opcode, offset);
+
+  while (ins.IsPrefix())
+    ins = Instruction(ins, code.Next(), offset);
+
+  if (!ins.IsResolved()) {
+    u8 mod = code.Next();
+    u8 length = ins.GetLength(mod);
+
+    if (!ins.Resolve(mod, code.Take(length))) {
+      LOG("Failed to resolve " + String::ToHex(opcode) + " with mod " +
+          String::ToHex(mod));
+      throw InvalidParameterException(opcode, mod);
+    }
+  }
+
+  if (ins.GetType() == Instruction::Type::Invalid)
+    throw InvalidInstructionException(opcode);
+
+  ValidateOperands(ins);
+  ins.SetHandler(SelectHandler(ins));
+  ins.SetCycles(InstructionCycles(ins));
+
+  return ins;
+}
+
+// Cached instruction at a physical address, nullptr on a miss
+static const Instruction* Lookup(u32 address)
+{
+  const u32 page = address >> Memory::PAGE_SHIFT;
+  const auto& entry = (*s_cache)[address % CACHE_SIZE];
+
+  if (entry.address != address || entry.generation != s_generations[page])
+    return nullptr;
+
+  s_stats.hits++;
+  return &entry.instruction;
+}
+
+Instruction FetchInstruction(u16 segment, u16 offset)
+{
+  if (!use_instruction_cache)
+    return DecodeInstruction(segment, offset);
+
+  const u32 address = Memory::VirtToPhys(segment, offset);
+
+  if (const Instruction* cached = Lookup(address))
+    return *cached;
+
+  s_stats.misses++;
+
+  Instruction ins = DecodeInstruction(segment, offset);
+
+  // Instructions crossing a page or wrapping around the segment or memory are
+  // rare enough to not bother with
+  const u32 page = address >> Memory::PAGE_SHIFT;
+  const u32 end = address + ins.GetSize() - 1;
+
+  if (offset + ins.GetSize() <= 0x10000 && page == end >> Memory::PAGE_SHIFT) {
+    auto& entry = (*s_cache)[address % CACHE_SIZE];
+
+    entry.address = address;
+    entry.generation = s_generations[page];
+    entry.instruction = ins;
+
+    s_code_bytes.Mark(address, ins.GetSize());
+
+    Memory::page_flags[page] |= Memory::PAGE_FLAG_CODE;
+  }
+
+  return ins;
+}
+
+// Decoding reports what is wrong by throwing, which is fine on a cache miss
+static bool FetchOrFault(u16 segment, u16 offset, Instruction& ins)
+{
+  try {
+    ins = FetchInstruction(segment, offset);
+  } catch (const CPUException&) {
+    RaiseFault(FaultKind::Decode, std::current_exception());
+    return false;
+  }
+
+  return true;
+}
+
+bool TryFetchInstruction(u16 segment, u16 offset, Instruction& ins)
+{
+  if (use_instruction_cache) {
+    if (const Instruction* cached =
+            Lookup(Memory::VirtToPhys(segment, offset))) {
+      ins = *cached;
+      return true;
+    }
+  }
+
+  return FetchOrFault(segment, offset, ins);
+}
+
+static void InvalidatePage(u32 page)
+{
+  s_generations[page]++;
+  s_stats.invalidations++;
+
+  s_code_bytes.ClearPage(page);
+  Memory::page_flags[page] &= ~Memory::PAGE_FLAG_CODE;
+}
+
+void InvalidateInstructionCache(u32 address, u32 size)
+{
+  s_code_bytes.Invalidate(address, size, InvalidatePage);
+}
+
+void FlushInstructionCache()
+{
+  for (u32 page = 0; page < Memory::PAGE_COUNT; page++) {
+    if (Memory::page_flags[page] & Memory::PAGE_FLAG_CODE)
+      InvalidatePage(page);
+  }
+}
+
+InstructionCacheStats GetInstructionCacheStats() { return s_stats; }
+
+void ResetInstructionCacheStats() { s_stats = {}; }
+} // namespace Core::CPU
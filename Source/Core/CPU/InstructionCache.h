@@ -0,0 +1,59 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include "Common/Types.h"
+
+#include "Core/CPU/Instruction.h"
+
+namespace Core::CPU
+{
+//! Whether decoded instructions are kept around between executions
+extern bool use_instruction_cache;
+
+struct InstructionCacheStats {
+  //! Instructions taken from the cache
+  u64 hits = 0;
+  //! Instructions that had to be decoded
+  u64 misses = 0;
+  //! Pages dropped because they were written to
+  u64 invalidations = 0;
+};
+
+/**
+ * @brief Decode the instruction at segment:offset, bypassing the cache. The
+ * result has its operands validated and its handler selected
+ * @throws InvalidInstructionException, InvalidParameterException and
+ * whatever ValidateOperands() throws
+ */
+Instruction DecodeInstruction(u16 segment, u16 offset);
+
+/**
+ * @brief Get the decoded instruction at segment:offset. Only decodes if the
+ * instruction cache does not contain it yet
+ * @throws See DecodeInstruction()
+ */
+Instruction FetchInstruction(u16 segment, u16 offset);
+
+/**
+ * @brief FetchInstruction() for the run loop, which records a Decode fault
+ * instead of throwing
+ * @return false if the instruction couldn't be fetched, see GetFault()
+ */
+bool TryFetchInstruction(u16 segment, u16 offset, Instruction& ins);
+
+/**
+ * @brief Called when physical memory got written to. Drops the cached
+ * instructions of all pages in which the range overlaps decoded bytes
+ */
+void InvalidateInstructionCache(u32 address, u32 size);
+
+//! Drop all cached instructions
+void FlushInstructionCache();
+
+InstructionCacheStats GetInstructionCacheStats();
+void ResetInstructionCacheStats();
+} // namespace Core::CPU
@@ -4,119 +4,50 @@
 
 #include "Core/CPU/CPU.h"
 
-#include "Core/CPU/Exception.h"
+#include "Core/CPU/Flags.h"
+#include "Core/CPU/Instructions/Forms.h"
+#include "Core/CPU/Instructions/Operations.h"
 
 using namespace Core;
 
 void CPU::ADC(const Instruction& ins)
 {
-  auto& dst = ins.GetParameters()[0];
-  auto& src = ins.GetParameters()[1];
-
-  if (dst.IsWord()) {
-    u16& dst_16 = ParameterTo<u16&>(dst, ins.GetPrefix());
-
-    u32 sum = dst_16;
-
-    if (src.IsWord())
-      sum += ParameterTo<u16>(src, ins.GetPrefix());
-    else
-      sum += ParameterTo<u8>(src, ins.GetPrefix());
-
-    dst_16 = sum & 0xFFFF;
-
-    CF = dst_16 & 0x10000;
-    OF = dst_16 & 0x20000;
-
-    sum &= 0b1'1111'1111'1111'1111;
-
-    UpdateSF(static_cast<i16>(sum));
-    UpdateZF(static_cast<i16>(sum));
-    UpdatePF(static_cast<i16>(sum));
-  } else {
-    u8& dst_8 = ParameterTo<u8&>(dst, ins.GetPrefix());
-    u8 src_8 = ParameterTo<u8>(src, ins.GetPrefix());
-
-    u16 sum = dst_8 + src_8;
-
-    CF = sum & 0x100;
-    OF = sum & 0x200;
-
-    dst_8 = sum & 0xFF;
-
-    sum &= 0b1'1111'1111;
-
-    UpdateSF(sum);
-    UpdateZF(sum);
-    UpdatePF(sum);
-  }
+  Forms::GenericBinary<Operations::Adc>(ins);
 }
 
 void CPU::ADD(const Instruction& ins)
 {
-  auto& dst = ins.GetParameters()[0];
-  auto& src = ins.GetParameters()[1];
-
-  if (dst.IsWord()) {
-    i16& dst_16 = ParameterTo<i16&>(dst, ins.GetPrefix());
-    i16 src_16;
-
-    if (src.IsWord())
-      src_16 = ParameterTo<i16>(src, ins.GetPrefix());
-    else
-      src_16 = ParameterTo<i8>(src, ins.GetPrefix());
+  Forms::GenericBinary<Operations::Add>(ins);
+}
 
-    UpdateOF<i16>(dst_16 + src_16);
-    UpdateCF<i16>(static_cast<u16>(dst_16) + static_cast<u16>(src_16));
+void CPU::CBW(const Instruction&)
+{
+  // Copy the sign bit into all of AH
+  AH = AL & (0b1000'0000) ? 0xFF : 0x00;
+}
 
-    dst_16 += src_16;
+void CPU::CMP(const Instruction& ins)
+{
+  Forms::GenericBinary<Operations::Cmp>(ins);
+}
 
-    UpdateSF(dst_16);
-    UpdateZF(dst_16);
-    UpdatePF(dst_16);
+void CPU::DAA(const Instruction&)
+{
+  if ((AL & 0xF) > 9 || AF) {
+    // Carry out of the low byte
+    CF |= AL > 0xF9;
+    AL += 6;
+    AF = true;
   } else {
-    i8& dst_8 = ParameterTo<i8&>(dst, ins.GetPrefix());
-    i8 src_8 = ParameterTo<i8>(src, ins.GetPrefix());
-
-    if (dst.IsWord() != src.IsWord())
-      throw ParameterLengthMismatchException(ins, dst, src);
-
-    UpdateOF<i8>(dst_8 + src_8);
-    UpdateCF<i8>(static_cast<u8>(dst_8) + static_cast<u8>(src_8));
-
-    dst_8 += src_8;
-
-    UpdateSF(dst_8);
-    UpdateZF(dst_8);
-    UpdatePF(dst_8);
+    AF = false;
   }
+
+  UpdateSZP(AL);
 }
 
 void CPU::DEC(const Instruction& ins)
 {
-  auto& parameter = ins.GetParameters()[0];
-
-  if (parameter.IsWord()) {
-    i16& data_i16 = ParameterTo<i16&>(parameter, ins.GetPrefix());
-
-    UpdateOF<i16>(static_cast<i32>(data_i16) - 1);
-
-    data_i16--;
-
-    UpdateSF(data_i16);
-    UpdateZF(data_i16);
-    UpdatePF(data_i16);
-  } else {
-    i8& data_i8 = ParameterTo<i8&>(parameter, ins.GetPrefix());
-
-    UpdateOF<i8>(static_cast<i32>(data_i8) - 1);
-
-    data_i8--;
-
-    UpdateSF(data_i8);
-    UpdateZF(data_i8);
-    UpdatePF(data_i8);
-  }
+  Forms::GenericUnary<Operations::Dec>(ins);
 }
 
 void CPU::DIV(const Instruction& ins)
@@ -126,13 +57,13 @@ void CPU::DIV(const Instruction& ins)
   if (div.IsWord()) {
     u32 dx_ax = (DX << 16) | AX;
 
-    const u16 divisor = ParameterTo<u16>(div, ins.GetPrefix());
+    const u16 divisor = ParameterTo<u16>(div, ins.GetSegment());
 
     AX = static_cast<u16>(dx_ax / divisor);
     DX = dx_ax % divisor;
 
   } else {
-    const u8 divisor = ParameterTo<u8>(div, ins.GetPrefix());
+    const u8 divisor = ParameterTo<u8>(div, ins.GetSegment());
     AL = static_cast<u8>(AX / divisor);
     AH = AX % divisor;
   }
@@ -140,107 +71,39 @@ void CPU::DIV(const Instruction& ins)
 
 void CPU::INC(const Instruction& ins)
 {
-  auto& parameter = ins.GetParameters()[0];
-
-  if (parameter.IsWord()) {
-    i16& data_i16 = ParameterTo<i16&>(parameter, ins.GetPrefix());
+  Forms::GenericUnary<Operations::Inc>(ins);
+}
 
-    UpdateOF<i16>(static_cast<i32>(data_i16) + 1);
+void CPU::MUL(const Instruction& ins)
+{
+  auto& mul = ins.GetParameters()[0];
 
-    data_i16++;
+  if (mul.IsWord()) {
+    i32 result =
+        static_cast<i32>(AX) * ParameterTo<u16>(mul, ins.GetSegment());
 
-    UpdateSF(data_i16);
-    UpdateZF(data_i16);
-    UpdatePF(data_i16);
+    AX = result & 0xFFFF;
+    DX = (result & 0xFFFF0000) >> 16;
 
+    OF = CF = (AX & 0xff00) != 0;
   } else {
-    i8& data_i8 = ParameterTo<i8&>(parameter, ins.GetPrefix());
+    AX = static_cast<i16>(AL) * ParameterTo<u8>(mul, ins.GetSegment());
 
-    UpdateOF<i8>(static_cast<i32>(data_i8) + 1);
-
-    data_i8++;
-
-    UpdateSF(data_i8);
-    UpdateZF(data_i8);
-    UpdatePF(data_i8);
+    OF = CF = (AX & 0xff00) != 0;
   }
 }
 
-void CPU::SBB(const Instruction& ins)
+void CPU::NEG(const Instruction& ins)
 {
-  auto& dst = ins.GetParameters()[0];
-  auto& src = ins.GetParameters()[1];
-
-  if (dst.IsWord()) {
-    u16& dst_16 = ParameterTo<u16&>(dst, ins.GetPrefix());
-
-    u32 sum = dst_16;
-
-    if (src.IsWord())
-      sum -= ParameterTo<u16>(src, ins.GetPrefix());
-    else
-      sum -= ParameterTo<u8>(src, ins.GetPrefix());
-
-    dst_16 = sum & 0xFFFF;
-
-    CF = dst_16 & 0x10000;
-    OF = dst_16 & 0x20000;
-
-    sum &= 0b1111'1111'1111'1111;
-
-    UpdateSF(static_cast<i16>(sum));
-    UpdateZF(static_cast<i16>(sum));
-    UpdatePF(static_cast<i16>(sum));
-  } else {
-    u8& dst_8 = ParameterTo<u8&>(dst, ins.GetPrefix());
-    u8 src_8 = ParameterTo<u8>(src, ins.GetPrefix());
-
-    u16 sum = dst_8 - src_8;
-
-    CF = sum & 0x100;
-    OF = sum & 0x200;
-
-    dst_8 = sum & 0xFF;
-
-    sum &= 0b1111'1111;
+  Forms::GenericUnary<Operations::Neg>(ins);
+}
 
-    UpdateSF(static_cast<i8>(sum));
-    UpdateZF(static_cast<i8>(sum));
-    UpdatePF(static_cast<i8>(sum));
-  }
+void CPU::SBB(const Instruction& ins)
+{
+  Forms::GenericBinary<Operations::Sbb>(ins);
 }
 
 void CPU::SUB(const Instruction& ins)
 {
-  auto& dst = ins.GetParameters()[0];
-  auto& src = ins.GetParameters()[1];
-
-  if (dst.IsWord() != src.IsWord())
-    throw ParameterLengthMismatchException(ins, dst, src);
-
-  if (dst.IsWord()) {
-    u16& dst16 = ParameterTo<u16&>(dst, ins.GetPrefix());
-    u16 src16 = ParameterTo<u16>(src, ins.GetPrefix());
-
-    UpdateOF<i16>(dst16 - src16);
-    UpdateCF<i16>(dst16 - src16);
-
-    dst16 -= src16;
-
-    UpdateSF(dst16);
-    UpdateZF(dst16);
-    UpdatePF(dst16);
-  } else {
-    u8& dst8 = ParameterTo<u8&>(dst, ins.GetPrefix());
-    u8 src8 = ParameterTo<u8>(src, ins.GetPrefix());
-
-    UpdateOF<i8>(dst8 - src8);
-    UpdateCF<i8>(dst8 - src8);
-
-    dst8 -= src8;
-
-    UpdateSF(dst8);
-    UpdateZF(dst8);
-    UpdatePF(dst8);
-  }
+  Forms::GenericBinary<Operations::Sub>(ins);
 }
@@ -0,0 +1,45 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/CPU.h"
+
+#include "Common/Logger.h"
+
+using namespace Core;
+
+void CPU::CLC(const Instruction&) { CF = false; }
+void CPU::CMC(const Instruction&) { CF = !CF; }
+void CPU::STC(const Instruction&) { CF = true; }
+
+void CPU::CLD(const Instruction&) { DF = false; }
+void CPU::STD(const Instruction&) { DF = true; }
+
+void CPU::CLI(const Instruction&) { IF = false; }
+void CPU::STI(const Instruction&) { IF = true; }
+
+void CPU::HLT(const Instruction&)
+{
+  // Without interrupts nothing would ever wake the CPU up again
+  if (!IF) {
+    LOG("CPU halted with interrupts disabled, stopping...");
+    Stop();
+    return;
+  }
+
+  if (!HasInterruptSources()) {
+    LOG("CPU halted without anything that could interrupt it, stopping...");
+    Stop();
+    return;
+  }
+
+  RequestWork(PENDING_HALT);
+}
+
+void CPU::INT(const Instruction& ins)
+{
+  auto& parameter = ins.GetParameters()[0];
+  CallInterrupt(parameter.GetData<u8>());
+}
+
+void CPU::NOP(const Instruction&) { LOG("NOP? NOP."); }
@@ -0,0 +1,245 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include <array>
+#include <type_traits>
+
+#include "Core/CPU/CPU.h"
+
+//! \cond PRIVATE
+// Handlers templated over operand width and operand kind. Dispatch picks one
+// instantiation per decoded instruction, so those never look at the width
+// again. The generic handlers instantiate them with AnyOperand and only
+// branch on the width once.
+namespace Core::CPU::Forms
+{
+using Parameter = Instruction::Parameter;
+using PType = Parameter::Type;
+using Prefix = Instruction::SegmentPrefix;
+
+template <typename T> using RegisterTable = std::array<T*, 256>;
+
+inline RegisterTable<u8> BuildByteRegisters()
+{
+  RegisterTable<u8> table{};
+
+  table[static_cast<u8>(PType::AL)] = &AL;
+  table[static_cast<u8>(PType::AH)] = &AH;
+  table[static_cast<u8>(PType::BL)] = &BL;
+  table[static_cast<u8>(PType::BH)] = &BH;
+  table[static_cast<u8>(PType::CL)] = &CL;
+  table[static_cast<u8>(PType::CH)] = &CH;
+  table[static_cast<u8>(PType::DL)] = &DL;
+  table[static_cast<u8>(PType::DH)] = &DH;
+
+  return table;
+}
+
+inline RegisterTable<u16> BuildWordRegisters()
+{
+  RegisterTable<u16> table{};
+
+  table[static_cast<u8>(PType::AX)] = &AX;
+  table[static_cast<u8>(PType::BX)] = &BX;
+  table[static_cast<u8>(PType::CX)] = &CX;
+  table[static_cast<u8>(PType::DX)] = &DX;
+  table[static_cast<u8>(PType::CS)] = &CS;
+  table[static_cast<u8>(PType::DS)] = &DS;
+  table[static_cast<u8>(PType::ES)] = &ES;
+  table[static_cast<u8>(PType::SS)] = &SS;
+  table[static_cast<u8>(PType::BP)] = &BP;
+  table[static_cast<u8>(PType::SP)] = &SP;
+  table[static_cast<u8>(PType::DI)] = &DI;
+  table[static_cast<u8>(PType::SI)] = &SI;
+
+  return table;
+}
+
+inline const RegisterTable<u8> byte_registers = BuildByteRegisters();
+inline const RegisterTable<u16> word_registers = BuildWordRegisters();
+
+// Operand accessors. Modify() is used for destinations that get read and
+// written, Store() for ones that only get written and Value() for everything
+// else. Memory is never handed out by reference, words at offset FFFF have to
+// wrap around within their segment.
+struct RegisterOperand {
+  template <typename T> static T& Ref(const Parameter& parameter)
+  {
+    if constexpr (std::is_same_v<T, u8>)
+      return *byte_registers[static_cast<u8>(parameter.GetType())];
+    else
+      return *word_registers[static_cast<u8>(parameter.GetType())];
+  }
+
+  template <typename T> static T Value(const Parameter& parameter, Prefix)
+  {
+    return Ref<T>(parameter);
+  }
+
+  template <typename T>
+  static void Store(const Parameter& parameter, Prefix, T value)
+  {
+    Ref<T>(parameter) = value;
+  }
+
+  template <typename T, typename F>
+  static void Modify(const Parameter& parameter, Prefix, F modify)
+  {
+    modify(Ref<T>(parameter));
+  }
+};
+
+struct ImmediateOperand {
+  template <typename T> static T Value(const Parameter& parameter, Prefix)
+  {
+    return parameter.GetData<T>();
+  }
+};
+
+//! Byte immediate of a word operation, e.g. ADD AX, -1 encoded as 83 C0 FF
+struct SignExtendedImmediateOperand {
+  template <typename T> static T Value(const Parameter& parameter, Prefix)
+  {
+    static_assert(std::is_same_v<T, u16>, "Only words get sign extended");
+
+    return static_cast<u16>(static_cast<i8>(parameter.GetData<u8>()));
+  }
+};
+
+//! Shift and rotate count of D0 and D1
+struct ImpliedOneOperand {
+  template <typename T> static T Value(const Parameter&, Prefix) { return 1; }
+};
+
+//! Anything ParameterTo() understands, including memory
+struct AnyOperand {
+  template <typename T>
+  static T Value(const Parameter& parameter, Prefix segment)
+  {
+    return ParameterTo<T>(parameter, segment);
+  }
+
+  template <typename T>
+  static void Store(const Parameter& parameter, Prefix segment, T value)
+  {
+    WriteParameter<T>(parameter, segment, value);
+  }
+
+  template <typename T, typename F>
+  static void Modify(const Parameter& parameter, Prefix segment, F modify)
+  {
+    ModifyParameter<T>(parameter, segment, modify);
+  }
+};
+
+//! Memory operands only need their effective offset
+struct MemoryOperand {
+  template <typename T>
+  static T Value(const Parameter& parameter, Prefix segment)
+  {
+    return Memory::Read<T>(PrefixToValue(segment), EffectiveOffset(parameter));
+  }
+
+  template <typename T>
+  static void Store(const Parameter& parameter, Prefix segment, T value)
+  {
+    Memory::Write<T>(PrefixToValue(segment), EffectiveOffset(parameter),
+                     value);
+  }
+
+  template <typename T, typename F>
+  static void Modify(const Parameter& parameter, Prefix segment, F modify)
+  {
+    Memory::Modify<T>(PrefixToValue(segment), EffectiveOffset(parameter),
+                      modify);
+  }
+};
+
+//! Byte operand of a word operation, which isn't necessarily an immediate
+struct SignExtendedOperand {
+  template <typename T>
+  static T Value(const Parameter& parameter, Prefix segment)
+  {
+    static_assert(std::is_same_v<T, u16>, "Only words get sign extended");
+
+    return static_cast<u16>(ParameterTo<i8>(parameter, segment));
+  }
+};
+
+template <typename Op, typename T, typename Dst, typename Src>
+void Binary(const Instruction& ins)
+{
+  const auto& parameters = ins.GetParameters();
+  const Prefix segment = ins.GetSegment();
+
+  if constexpr (!Op::READS) {
+    T dst{};
+    Op::Apply(dst, Src::template Value<T>(parameters[1], segment));
+    Dst::template Store<T>(parameters[0], segment, dst);
+  } else if constexpr (Op::WRITES) {
+    const T src = Src::template Value<T>(parameters[1], segment);
+    Dst::template Modify<T>(parameters[0], segment,
+                            [src](T& dst) { Op::Apply(dst, src); });
+  } else {
+    T dst = Dst::template Value<T>(parameters[0], segment);
+    Op::Apply(dst, Src::template Value<T>(parameters[1], segment));
+  }
+}
+
+template <typename Op, typename T, typename Dst>
+void Unary(const Instruction& ins)
+{
+  Dst::template Modify<T>(ins.GetParameters()[0], ins.GetSegment(),
+                          [](T& dst) { Op::Apply(dst); });
+}
+
+//! Shifts and rotates, the count is always a byte
+template <typename Op, typename T, typename Dst, typename Count>
+void Shift(const Instruction& ins)
+{
+  const auto& parameters = ins.GetParameters();
+  const Prefix segment = ins.GetSegment();
+  const u8 count = Count::template Value<u8>(parameters[1], segment);
+
+  if constexpr (!std::is_same_v<Count, ImpliedOneOperand>) {
+    if (parameters[1].GetType() == PType::CL)
+      cycles += SHIFT_BIT_CYCLES * count;
+  }
+
+  Dst::template Modify<T>(parameters[0], segment,
+                          [count](T& dst) { Op::Apply(dst, count); });
+}
+
+template <typename Op> void GenericBinary(const Instruction& ins)
+{
+  const auto& parameters = ins.GetParameters();
+
+  if (!parameters[0].IsWord())
+    Binary<Op, u8, AnyOperand, AnyOperand>(ins);
+  else if (parameters[1].IsWord())
+    Binary<Op, u16, AnyOperand, AnyOperand>(ins);
+  else
+    Binary<Op, u16, AnyOperand, SignExtendedOperand>(ins);
+}
+
+template <typename Op> void GenericUnary(const Instruction& ins)
+{
+  if (ins.GetParameters()[0].IsWord())
+    Unary<Op, u16, AnyOperand>(ins);
+  else
+    Unary<Op, u8, AnyOperand>(ins);
+}
+
+template <typename Op> void GenericShift(const Instruction& ins)
+{
+  if (ins.GetParameters()[0].IsWord())
+    Shift<Op, u16, AnyOperand, AnyOperand>(ins);
+  else
+    Shift<Op, u8, AnyOperand, AnyOperand>(ins);
+}
+} // namespace Core::CPU::Forms
+//! \endcond PRIVATE
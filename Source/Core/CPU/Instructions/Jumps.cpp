@@ -8,13 +8,20 @@
 #include "Common/String.h"
 #include "Common/Swap.h"
 
-#include "Core/CPU/Exception.h"
-
 using namespace Core;
 
 using Type = CPU::Instruction::Type;
 using PType = CPU::Instruction::Parameter::Type;
 
+namespace
+{
+void TakeBranch(const CPU::Instruction& instruction)
+{
+  CPU::cycles += CPU::BRANCH_TAKEN_CYCLES;
+  CPU::JMP(instruction);
+}
+} // namespace
+
 void CPU::JMP(const Instruction& instruction)
 {
   auto& parameter = instruction.GetParameters()[0];
@@ -22,10 +29,6 @@ void CPU::JMP(const Instruction& instruction)
   case PType::Literal_Offset:
     IP += parameter.GetData<i8>();
     break;
-  case PType::Value_BP_Offset_Word:
-  case PType::Literal_WordOffset:
-    IP += ParameterTo<i16>(parameter, instruction.GetPrefix());
-    break;
   case PType::Literal_LongAddress_Immediate: {
     u32 address = parameter.GetData<u32>();
 
@@ -36,112 +39,136 @@ void CPU::JMP(const Instruction& instruction)
     break;
   }
   default:
-    LOG("[JMP] Don't know what to do with parameter type: " +
-        ParameterTypeToString(parameter.GetType()));
-    throw UnhandledParameterException(parameter);
+    // Literal_WordOffset or Value_BP_Offset_Word, see ValidateOperands()
+    IP += ParameterTo<i16>(parameter, instruction.GetSegment());
+    break;
   }
 }
 
 void CPU::JA(const Instruction& instruction)
 {
   if (!CF && !ZF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JBE(const Instruction& instruction)
 {
   if (CF || ZF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JB(const Instruction& instruction)
 {
   if (CF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JNB(const Instruction& instruction)
 {
   if (!CF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JCXZ(const Instruction& instruction)
 {
   if (!CX)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JG(const Instruction& instruction)
 {
   if (!ZF && (SF == OF))
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JGE(const Instruction& instruction)
 {
   if (SF == OF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JL(const Instruction& instruction)
 {
   if (SF != OF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JLE(const Instruction& instruction)
 {
   if (ZF || SF != OF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JO(const Instruction& instruction)
 {
   if (OF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JNO(const Instruction& instruction)
 {
   if (!OF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JPE(const Instruction& instruction)
 {
   if (PF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JPO(const Instruction& instruction)
 {
   if (!PF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JS(const Instruction& instruction)
 {
   if (SF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JNS(const Instruction& instruction)
 {
   if (!SF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JZ(const Instruction& instruction)
 {
   if (ZF)
-    JMP(instruction);
+    TakeBranch(instruction);
 }
 
 void CPU::JNZ(const Instruction& instruction)
 {
   if (!ZF)
-    JMP(instruction);
+    TakeBranch(instruction);
+}
+
+void CPU::LOOP(const Instruction& ins)
+{
+  // LOG("CX = " + String::ToHex(CX));
+
+  CX--;
+
+  if (CX == 0)
+    return;
+
+  cycles += BRANCH_TAKEN_CYCLES;
+  IP += ins.GetParameters()[0].GetData<i8>();
+}
+
+void CPU::LOOPNZ(const Instruction& ins)
+{
+  CX--;
+
+  if (CX == 0 || !ZF)
+    return;
+
+  cycles += LOOPNZ_TAKEN_CYCLES;
+  IP += ins.GetParameters()[0].GetData<i8>();
 }
 
 void CPU::CALL(const Instruction& instruction)
@@ -156,7 +183,7 @@ void CPU::CALL(const Instruction& instruction)
     u16 segment = (addr & 0xFFFF);
 
     SP -= sizeof(u16);
-    Memory::Get<u16>(SS, SP) = IP;
+    Memory::Write<u16>(SS, SP, IP);
 
     CS = segment;
     IP = offset;
@@ -164,20 +191,17 @@ void CPU::CALL(const Instruction& instruction)
     return;
   }
 
-  if (!parameter.IsWord())
-    throw UnsupportedParameterException(instruction, parameter);
-
-  u16 offset = ParameterTo<u16>(parameter, instruction.GetPrefix());
+  u16 offset = ParameterTo<u16>(parameter, instruction.GetSegment());
 
   SP -= sizeof(u16);
-  Memory::Get<u16>(SS, SP) = IP;
+  Memory::Write<u16>(SS, SP, IP);
 
   IP += offset;
 }
 
 void CPU::RET(const Instruction&)
 {
-  IP = Memory::Get<u16>(SS, SP);
+  IP = Memory::Read<u16>(SS, SP);
 
   SP += sizeof(u16);
 }
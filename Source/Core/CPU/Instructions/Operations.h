@@ -0,0 +1,252 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include <type_traits>
+
+#include "Core/CPU/CPU.h"
+
+//! \cond PRIVATE
+// Value level implementations of the ALU instructions. Shared between the
+// generic handlers and the ones specialised on operand kinds, so both
+// interpreters always agree on results and flags. Flags are only recorded
+// here, see LazyFlags.h. READS and WRITES tell whether binary operations look
+// at and change their destination.
+namespace Core::CPU::Operations
+{
+struct Mov {
+  static constexpr bool READS = false;
+  static constexpr bool WRITES = true;
+
+  template <typename T> static void Apply(T& dst, T src) { dst = src; }
+};
+
+struct Add {
+  static constexpr bool READS = true;
+  static constexpr bool WRITES = true;
+
+  template <typename T> static void Apply(T& dst, T src)
+  {
+    const T result = dst + src;
+
+    RecordFlags<T>(FlagOp::Add, dst, src, result);
+    dst = result;
+  }
+};
+
+struct Adc {
+  static constexpr bool READS = true;
+  static constexpr bool WRITES = true;
+
+  template <typename T> static void Apply(T& dst, T src)
+  {
+    const bool carry = CF;
+    const T result = dst + src + carry;
+
+    RecordFlags<T>(FlagOp::Add, dst, src, result, carry);
+    dst = result;
+  }
+};
+
+struct Sub {
+  static constexpr bool READS = true;
+  static constexpr bool WRITES = true;
+
+  template <typename T> static void Apply(T& dst, T src)
+  {
+    const T result = dst - src;
+
+    RecordFlags<T>(FlagOp::Sub, dst, src, result);
+    dst = result;
+  }
+};
+
+struct Sbb {
+  static constexpr bool READS = true;
+  static constexpr bool WRITES = true;
+
+  template <typename T> static void Apply(T& dst, T src)
+  {
+    const bool borrow = CF;
+    const T result = dst - src - borrow;
+
+    RecordFlags<T>(FlagOp::Sub, dst, src, result, borrow);
+    dst = result;
+  }
+};
+
+struct Cmp {
+  static constexpr bool READS = true;
+  static constexpr bool WRITES = false;
+
+  template <typename T> static void Apply(T dst, T src)
+  {
+    Sub::Apply(dst, src);
+  }
+};
+
+struct And {
+  static constexpr bool READS = true;
+  static constexpr bool WRITES = true;
+
+  template <typename T> static void Apply(T& dst, T src)
+  {
+    dst &= src;
+
+    RecordFlags<T>(FlagOp::Logic, dst, src, dst);
+  }
+};
+
+struct Test {
+  static constexpr bool READS = true;
+  static constexpr bool WRITES = false;
+
+  template <typename T> static void Apply(T dst, T src)
+  {
+    And::Apply(dst, src);
+  }
+};
+
+struct Or {
+  static constexpr bool READS = true;
+  static constexpr bool WRITES = true;
+
+  template <typename T> static void Apply(T& dst, T src)
+  {
+    dst |= src;
+
+    RecordFlags<T>(FlagOp::Logic, dst, src, dst);
+  }
+};
+
+struct Xor {
+  static constexpr bool READS = true;
+  static constexpr bool WRITES = true;
+
+  template <typename T> static void Apply(T& dst, T src)
+  {
+    dst ^= src;
+
+    RecordFlags<T>(FlagOp::Logic, dst, src, dst);
+  }
+};
+
+// INC and DEC leave CF alone
+
+struct Inc {
+  template <typename T> static void Apply(T& dst)
+  {
+    const T result = dst + 1;
+
+    RecordFlags<T>(FlagOp::Add, dst, 1, result, false,
+                   FLAGS_ARITHMETIC & ~FLAG_CF);
+    dst = result;
+  }
+};
+
+struct Dec {
+  template <typename T> static void Apply(T& dst)
+  {
+    const T result = dst - 1;
+
+    RecordFlags<T>(FlagOp::Sub, dst, 1, result, false,
+                   FLAGS_ARITHMETIC & ~FLAG_CF);
+    dst = result;
+  }
+};
+
+struct Neg {
+  template <typename T> static void Apply(T& dst)
+  {
+    const T result = -dst;
+
+    RecordFlags<T>(FlagOp::Sub, 0, dst, result);
+    dst = result;
+  }
+};
+
+// Shifts and rotates use the whole count, the 8086 doesn't mask it. A count
+// of 0 leaves the flags alone.
+struct Shl {
+  template <typename T> static void Apply(T& dst, u8 count)
+  {
+    constexpr u32 BITS = sizeof(T) * 8;
+    constexpr T MSB = static_cast<T>(1 << (BITS - 1));
+
+    if (count == 0)
+      return;
+
+    const T result = count < BITS ? static_cast<T>(dst << count) : 0;
+    const bool cf = count <= BITS && ((dst >> (BITS - count)) & 1);
+    const bool of = ((result & MSB) != 0) != cf;
+
+    SetFlags(FLAG_CF | FLAG_OF | FLAG_SF | FLAG_ZF | FLAG_PF,
+             SZPFlags(result) | (cf ? FLAG_CF : 0) | (of ? FLAG_OF : 0));
+    dst = result;
+  }
+};
+
+struct Shr {
+  template <typename T> static void Apply(T& dst, u8 count)
+  {
+    constexpr u32 BITS = sizeof(T) * 8;
+    constexpr T MSB = static_cast<T>(1 << (BITS - 1));
+
+    if (count == 0)
+      return;
+
+    const T result = count < BITS ? static_cast<T>(dst >> count) : 0;
+    const bool cf = count <= BITS && ((dst >> (count - 1)) & 1);
+    const bool of = dst & MSB;
+
+    SetFlags(FLAG_CF | FLAG_OF | FLAG_SF | FLAG_ZF | FLAG_PF,
+             SZPFlags(result) | (cf ? FLAG_CF : 0) | (of ? FLAG_OF : 0));
+    dst = result;
+  }
+};
+
+// Rotates only touch CF and OF
+struct Rol {
+  template <typename T> static void Apply(T& dst, u8 count)
+  {
+    constexpr u32 BITS = sizeof(T) * 8;
+    constexpr T MSB = static_cast<T>(1 << (BITS - 1));
+
+    if (count == 0)
+      return;
+
+    const u32 n = count % BITS;
+    const T result =
+        n == 0 ? dst : static_cast<T>((dst << n) | (dst >> (BITS - n)));
+    const bool cf = result & 1;
+    const bool of = ((result & MSB) != 0) != cf;
+
+    SetFlags(FLAG_CF | FLAG_OF, (cf ? FLAG_CF : 0) | (of ? FLAG_OF : 0));
+    dst = result;
+  }
+};
+
+struct Ror {
+  template <typename T> static void Apply(T& dst, u8 count)
+  {
+    constexpr u32 BITS = sizeof(T) * 8;
+    constexpr T MSB = static_cast<T>(1 << (BITS - 1));
+
+    if (count == 0)
+      return;
+
+    const u32 n = count % BITS;
+    const T result =
+        n == 0 ? dst : static_cast<T>((dst >> n) | (dst << (BITS - n)));
+    const bool cf = result & MSB;
+    const bool of = ((result ^ (result << 1)) & MSB) != 0;
+
+    SetFlags(FLAG_CF | FLAG_OF, (cf ? FLAG_CF : 0) | (of ? FLAG_OF : 0));
+    dst = result;
+  }
+};
+} // namespace Core::CPU::Operations
+//! \endcond PRIVATE
@@ -4,112 +4,248 @@
 
 #include "Core/CPU/CPU.h"
 
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+#include "Core/CPU/Instructions/Operations.h"
+#include "Core/Memory.h"
+
 using namespace Core;
 
-void CPU::STOSB(const Instruction&)
+namespace
 {
-  do {
-    Memory::Get<u8>(ES, DI) = AL;
+using namespace Core::CPU;
+
+template <typename T> T& Accumulator()
+{
+  if constexpr (std::is_same_v<T, u8>)
+    return AL;
+  else
+    return AX;
+}
 
-    DI += (DF ? -1 : 1) * static_cast<int>(sizeof(u8));
-  } while (HandleRepetition());
+// Step an index register to the next element
+template <typename T> void Advance(u16& index)
+{
+  index += (DF ? -1 : 1) * static_cast<int>(sizeof(T));
 }
 
-void CPU::STOSW(const Instruction&)
+// Cycles every iteration adds on top of the instruction's, non-zero only if
+// the instruction is REP prefixed
+u64 IterationCycles(const Instruction& ins)
 {
-  do {
-    Memory::Get<u16>(ES, DI) = AX;
+  if (ins.GetRepeatMode() == RepeatMode::None)
+    return 0;
 
-    DI += (DF ? -1 : 1) * static_cast<int>(sizeof(u16));
-  } while (HandleRepetition());
+  return RepeatedCycles(ins.GetType());
 }
 
-void CPU::CMPSB(const Instruction&)
+// A REP prefix with CX = 0 skips the instruction entirely
+bool Skipped(const Instruction& ins)
 {
-  do {
-    u8 dst = Memory::Get<u8>(DS, SI);
-    u8 src = Memory::Get<u8>(ES, DI);
-    u8 cmp = dst - src;
-
-    // LOG("Comparing " + String::ToHex(dst) + " (" + String::ToHex(DS) + ":"
-    // +
-    //    String::ToHex(SI) + ") with " + String::ToHex(src) + " (" +
-    //    String::ToHex(ES) + ":" + String::ToHex(DI) + ")");
-
-    UpdateSF(cmp);
-    UpdateZF(cmp);
-    UpdatePF(cmp);
-    UpdateOF<i8>(cmp);
-    UpdateCF<i8>(cmp);
-
-    SI += (DF ? -1 : 1) * static_cast<int>(sizeof(u8));
-    DI += (DF ? -1 : 1) * static_cast<int>(sizeof(u8));
-  } while (HandleRepetition());
+  return ins.GetRepeatMode() != RepeatMode::None && CX == 0;
 }
 
-void CPU::CMPSW(const Instruction&)
+// Pages that make the whole-range paths below fall back to the element wise
+// loop, as every access has to be looked at
+constexpr u8 READ_SLOW_FLAGS = Memory::PAGE_FLAG_DEVICE |
+                               Memory::PAGE_FLAG_WATCHED;
+constexpr u8 WRITE_SLOW_FLAGS = READ_SLOW_FLAGS | Memory::PAGE_FLAG_ROM;
+
+/**
+ * @brief Lowest physical address of the count elements a string instruction
+ * steps over from segment:index on. Nothing if they wrap around the segment
+ * or memory, or touch a page with any of flags
+ */
+template <typename T>
+std::optional<u32> Range(u16 segment, u16 index, u32 count, u8 flags)
 {
-  do {
-    u16 dst = Memory::Get<u16>(DS, SI);
-    u16 src = Memory::Get<u16>(ES, DI);
-    u16 cmp = dst - src;
-
-    // LOG("Comparing " + String::ToHex(dst) + " (" + String::ToHex(DS) + ":"
-    // +
-    //    String::ToHex(SI) + ") with " + String::ToHex(src) + " (" +
-    //    String::ToHex(ES) + ":" + String::ToHex(DI) + ")");
-
-    UpdateSF(cmp);
-    UpdateZF(cmp);
-    UpdatePF(cmp);
-    UpdateOF<i16>(cmp);
-    UpdateCF<i16>(cmp);
-
-    SI += (DF ? -1 : 1) * static_cast<int>(sizeof(u16));
-    DI += (DF ? -1 : 1) * static_cast<int>(sizeof(u16));
-  } while (HandleRepetition());
+  const u32 size = count * sizeof(T);
+  u32 low = index;
+
+  // Stepping down from index, which is the highest element then
+  if (DF) {
+    if (index + sizeof(T) < size)
+      return {};
+
+    low = index + sizeof(T) - size;
+  }
+
+  if (low + size > 0x10000)
+    return {};
+
+  const u32 address = Memory::VirtToPhys(segment, static_cast<u16>(low));
+
+  if (address + size > Memory::SIZE)
+    return {};
+
+  for (u32 page = address >> Memory::PAGE_SHIFT;
+       page <= (address + size - 1) >> Memory::PAGE_SHIFT; page++) {
+    if (Memory::page_flags[page] & flags)
+      return {};
+  }
+
+  return address;
+}
+
+// Finish a REP string instruction that went through all of CX at once
+template <typename T> void Repeated(const Instruction& ins, u16& index)
+{
+  const u16 size = static_cast<u16>(CX * sizeof(T));
+
+  cycles += IterationCycles(ins) * CX;
+  index = DF ? index - size : index + size;
+  CX = 0;
 }
 
-void CPU::LODSB(const Instruction&)
+// REP STOS as a single fill
+template <typename T> bool FillRepeated(const Instruction& ins)
 {
+  const std::optional<u32> address = Range<T>(ES, DI, CX, WRITE_SLOW_FLAGS);
+
+  if (!address)
+    return false;
+
+  const u32 size = CX * sizeof(T);
+  u8* destination = Memory::HandleWrite(*address, size);
+
+  if constexpr (sizeof(T) == 1) {
+    std::memset(destination, AL, size);
+  } else {
+    const u16 value = AX;
+
+    for (u32 i = 0; i < size; i += sizeof(T))
+      std::memcpy(destination + i, &value, sizeof(T));
+  }
+
+  Repeated<T>(ins, DI);
+  return true;
+}
+
+// REP MOVS as a single copy, unless the ranges overlap in a way that makes
+// copying element by element repeat a pattern
+template <typename T> bool CopyRepeated(const Instruction& ins)
+{
+  const u16 segment = PrefixToValue(ins.GetPrefix());
+  const std::optional<u32> source = Range<T>(segment, SI, CX, READ_SLOW_FLAGS);
+
+  if (!source)
+    return false;
+
+  const std::optional<u32> destination =
+      Range<T>(ES, DI, CX, WRITE_SLOW_FLAGS);
+
+  if (!destination)
+    return false;
+
+  const u32 size = CX * sizeof(T);
+
+  // Upwards, elements would get written before they're read when the
+  // destination starts within the source, downwards when it ends within it
+  if (!DF && *source < *destination && *destination < *source + size)
+    return false;
+
+  if (DF && *destination < *source && *source < *destination + size)
+    return false;
+
+  std::memmove(Memory::HandleWrite(*destination, size),
+               &Memory::Get()[*source], size);
+
+  Repeated<T>(ins, DI);
+  SI = DF ? SI - size : SI + size;
+  return true;
+}
+
+template <typename T> void Stos(const Instruction& ins)
+{
+  if (Skipped(ins))
+    return;
+
+  if (ins.GetRepeatMode() == RepeatMode::Repeat && FillRepeated<T>(ins))
+    return;
+
+  const u64 iteration = IterationCycles(ins);
+
   do {
-    AL = Memory::Get<u8>(DS, SI);
+    cycles += iteration;
 
-    SI += (DF ? -1 : 1) * static_cast<int>(sizeof(u8));
-  } while (HandleRepetition());
+    Memory::Write<T>(ES, DI, Accumulator<T>());
+
+    Advance<T>(DI);
+  } while (HandleRepetition(ins.GetRepeatMode()));
 }
 
-void CPU::LODSW(const Instruction&)
+template <typename T> void Cmps(const Instruction& ins)
 {
+  if (Skipped(ins))
+    return;
+
+  const u64 iteration = IterationCycles(ins);
+
   do {
-    AX = Memory::Get<u16>(DS, SI);
+    cycles += iteration;
 
-    SI += (DF ? -1 : 1) * static_cast<int>(sizeof(u16));
-  } while (HandleRepetition());
+    T dst = Memory::Read<T>(DS, SI);
+    T src = Memory::Read<T>(ES, DI);
+
+    Operations::Cmp::Apply(dst, src);
+
+    Advance<T>(SI);
+    Advance<T>(DI);
+  } while (HandleRepetition(ins.GetRepeatMode()));
 }
 
-void CPU::MOVSB(const Instruction& ins)
+template <typename T> void Lods(const Instruction& ins)
 {
+  if (Skipped(ins))
+    return;
+
+  const u64 iteration = IterationCycles(ins);
+
   do {
-    u8& dst = Memory::Get<u8>(ES, DI);
-    u8 src = Memory::Get<u8>(PrefixToValue(ins.GetPrefix()), SI);
+    cycles += iteration;
 
-    dst = src;
+    Accumulator<T>() = Memory::Read<T>(DS, SI);
 
-    DI += (DF ? -1 : 1) * static_cast<int>(sizeof(u8));
-    SI += (DF ? -1 : 1) * static_cast<int>(sizeof(u8));
-  } while (HandleRepetition());
+    Advance<T>(SI);
+  } while (HandleRepetition(ins.GetRepeatMode()));
 }
 
-void CPU::MOVSW(const Instruction& ins)
+template <typename T> void Movs(const Instruction& ins)
 {
+  if (Skipped(ins))
+    return;
+
+  if (ins.GetRepeatMode() == RepeatMode::Repeat && CopyRepeated<T>(ins))
+    return;
+
+  const u64 iteration = IterationCycles(ins);
+
   do {
-    u16& dst = Memory::Get<u16>(ES, DI);
-    u16 src = Memory::Get<u16>(PrefixToValue(ins.GetPrefix()), SI);
+    cycles += iteration;
 
-    dst = src;
+    Memory::Write<T>(ES, DI,
+                     Memory::Read<T>(PrefixToValue(ins.GetPrefix()), SI));
 
-    DI += (DF ? -1 : 1) * static_cast<int>(sizeof(u16));
-    SI += (DF ? -1 : 1) * static_cast<int>(sizeof(u16));
-  } while (HandleRepetition());
+    Advance<T>(DI);
+    Advance<T>(SI);
+  } while (HandleRepetition(ins.GetRepeatMode()));
 }
+} // namespace
+
+void CPU::STOSB(const Instruction& ins) { Stos<u8>(ins); }
+
+void CPU::STOSW(const Instruction& ins) { Stos<u16>(ins); }
+
+void CPU::CMPSB(const Instruction& ins) { Cmps<u8>(ins); }
+
+void CPU::CMPSW(const Instruction& ins) { Cmps<u16>(ins); }
+
+void CPU::LODSB(const Instruction& ins) { Lods<u8>(ins); }
+
+void CPU::LODSW(const Instruction& ins) { Lods<u16>(ins); }
+
+void CPU::MOVSB(const Instruction& ins) { Movs<u8>(ins); }
+
+void CPU::MOVSW(const Instruction& ins) { Movs<u16>(ins); }
@@ -0,0 +1,120 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/CPU.h"
+
+using namespace Core;
+
+void CPU::LDS(const Instruction& ins)
+{
+  auto& dst = ins.GetParameters()[0];
+  auto& src = ins.GetParameters()[1];
+
+  const u16 segment = PrefixToValue(ins.GetSegment());
+  const u16 pointer = EffectiveOffset(src);
+
+  const u16 offset = Memory::Read<u16>(segment, pointer);
+  DS = Memory::Read<u16>(segment, pointer + 2);
+  ParameterTo<u16&>(dst, ins.GetSegment()) = offset;
+}
+
+void CPU::LEA(const Instruction& ins)
+{
+  auto& dst = ins.GetParameters()[0];
+  auto& src = ins.GetParameters()[1];
+
+  ParameterTo<u16&>(dst, ins.GetSegment()) = EffectiveOffset(src);
+}
+
+void CPU::LES(const Instruction& ins)
+{
+  auto& dst = ins.GetParameters()[0];
+  auto& src = ins.GetParameters()[1];
+
+  const u16 segment = PrefixToValue(ins.GetSegment());
+  const u16 pointer = EffectiveOffset(src);
+
+  const u16 offset = Memory::Read<u16>(segment, pointer);
+  ES = Memory::Read<u16>(segment, pointer + 2);
+  ParameterTo<u16&>(dst, ins.GetSegment()) = offset;
+}
+
+void CPU::MOV(const Instruction& ins)
+{
+  auto& dst = ins.GetParameters()[0];
+  auto& src = ins.GetParameters()[1];
+
+  if (dst.IsWord()) {
+    WriteParameter<u16>(dst, ins.GetSegment(),
+                        ParameterTo<u16>(src, ins.GetSegment()));
+  } else {
+    WriteParameter<u8>(dst, ins.GetSegment(),
+                       ParameterTo<u8>(src, ins.GetSegment()));
+  }
+}
+
+void CPU::PUSH(const Instruction& ins)
+{
+  auto& data = ins.GetParameters()[0];
+
+  u16 data16 = ParameterTo<u16>(data, ins.GetSegment());
+
+  SP -= sizeof(u16);
+  Memory::Write<u16>(SS, SP, data16);
+}
+
+void CPU::PUSHF(const Instruction&)
+{
+  u16 eflags = static_cast<u16>(CF) | (1 << 1) | (static_cast<u16>(PF) << 2) |
+               (static_cast<u16>(AF) << 4) | (static_cast<u16>(ZF) << 6) |
+               (static_cast<u16>(SF) << 7) | (/*TF*/ 0 << 8) |
+               (static_cast<u16>(IF) << 9) | (static_cast<u16>(DF) << 10) |
+               (static_cast<u16>(OF) << 11) | (1 << 14) | (1 << 15);
+
+  SP -= sizeof(u16);
+  Memory::Write<u16>(SS, SP, eflags);
+}
+
+void CPU::POPF(const Instruction&)
+{
+  u16 eflags = Memory::Read<u16>(SS, SP);
+
+  CF = eflags & 1;
+  PF = eflags & (1 << 2);
+  AF = eflags & (1 << 4);
+  ZF = eflags & (1 << 6);
+  SF = eflags & (1 << 7);
+  // TF = eflags & (1 << 8);
+  IF = eflags & (1 << 9);
+  DF = eflags & (1 << 10);
+  OF = eflags & (1 << 11);
+
+  SP -= sizeof(u16);
+}
+
+void CPU::POP(const Instruction& ins)
+{
+  auto& dst = ins.GetParameters()[0];
+
+  WriteParameter<u16>(dst, ins.GetSegment(), Memory::Read<u16>(SS, SP));
+  SP += sizeof(u16);
+}
+
+void CPU::XCHG(const Instruction& ins)
+{
+  auto& dst = ins.GetParameters()[0];
+  auto& src = ins.GetParameters()[1];
+
+  if (dst.IsWord()) {
+    const u16 dst16 = ParameterTo<u16>(dst, ins.GetSegment());
+    const u16 src16 = ParameterTo<u16>(src, ins.GetSegment());
+    WriteParameter<u16>(dst, ins.GetSegment(), src16);
+    WriteParameter<u16>(src, ins.GetSegment(), dst16);
+  } else {
+    const u8 dst8 = ParameterTo<u8>(dst, ins.GetSegment());
+    const u8 src8 = ParameterTo<u8>(src, ins.GetSegment());
+    WriteParameter<u8>(dst, ins.GetSegment(), src8);
+    WriteParameter<u8>(src, ins.GetSegment(), dst8);
+  }
+}
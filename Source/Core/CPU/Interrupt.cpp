@@ -22,5 +22,5 @@ void CPU::CallInterrupt(u8 vector)
     return;
 
   LOG("Unhandled interrupt vector " + String::ToHex(vector));
-  throw UnhandledInterruptException();
+  RaiseFault(FaultKind::UnhandledInterrupt, UnhandledInterruptException());
 }
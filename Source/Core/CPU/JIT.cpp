@@ -0,0 +1,1091 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/JIT.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <exception>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Common/Logger.h"
+#include "Common/String.h"
+#include "Core/CPU/Breakpoint.h"
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/CodeBytes.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/Exception.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/Watchpoint.h"
+#include "Core/Memory.h"
+
+// Translated code calls the instruction handlers using the System V calling
+// convention, so only x86-64 hosts other than Windows are supported
+#if defined(__x86_64__) && !defined(_WIN32)
+#define APE_JIT_X64
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Core::CPU
+{
+bool use_jit = false;
+bool jit_lockstep = false;
+
+namespace
+{
+using Type = Instruction::Type;
+using PType = Instruction::Parameter::Type;
+
+//! How often a block has to be reached before it gets translated
+constexpr u8 HOT_THRESHOLD = 16;
+//! Upper limit of guest instructions in a single block
+constexpr size_t MAX_BLOCK_INSTRUCTIONS = 64;
+//! Blocks entered per ExecuteBlock() call before returning to the caller
+constexpr u32 BLOCK_BUDGET = 256;
+//! Direct jumps to other blocks each block can be patched with
+constexpr size_t LINK_COUNT = 2;
+
+constexpr size_t ARENA_SIZE = 16 * 1024 * 1024;
+//! Generous upper bound for the host code of one block
+constexpr size_t MAX_BLOCK_CODE = 8 * 1024;
+
+constexpr u32 LOOKUP_SIZE = 1 << 16;
+
+struct Block;
+
+//! Patchable exit comparing CS:IP against the start of another block
+struct Link {
+  u8* segment = nullptr;
+  u8* offset = nullptr;
+  u8* jump = nullptr;
+  Block* target = nullptr;
+};
+
+struct Block {
+  u16 segment = 0;
+  u16 offset = 0;
+  //! Physical address of the first byte
+  u32 address = 0;
+  bool valid = true;
+  //! Whether the exit may be patched to jump straight into the next block
+  bool chainable = false;
+
+  //! Referenced by the host code, so never resized after translation
+  std::vector<Instruction> instructions;
+  //! Cycles of all instructions, charged up front like the instruction count
+  u32 cycles = 0;
+
+  u8* entry = nullptr;
+  u8* body = nullptr;
+  u8* exit = nullptr;
+  //! Bytes of host code starting at entry
+  size_t code_size = 0;
+
+  std::array<Link, LINK_COUNT> links;
+  //! Links of other blocks jumping here
+  std::vector<std::pair<Block*, u8>> incoming;
+};
+
+std::unordered_map<Block*, std::unique_ptr<Block>> s_blocks;
+//! Invalidated blocks, which may still be running until control returns to
+//! ExecuteBlock(). Their host code is freed before the next translation
+std::vector<Block*> s_retired;
+std::array<Block*, LOOKUP_SIZE> s_lookup{};
+std::array<u8, LOOKUP_SIZE> s_heat{};
+std::array<std::vector<Block*>, Memory::PAGE_COUNT> s_page_blocks;
+CodeBytes s_translated_bytes;
+
+u8* s_arena = nullptr;
+size_t s_arena_used = 0;
+//! Freed ranges of the arena below s_arena_used by start, never adjacent
+std::map<u8*, size_t> s_arena_free;
+
+// State shared with the translated code
+u32 s_budget = 0;
+bool s_exit_requested = false;
+Block* s_exit_block = nullptr;
+const Instruction* s_exit_instruction = nullptr;
+//! Instructions retired since Enter(), including ones that were left early
+u64 s_retired_instructions = 0;
+std::exception_ptr s_exception;
+
+JITStats s_stats;
+
+u32 LookupIndex(u16 segment, u16 offset)
+{
+  return Memory::VirtToPhys(segment, offset) % LOOKUP_SIZE;
+}
+
+Block* Lookup(u16 segment, u16 offset)
+{
+  Block* block = s_lookup[LookupIndex(segment, offset)];
+
+  if (block != nullptr && block->segment == segment && block->offset == offset)
+    return block;
+
+  return nullptr;
+}
+
+// Handlers record faults instead of throwing, anything else they throw can't
+// unwind through translated code. It gets parked here and rethrown once the
+// block returned.
+u8 CallHandler(Instruction::Handler handler, const Instruction* ins) noexcept
+{
+  try {
+    handler(*ins);
+  } catch (...) {
+    s_exception = std::current_exception();
+    s_exit_instruction = ins;
+    return 1;
+  }
+
+  if (s_exit_requested || HasFault()) {
+    s_exit_instruction = ins;
+    return 1;
+  }
+
+  return 0;
+}
+
+bool EndsBlock(const Instruction& ins)
+{
+  switch (ins.GetType()) {
+  case Type::JMP:
+  case Type::JZ:
+  case Type::JNZ:
+  case Type::JC:
+  case Type::JNC:
+  case Type::JCXZ:
+  case Type::JPE:
+  case Type::JNS:
+  case Type::JNO:
+  case Type::JNE:
+  case Type::JL:
+  case Type::JLE:
+  case Type::JG:
+  case Type::JGE:
+  case Type::JA:
+  case Type::JB:
+  case Type::JNB:
+  case Type::JPO:
+  case Type::JO:
+  case Type::JS:
+  case Type::JBE:
+  case Type::CALL:
+  case Type::RET:
+  case Type::IRET:
+  case Type::RETF:
+  case Type::HLT:
+  case Type::LOOPNZ:
+  case Type::LOOPZ:
+  case Type::LOOP:
+  case Type::INT:
+  case Type::INTO:
+    return true;
+  default:
+    // Following instructions would have to be fetched from another segment
+    return ins.GetParameterCount() > 0 &&
+           ins.GetParameters()[0].GetType() == PType::CS;
+  }
+}
+
+// Interrupts may stop the CPU, so control has to go back to the main loop
+bool EndsChainable(const Instruction& ins)
+{
+  switch (ins.GetType()) {
+  case Type::HLT:
+  case Type::INT:
+  case Type::INTO:
+  case Type::IRET:
+    return false;
+  default:
+    return true;
+  }
+}
+
+void* RegisterAddress(PType type)
+{
+  switch (type) {
+  case PType::AL:
+    return &AL;
+  case PType::AH:
+    return &AH;
+  case PType::BL:
+    return &BL;
+  case PType::BH:
+    return &BH;
+  case PType::CL:
+    return &CL;
+  case PType::CH:
+    return &CH;
+  case PType::DL:
+    return &DL;
+  case PType::DH:
+    return &DH;
+  case PType::AX:
+    return &AX;
+  case PType::BX:
+    return &BX;
+  case PType::CX:
+    return &CX;
+  case PType::DX:
+    return &DX;
+  case PType::DS:
+    return &DS;
+  case PType::ES:
+    return &ES;
+  case PType::SS:
+    return &SS;
+  case PType::BP:
+    return &BP;
+  case PType::SP:
+    return &SP;
+  case PType::DI:
+    return &DI;
+  case PType::SI:
+    return &SI;
+  default:
+    return nullptr;
+  }
+}
+
+bool IsImmediate(PType type)
+{
+  return type == PType::Literal_Byte || type == PType::Literal_Byte_Immediate ||
+         type == PType::Literal_Word || type == PType::Literal_Word_Immediate;
+}
+
+#ifdef APE_JIT_X64
+//! Minimal x86-64 assembler, only knows the forms used below
+class Emitter
+{
+public:
+  explicit Emitter(u8* code) : m_cursor(code) {}
+
+  u8* GetCursor() const { return m_cursor; }
+
+  void Bytes(std::initializer_list<u8> bytes)
+  {
+    for (u8 byte : bytes)
+      *m_cursor++ = byte;
+  }
+
+  template <typename T> u8* Value(T value)
+  {
+    u8* location = m_cursor;
+
+    std::memcpy(m_cursor, &value, sizeof(T));
+    m_cursor += sizeof(T);
+
+    return location;
+  }
+
+  //! mov rax, address
+  void LoadAddress(const void* address)
+  {
+    Bytes({0x48, 0xB8});
+    Value(reinterpret_cast<u64>(address));
+  }
+
+  //! mov word [address], value
+  void StoreWord(const void* address, u16 value)
+  {
+    LoadAddress(address);
+    Bytes({0x66, 0xC7, 0x00});
+    Value(value);
+  }
+
+  //! mov byte [address], value
+  void StoreByte(const void* address, u8 value)
+  {
+    LoadAddress(address);
+    Bytes({0xC6, 0x00});
+    Value(value);
+  }
+
+  //! add qword [address], value
+  void AddQuad(const void* address, u32 value)
+  {
+    LoadAddress(address);
+    Bytes({0x48, 0x81, 0x00});
+    Value(value);
+  }
+
+  //! mov cx, word [src]; mov word [dst], cx
+  void CopyWord(const void* dst, const void* src)
+  {
+    LoadAddress(src);
+    Bytes({0x66, 0x8B, 0x08});
+    LoadAddress(dst);
+    Bytes({0x66, 0x89, 0x08});
+  }
+
+  //! mov cl, byte [src]; mov byte [dst], cl
+  void CopyByte(const void* dst, const void* src)
+  {
+    LoadAddress(src);
+    Bytes({0x8A, 0x08});
+    LoadAddress(dst);
+    Bytes({0x88, 0x08});
+  }
+
+  //! cmp word [address], 0. Returns the location of the immediate
+  u8* CompareWord(const void* address)
+  {
+    LoadAddress(address);
+    Bytes({0x66, 0x81, 0x38});
+    return Value<u16>(0);
+  }
+
+  //! call CallHandler(handler, ins); test al, al; jnz <returned>
+  u8* CallHandler(const Instruction& ins)
+  {
+    Bytes({0x48, 0xBF});
+    Value(reinterpret_cast<u64>(ins.GetHandler()));
+    Bytes({0x48, 0xBE});
+    Value(reinterpret_cast<u64>(&ins));
+    LoadAddress(reinterpret_cast<const void*>(&Core::CPU::CallHandler));
+    Bytes({0xFF, 0xD0, 0x84, 0xC0});
+    return JumpIfNotZero();
+  }
+
+  //! Conditional and unconditional rel32 jumps. Return the location of the
+  //! displacement so it can be patched later
+  u8* Jump()
+  {
+    Bytes({0xE9});
+    return Value<u32>(0);
+  }
+
+  u8* JumpIfNotZero()
+  {
+    Bytes({0x0F, 0x85});
+    return Value<u32>(0);
+  }
+
+  u8* JumpIfBelow()
+  {
+    Bytes({0x0F, 0x82});
+    return Value<u32>(0);
+  }
+
+  static void Patch(u8* displacement, const u8* target)
+  {
+    const i32 value = static_cast<i32>(target - (displacement + 4));
+    std::memcpy(displacement, &value, sizeof(value));
+  }
+
+  static void PatchWord(u8* location, u16 value)
+  {
+    std::memcpy(location, &value, sizeof(value));
+  }
+
+private:
+  u8* m_cursor;
+};
+
+u8* MapArena()
+{
+  void* arena = mmap(nullptr, ARENA_SIZE, PROT_READ | PROT_EXEC,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (arena == MAP_FAILED) {
+    WARN("Failed to map memory for the JIT, falling back to the interpreter");
+    return nullptr;
+  }
+
+  return static_cast<u8*>(arena);
+}
+
+u8* GetArena()
+{
+  static u8* arena = MapArena();
+  return arena;
+}
+
+/**
+ * @brief The arena is never writable and executable at the same time. Writes
+ * to it go through this, which makes the host pages covering [begin, begin +
+ * size) writable for as long as it's around. Translated code only runs again
+ * once it's gone, so that may include the pages of the running block
+ */
+class ArenaWriter
+{
+public:
+  ArenaWriter(u8* begin, size_t size)
+  {
+    static const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+
+    const uintptr_t start = reinterpret_cast<uintptr_t>(begin);
+    const uintptr_t end = start + size;
+
+    m_begin = reinterpret_cast<void*>(start & ~(page_size - 1));
+    m_size = ((end + page_size - 1) & ~(page_size - 1)) -
+             reinterpret_cast<uintptr_t>(m_begin);
+
+    if (mprotect(m_begin, m_size, PROT_READ | PROT_WRITE) != 0)
+      ERROR("Failed to make JIT code writable");
+  }
+
+  ~ArenaWriter()
+  {
+    if (mprotect(m_begin, m_size, PROT_READ | PROT_EXEC) != 0)
+      ERROR("Failed to make JIT code executable");
+  }
+
+  ArenaWriter(const ArenaWriter&) = delete;
+  ArenaWriter& operator=(const ArenaWriter&) = delete;
+
+private:
+  void* m_begin;
+  size_t m_size;
+};
+
+//! First fit from the freed ranges, then from the end. nullptr if full
+u8* AllocateCode(size_t size)
+{
+  for (auto it = s_arena_free.begin(); it != s_arena_free.end(); ++it) {
+    auto [start, free] = *it;
+
+    if (free < size)
+      continue;
+
+    s_arena_free.erase(it);
+
+    if (free > size)
+      s_arena_free.emplace(start + size, free - size);
+
+    return start;
+  }
+
+  if (s_arena_used + size > ARENA_SIZE)
+    return nullptr;
+
+  u8* start = s_arena + s_arena_used;
+  s_arena_used += size;
+
+  return start;
+}
+
+void FreeCode(u8* start, size_t size)
+{
+  auto next = s_arena_free.lower_bound(start);
+
+  if (next != s_arena_free.end() && start + size == next->first) {
+    size += next->second;
+    next = s_arena_free.erase(next);
+  }
+
+  if (next != s_arena_free.begin()) {
+    auto previous = std::prev(next);
+
+    if (previous->first + previous->second == start) {
+      start = previous->first;
+      size += previous->second;
+      s_arena_free.erase(previous);
+    }
+  }
+
+  // Give ranges at the end back to the bump allocator
+  if (start + size == s_arena + s_arena_used)
+    s_arena_used -= size;
+  else
+    s_arena_free.emplace(start, size);
+}
+
+bool EmitMove(Emitter& e, const Instruction& ins)
+{
+  const auto& dst = ins.GetParameters()[0];
+  const auto& src = ins.GetParameters()[1];
+
+  void* dst_address = RegisterAddress(dst.GetType());
+
+  if (ins.GetParameterCount() != 2 || dst_address == nullptr ||
+      dst.IsWord() != src.IsWord())
+    return false;
+
+  if (IsImmediate(src.GetType())) {
+    if (dst.IsWord())
+      e.StoreWord(dst_address, src.GetData<u16>());
+    else
+      e.StoreByte(dst_address, src.GetData<u8>());
+
+    return true;
+  }
+
+  void* src_address = RegisterAddress(src.GetType());
+
+  if (src_address == nullptr)
+    return false;
+
+  if (dst.IsWord())
+    e.CopyWord(dst_address, src_address);
+  else
+    e.CopyByte(dst_address, src_address);
+
+  return true;
+}
+
+// Instructions simple enough to not need their handler. Neither of them reads
+// IP or can fault, so IP only has to be up to date at the end of the block
+bool EmitInline(Emitter& e, const Instruction& ins)
+{
+  // The arithmetic flags live in LazyFlagState, so CLC, STC and CMC go
+  // through their handlers
+  switch (ins.GetType()) {
+  case Type::CLD:
+    e.StoreByte(&DF, false);
+    return true;
+  case Type::STD:
+    e.StoreByte(&DF, true);
+    return true;
+  case Type::CLI:
+    e.StoreByte(&IF, false);
+    return true;
+  case Type::STI:
+    e.StoreByte(&IF, true);
+    return true;
+  case Type::NOP:
+    return true;
+  case Type::MOV:
+    return EmitMove(e, ins);
+  default:
+    return false;
+  }
+}
+
+// Emits into scratch memory, see Install()
+void Emit(Block& block, u8* code)
+{
+  Emitter e(code);
+  std::vector<u8*> exits;
+
+  block.entry = e.GetCursor();
+  // Keep the stack 16 byte aligned for the calls
+  e.Bytes({0x48, 0x83, 0xEC, 0x08});
+
+  // Chained blocks jump here
+  block.body = e.GetCursor();
+  e.LoadAddress(&s_budget);
+  e.Bytes({0x83, 0x28, 0x01});
+  exits.push_back(e.JumpIfBelow());
+
+  e.AddQuad(&s_retired_instructions,
+            static_cast<u32>(block.instructions.size()));
+  e.AddQuad(&cycles, block.cycles);
+  e.StoreWord(&LAST_CS, block.segment);
+
+  u16 offset = block.offset;
+  bool inlined = false;
+
+  for (const auto& ins : block.instructions) {
+    const u16 next = offset + ins.GetSize();
+
+    inlined = EmitInline(e, ins);
+
+    if (!inlined) {
+      e.StoreWord(&LAST_IP, offset);
+      e.StoreWord(&IP, next);
+      exits.push_back(e.CallHandler(ins));
+    }
+
+    offset = next;
+  }
+
+  if (inlined) {
+    e.StoreWord(&LAST_IP, offset - block.instructions.back().GetSize());
+    e.StoreWord(&IP, offset);
+  }
+
+  if (block.chainable) {
+    for (auto& link : block.links) {
+      link.segment = e.CompareWord(&CS);
+      u8* mismatch_segment = e.JumpIfNotZero();
+      link.offset = e.CompareWord(&IP);
+      u8* mismatch_offset = e.JumpIfNotZero();
+      link.jump = e.Jump();
+
+      exits.push_back(link.jump);
+      Emitter::Patch(mismatch_segment, e.GetCursor());
+      Emitter::Patch(mismatch_offset, e.GetCursor());
+    }
+  }
+
+  block.exit = e.GetCursor();
+  e.LoadAddress(&s_exit_block);
+  e.Bytes({0x48, 0xB9});
+  e.Value(reinterpret_cast<u64>(&block));
+  e.Bytes({0x48, 0x89, 0x08, 0x48, 0x83, 0xC4, 0x08, 0xC3});
+
+  for (u8* exit : exits)
+    Emitter::Patch(exit, block.exit);
+
+  block.code_size = e.GetCursor() - block.entry;
+}
+
+// Moves the code of a block emitted at scratch into the arena. The block only
+// jumps within itself yet and all of those jumps are relative, so only the
+// pointers into it change. Returns false if the arena is full
+bool Install(Block& block, const u8* scratch)
+{
+  u8* code = AllocateCode(block.code_size);
+
+  if (code == nullptr)
+    return false;
+
+  {
+    ArenaWriter writer(code, block.code_size);
+    std::memcpy(code, scratch, block.code_size);
+  }
+
+  const std::ptrdiff_t delta = code - scratch;
+
+  block.entry += delta;
+  block.body += delta;
+  block.exit += delta;
+
+  for (auto& link : block.links) {
+    if (link.jump == nullptr)
+      continue;
+
+    link.segment += delta;
+    link.offset += delta;
+    link.jump += delta;
+  }
+
+  return true;
+}
+
+void Unlink(Block& block, u8 index)
+{
+  Link& link = block.links[index];
+  ArenaWriter writer(link.jump, sizeof(u32));
+
+  link.target = nullptr;
+  Emitter::Patch(link.jump, block.exit);
+}
+
+void Chain(Block& from, Block& to)
+{
+  for (u8 i = 0; i < LINK_COUNT; i++) {
+    Link& link = from.links[i];
+
+    if (link.target != nullptr)
+      continue;
+
+    ArenaWriter writer(link.segment, link.jump + sizeof(u32) - link.segment);
+
+    Emitter::PatchWord(link.segment, to.segment);
+    Emitter::PatchWord(link.offset, to.offset);
+    Emitter::Patch(link.jump, to.body);
+
+    link.target = &to;
+    to.incoming.emplace_back(&from, i);
+    s_stats.links++;
+
+    return;
+  }
+}
+#endif
+
+void Invalidate(Block& block)
+{
+  block.valid = false;
+
+  auto& entry = s_lookup[LookupIndex(block.segment, block.offset)];
+
+  if (entry == &block)
+    entry = nullptr;
+
+#ifdef APE_JIT_X64
+  for (const auto& [from, link] : block.incoming) {
+    if (from->valid && from->links[link].target == &block)
+      Unlink(*from, link);
+  }
+#endif
+
+  block.incoming.clear();
+
+  // Nothing may point at the block anymore once it's freed
+  for (auto& link : block.links) {
+    if (link.target == nullptr)
+      continue;
+
+    auto& incoming = link.target->incoming;
+    incoming.erase(std::remove_if(incoming.begin(), incoming.end(),
+                                  [&block](const auto& from) {
+                                    return from.first == &block;
+                                  }),
+                   incoming.end());
+
+    link.target = nullptr;
+  }
+
+  s_retired.push_back(&block);
+}
+
+#ifdef APE_JIT_X64
+// Only safe while no translated code is running
+void Reclaim()
+{
+  for (Block* block : s_retired) {
+    FreeCode(block->entry, block->code_size);
+    s_blocks.erase(block);
+    s_stats.reclaimed++;
+  }
+
+  s_retired.clear();
+}
+#endif
+
+void InvalidatePage(u32 page)
+{
+  for (Block* block : s_page_blocks[page])
+    Invalidate(*block);
+
+  s_page_blocks[page].clear();
+  s_translated_bytes.ClearPage(page);
+
+  Memory::page_flags[page] &= ~Memory::PAGE_FLAG_TRANSLATED;
+  s_stats.invalidations++;
+
+  // The running block might just have been overwritten
+  s_exit_requested = true;
+}
+
+Block* Translate(u16 segment, u16 offset)
+{
+#ifdef APE_JIT_X64
+  Reclaim();
+
+  const u32 address = Memory::VirtToPhys(segment, offset);
+  const u32 page = address >> Memory::PAGE_SHIFT;
+
+  auto block = std::make_unique<Block>();
+  block->segment = segment;
+  block->offset = offset;
+  block->address = address;
+
+  u32 size = 0;
+
+  while (block->instructions.size() < MAX_BLOCK_INSTRUCTIONS) {
+    const u32 start = address + size;
+
+    if (offset + size >= 0x10000 || start >> Memory::PAGE_SHIFT != page)
+      break;
+
+    Instruction ins;
+
+    // Let the interpreter report whatever is wrong with it
+    try {
+      ins = DecodeInstruction(segment, static_cast<u16>(offset + size));
+    } catch (const CPUException&) {
+      break;
+    }
+
+    const u32 end = start + ins.GetSize() - 1;
+
+    if (offset + size + ins.GetSize() > 0x10000 ||
+        end >> Memory::PAGE_SHIFT != page || !HasHandler(ins))
+      break;
+
+    block->instructions.push_back(ins);
+    block->cycles += ins.GetCycles();
+    size += ins.GetSize();
+
+    if (EndsBlock(ins))
+      break;
+  }
+
+  if (block->instructions.empty())
+    return nullptr;
+
+  block->chainable = EndsChainable(block->instructions.back());
+
+  static std::array<u8, MAX_BLOCK_CODE> scratch;
+  Emit(*block, scratch.data());
+
+  if (!Install(*block, scratch.data())) {
+    FlushTranslations();
+    s_stats.flushes++;
+
+    if (!Install(*block, scratch.data()))
+      return nullptr;
+  }
+
+  s_translated_bytes.Mark(address, size);
+
+  Memory::page_flags[page] |= Memory::PAGE_FLAG_TRANSLATED;
+  s_page_blocks[page].push_back(block.get());
+  s_lookup[LookupIndex(segment, offset)] = block.get();
+  s_stats.translations++;
+
+  Block* translated = block.get();
+  s_blocks.emplace(translated, std::move(block));
+
+  return translated;
+#else
+  (void)segment;
+  (void)offset;
+  return nullptr;
+#endif
+}
+
+//! Run a block and whatever it chains into. Returns the instructions retired
+u32 Enter(const Block& block, u32 budget)
+{
+  s_budget = budget;
+  s_retired_instructions = 0;
+  s_exit_requested = false;
+  s_exit_block = nullptr;
+  s_exit_instruction = nullptr;
+
+  reinterpret_cast<void (*)()>(block.entry)();
+
+  // The budget underflows when a chained block refused to start
+  const u32 entered =
+      s_budget == std::numeric_limits<u32>::max() ? budget : budget - s_budget;
+  s_stats.executions += entered;
+
+  // Don't count the instructions skipped by leaving early
+  if (s_exit_instruction != nullptr && s_exit_block != nullptr) {
+    const auto& instructions = s_exit_block->instructions;
+    s_retired_instructions -=
+        instructions.data() + instructions.size() - s_exit_instruction - 1;
+
+    for (const Instruction* skipped = s_exit_instruction + 1;
+         skipped != instructions.data() + instructions.size(); skipped++)
+      cycles -= skipped->GetCycles();
+  }
+
+  s_stats.instructions += s_retired_instructions;
+
+  if (s_exception) {
+    std::exception_ptr exception = s_exception;
+    s_exception = nullptr;
+    std::rethrow_exception(exception);
+  }
+
+  return static_cast<u32>(s_retired_instructions);
+}
+
+struct Registers {
+  std::array<u16, 15> words;
+  std::array<bool, 8> flags;
+  LazyFlagState lazy_flags;
+};
+
+constexpr std::array<const char*, 15> WORD_NAMES = {
+    "AX", "BX", "CX", "DX", "SI", "DI", "BP", "SP",
+    "CS", "DS", "ES", "SS", "IP", "LAST_CS", "LAST_IP"};
+constexpr std::array<const char*, 8> FLAG_NAMES = {"AF", "CF", "IF", "DF",
+                                                   "OF", "PF", "SF", "ZF"};
+
+std::array<u16*, 15> WordRegisters()
+{
+  return {&AX, &BX, &CX, &DX, &SI, &DI, &BP,      &SP,
+          &CS, &DS, &ES, &SS, &IP, &LAST_CS, &LAST_IP};
+}
+
+Registers SaveRegisters()
+{
+  Registers registers;
+
+  const auto words = WordRegisters();
+
+  for (size_t i = 0; i < words.size(); i++)
+    registers.words[i] = *words[i];
+
+  // Saved before reading the flags, which would materialize them
+  registers.lazy_flags = lazy_flags;
+  registers.flags = {AF, CF, IF, DF, OF, PF, SF, ZF};
+
+  return registers;
+}
+
+void RestoreRegisters(const Registers& registers)
+{
+  const auto words = WordRegisters();
+
+  for (size_t i = 0; i < words.size(); i++)
+    *words[i] = registers.words[i];
+
+  // Same order as FLAG_NAMES
+  lazy_flags = registers.lazy_flags;
+  IF = registers.flags[2];
+  DF = registers.flags[3];
+}
+
+// Runs the block on its own, replays the same instructions through the
+// interpreter from the same starting state and compares the results
+void ExecuteLockstep(const Block& block)
+{
+  const Registers before = SaveRegisters();
+  const auto& memory = Memory::Get();
+  const std::vector<u8> memory_before(memory.begin(), memory.end());
+  const u64 cycles_before = cycles;
+
+  Enter(block, 1);
+
+  // Nothing to compare against, the interpreter would stop at the same fault
+  if (HasFault())
+    return;
+
+  size_t retired = block.instructions.size();
+
+  if (s_exit_requested && s_exit_instruction != nullptr)
+    retired = s_exit_instruction - block.instructions.data() + 1;
+
+  const Registers translated = SaveRegisters();
+  const std::vector<u8> memory_translated(memory.begin(), memory.end());
+  const u64 cycles_translated = cycles;
+
+  RestoreRegisters(before);
+  std::copy(memory_before.begin(), memory_before.end(), Memory::Get().begin());
+  cycles = cycles_before;
+
+  for (size_t i = 0; i < retired; i++) {
+    if (Step() == RunStatus::Fault)
+      return;
+  }
+
+  const Registers interpreted = SaveRegisters();
+
+  for (size_t i = 0; i < WORD_NAMES.size(); i++) {
+    if (translated.words[i] != interpreted.words[i]) {
+      RaiseFault(FaultKind::JITMismatch,
+                 JITMismatchException(
+                     block.segment, block.offset,
+                     std::string(WORD_NAMES[i]) + " is " +
+                         String::ToHex(translated.words[i]) + " instead of " +
+                         String::ToHex(interpreted.words[i])));
+      return;
+    }
+  }
+
+  for (size_t i = 0; i < FLAG_NAMES.size(); i++) {
+    if (translated.flags[i] != interpreted.flags[i]) {
+      RaiseFault(FaultKind::JITMismatch,
+                 JITMismatchException(block.segment, block.offset,
+                                      std::string(FLAG_NAMES[i]) + " is " +
+                                          std::to_string(translated.flags[i]) +
+                                          " instead of " +
+                                          std::to_string(interpreted.flags[i])));
+      return;
+    }
+  }
+
+  if (cycles_translated != cycles) {
+    RaiseFault(FaultKind::JITMismatch,
+               JITMismatchException(
+                   block.segment, block.offset,
+                   "Cycles are " + std::to_string(cycles_translated) +
+                       " instead of " + std::to_string(cycles)));
+    return;
+  }
+
+  if (std::equal(memory.begin(), memory.end(), memory_translated.begin()))
+    return;
+
+  for (u32 i = 0; i < memory.size(); i++) {
+    if (memory[i] != memory_translated[i]) {
+      RaiseFault(FaultKind::JITMismatch,
+                 JITMismatchException(
+                     block.segment, block.offset,
+                     "Memory at " + String::ToHex(i) + " is " +
+                         String::ToHex(memory_translated[i]) + " instead of " +
+                         String::ToHex(memory[i])));
+      return;
+    }
+  }
+}
+} // namespace
+
+bool IsJITAvailable()
+{
+#ifdef APE_JIT_X64
+  if (s_arena == nullptr)
+    s_arena = GetArena();
+
+  return s_arena != nullptr;
+#else
+  return false;
+#endif
+}
+
+u32 ExecuteBlock()
+{
+  if (!use_jit || !IsJITAvailable() || HasBreakpoints() || HasWatchpoints())
+    return 0;
+
+  Block* block = Lookup(CS, IP);
+
+  if (block == nullptr) {
+    u8& heat = s_heat[LookupIndex(CS, IP)];
+
+    if (++heat < HOT_THRESHOLD)
+      return 0;
+
+    heat = 0;
+    block = Translate(CS, IP);
+
+    if (block == nullptr)
+      return 0;
+  }
+
+  // The interpreter replaying the block leaves the count alone
+  if (jit_lockstep) {
+    ExecuteLockstep(*block);
+    return static_cast<u32>(s_retired_instructions);
+  }
+
+  const u32 retired = Enter(*block, BLOCK_BUDGET);
+
+#ifdef APE_JIT_X64
+  // Patch the block that was left last to continue right here next time
+  Block* from = s_exit_block;
+
+  if (from != nullptr && from->valid && from->chainable && !s_exit_requested &&
+      !HasFault() && s_budget != std::numeric_limits<u32>::max()) {
+    if (Block* to = Lookup(CS, IP))
+      Chain(*from, *to);
+  }
+#endif
+
+  return retired;
+}
+
+void InvalidateTranslations(u32 address, u32 size)
+{
+  s_translated_bytes.Invalidate(address, size, InvalidatePage);
+}
+
+void FlushTranslations()
+{
+  for (u32 page = 0; page < Memory::PAGE_COUNT; page++) {
+    s_page_blocks[page].clear();
+    Memory::page_flags[page] &= ~Memory::PAGE_FLAG_TRANSLATED;
+  }
+
+  s_translated_bytes.Clear();
+  s_lookup.fill(nullptr);
+  s_heat.fill(0);
+  s_blocks.clear();
+  s_retired.clear();
+  s_arena_free.clear();
+  s_arena_used = 0;
+}
+
+JITStats GetJITStats() { return s_stats; }
+
+void ResetJITStats() { s_stats = {}; }
+} // namespace Core::CPU
@@ -0,0 +1,61 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include "Common/Types.h"
+
+namespace Core::CPU
+{
+//! Whether hot basic blocks get translated to host code
+extern bool use_jit;
+
+/**
+ * @brief Run every translated block through the interpreter as well and
+ * compare registers, flags and memory afterwards. Very slow, meant for tests
+ * and for hunting down translation bugs
+ */
+extern bool jit_lockstep;
+
+struct JITStats {
+  //! Basic blocks translated to host code
+  u64 translations = 0;
+  //! Translated blocks entered (including chained ones)
+  u64 executions = 0;
+  //! Guest instructions run as host code
+  u64 instructions = 0;
+  //! Direct jumps patched between translated blocks
+  u64 links = 0;
+  //! Pages whose translations were dropped because they were written to
+  u64 invalidations = 0;
+  //! Dropped blocks whose host code was freed for reuse
+  u64 reclaimed = 0;
+  //! Times the whole code arena was thrown away because it ran full
+  u64 flushes = 0;
+};
+
+//! Whether this build and host can run translated code at all
+bool IsJITAvailable();
+
+/**
+ * @brief Run translated code starting at CS:IP, translating the block first if
+ * it got hot. Chained blocks keep running until a small budget is used up.
+ * @return Instructions retired, 0 if nothing was executed, in which case the
+ * caller should Tick() instead. Faults stop the block early, see RaiseFault()
+ */
+u32 ExecuteBlock();
+
+/**
+ * @brief Called when physical memory got written to. Drops the translations
+ * of all pages in which the range overlaps translated bytes
+ */
+void InvalidateTranslations(u32 address, u32 size);
+
+//! Drop all translations and reset the code arena
+void FlushTranslations();
+
+JITStats GetJITStats();
+void ResetJITStats();
+} // namespace Core::CPU
@@ -0,0 +1,106 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/LazyFlags.h"
+
+#include <type_traits>
+
+namespace Core::CPU
+{
+LazyFlagState lazy_flags;
+
+//! \cond PRIVATE
+// Wrapping a + b, returns whether the (signed or unsigned) result overflowed
+template <typename T> static bool AddOverflows(T a, T b, T& result)
+{
+#if defined(__GNUC__)
+  return __builtin_add_overflow(a, b, &result);
+#else
+  const i32 wide = static_cast<i32>(a) + static_cast<i32>(b);
+  result = static_cast<T>(wide);
+  return wide != result;
+#endif
+}
+
+template <typename T> static bool SubOverflows(T a, T b, T& result)
+{
+#if defined(__GNUC__)
+  return __builtin_sub_overflow(a, b, &result);
+#else
+  const i32 wide = static_cast<i32>(a) - static_cast<i32>(b);
+  result = static_cast<T>(wide);
+  return wide != result;
+#endif
+}
+//! \endcond PRIVATE
+
+// CF and OF of dst + src + carry, or dst - src - borrow. The unsigned sum
+// can't overflow twice, but the signed one may overflow and come back into
+// range, e.g. -128 + -1 + 1.
+template <typename T> static u8 CarryAndOverflow(const LazyFlagState& s)
+{
+  using S = std::make_signed_t<T>;
+
+  const T dst = static_cast<T>(s.dst);
+  const T src = static_cast<T>(s.src);
+  const T carry = s.carry;
+
+  T unsigned_result;
+  S signed_result;
+  bool cf, of;
+
+  if (s.op == FlagOp::Add) {
+    cf = AddOverflows<T>(dst, src, unsigned_result);
+    cf |= AddOverflows<T>(unsigned_result, carry, unsigned_result);
+    of = AddOverflows<S>(dst, src, signed_result);
+    of ^= AddOverflows<S>(signed_result, carry, signed_result);
+  } else {
+    cf = SubOverflows<T>(dst, src, unsigned_result);
+    cf |= SubOverflows<T>(unsigned_result, carry, unsigned_result);
+    of = SubOverflows<S>(dst, src, signed_result);
+    of ^= SubOverflows<S>(signed_result, carry, signed_result);
+  }
+
+  return (cf ? FLAG_CF : 0) | (of ? FLAG_OF : 0);
+}
+
+template <typename T> static u8 Derive(const LazyFlagState& s, u8 mask)
+{
+  u8 flags = 0;
+
+  if (mask & (FLAG_SF | FLAG_ZF | FLAG_PF))
+    flags |= SZPFlags(static_cast<T>(s.result));
+
+  // Logical operations clear CF, OF and AF
+  if (s.op == FlagOp::Logic)
+    return flags;
+
+  if (mask & (FLAG_CF | FLAG_OF))
+    flags |= CarryAndOverflow<T>(s);
+
+  // Carry out of the low nibble
+  if ((s.dst ^ s.src ^ s.result) & 0x10)
+    flags |= FLAG_AF;
+
+  return flags;
+}
+
+void MaterializeFlags(u8 mask)
+{
+  mask &= lazy_flags.pending;
+
+  const u8 flags = lazy_flags.word ? Derive<u16>(lazy_flags, mask)
+                                   : Derive<u8>(lazy_flags, mask);
+
+  SetFlags(mask, flags);
+}
+
+u8 PeekFlags(const LazyFlagState& state)
+{
+  const u8 derived = state.word ? Derive<u16>(state, state.pending)
+                                : Derive<u8>(state, state.pending);
+
+  return (state.values & ~state.pending) | (derived & state.pending);
+}
+} // namespace Core::CPU
@@ -0,0 +1,182 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include <array>
+#include <type_traits>
+
+#include "Common/Types.h"
+
+namespace Core::CPU
+{
+//! Bits of the arithmetic flags within LazyFlagState
+enum LazyFlagBit : u8 {
+  FLAG_CF = 1 << 0,
+  FLAG_PF = 1 << 1,
+  FLAG_AF = 1 << 2,
+  FLAG_ZF = 1 << 3,
+  FLAG_SF = 1 << 4,
+  FLAG_OF = 1 << 5,
+};
+
+constexpr u8 FLAGS_ARITHMETIC =
+    FLAG_CF | FLAG_PF | FLAG_AF | FLAG_ZF | FLAG_SF | FLAG_OF;
+
+//! \cond PRIVATE
+constexpr std::array<u8, 256> MakeSZPTable()
+{
+  std::array<u8, 256> table{};
+
+  for (u32 value = 0; value < table.size(); value++) {
+    u32 bits = 0;
+
+    for (u32 i = 0; i < 8; i++)
+      bits += (value >> i) & 1;
+
+    table[value] = (bits % 2 == 0 ? FLAG_PF : 0) | (value == 0 ? FLAG_ZF : 0) |
+                   (value & 0x80 ? FLAG_SF : 0);
+  }
+
+  return table;
+}
+//! \endcond PRIVATE
+
+//! SF, ZF and PF of every byte
+constexpr std::array<u8, 256> SZP_TABLE = MakeSZPTable();
+
+//! SF, ZF and PF of a result, as LazyFlagBits
+template <typename T> u8 SZPFlags(T value)
+{
+  if constexpr (std::is_same<T, u8>::value) {
+    return SZP_TABLE[value];
+  } else {
+    static_assert(std::is_same<T, u16>::value, "Bad type provided!");
+
+    // PF only ever looks at the low byte
+    return (SZP_TABLE[value & 0xFF] & FLAG_PF) |
+           (SZP_TABLE[value >> 8] & FLAG_SF) | (value == 0 ? FLAG_ZF : 0);
+  }
+}
+
+//! How the pending flags derive from the recorded operands and result
+enum class FlagOp : u8 {
+  //! ADD, ADC and INC
+  Add,
+  //! SUB, SBB, CMP, DEC and NEG
+  Sub,
+  //! AND, OR, XOR and TEST
+  Logic,
+};
+
+/**
+ * @brief Most flag results get overwritten before anything looks at them, so
+ * ALU instructions only record what they did. The flags are derived from
+ * that once they are actually read.
+ */
+struct LazyFlagState {
+  //! Flags that still have to be derived from the recorded operation
+  u8 pending = 0;
+  //! Values of all flags that aren't pending
+  u8 values = 0;
+
+  FlagOp op = FlagOp::Logic;
+  bool word = false;
+  //! Carry that went into ADC or borrow that went into SBB
+  bool carry = false;
+
+  u16 dst = 0;
+  u16 src = 0;
+  u16 result = 0;
+};
+
+extern LazyFlagState lazy_flags;
+
+//! Set the flags in mask at once, e.g. to the result of SZPFlags()
+inline void SetFlags(u8 mask, u8 values)
+{
+  lazy_flags.pending &= ~mask;
+  lazy_flags.values = (lazy_flags.values & ~mask) | (values & mask);
+}
+
+//! Derive the flags in mask that are still pending
+void MaterializeFlags(u8 mask);
+
+/**
+ * @brief All arithmetic flags of state as LazyFlagBits. Unlike reading a
+ * LazyFlag this derives pending ones without writing them back
+ */
+u8 PeekFlags(const LazyFlagState& state);
+
+/**
+ * @brief Record an ALU operation whose flags are derived on demand
+ * @param mask Flags the operation defines, the others keep their value
+ */
+template <typename T>
+void RecordFlags(FlagOp op, T dst, T src, T result, bool carry = false,
+                 u8 mask = FLAGS_ARITHMETIC)
+{
+  static_assert(std::is_same<T, u8>::value || std::is_same<T, u16>::value,
+                "Bad type provided!");
+
+  // Flags left alone may still depend on the operation about to be replaced
+  if (lazy_flags.pending & ~mask)
+    MaterializeFlags(lazy_flags.pending & ~mask);
+
+  lazy_flags.pending = mask;
+  lazy_flags.op = op;
+  lazy_flags.word = std::is_same<T, u16>::value;
+  lazy_flags.carry = carry;
+  lazy_flags.dst = dst;
+  lazy_flags.src = src;
+  lazy_flags.result = result;
+}
+
+//! Arithmetic flag that behaves like a bool, but is backed by LazyFlagState
+template <u8 BIT> class LazyFlag
+{
+public:
+  operator bool() const
+  {
+    // Whatever reads one flag usually reads another one soon, and deriving
+    // all of them costs hardly more than deriving a single one
+    if (lazy_flags.pending & BIT)
+      MaterializeFlags(lazy_flags.pending);
+
+    return lazy_flags.values & BIT;
+  }
+
+  //! Value of the flag without materializing it, for the debugger
+  bool Peek() const
+  {
+    const LazyFlagState state = lazy_flags;
+    return PeekFlags(state) & BIT;
+  }
+
+  LazyFlag& operator=(bool value)
+  {
+    lazy_flags.pending &= ~BIT;
+
+    if (value)
+      lazy_flags.values |= BIT;
+    else
+      lazy_flags.values &= ~BIT;
+
+    return *this;
+  }
+
+  LazyFlag& operator=(const LazyFlag& other)
+  {
+    return *this = static_cast<bool>(other);
+  }
+
+  template <u8 OTHER> LazyFlag& operator=(const LazyFlag<OTHER>& other)
+  {
+    return *this = static_cast<bool>(other);
+  }
+
+  LazyFlag& operator|=(bool value) { return *this = *this || value; }
+};
+} // namespace Core::CPU
@@ -0,0 +1,81 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/Recompiled.h"
+
+#include <bitset>
+
+#include "Common/Logger.h"
+#include "Core/CPU/Breakpoint.h"
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Watchpoint.h"
+#include "Core/Memory.h"
+
+namespace Core::CPU
+{
+static const RecompiledProgram* s_program = nullptr;
+static u16 s_segment = 0;
+static bool s_valid = false;
+
+// Bytes the installed program's instructions were translated from
+static std::bitset<Memory::SIZE> s_recompiled_bytes;
+
+void InstallRecompiledProgram(const RecompiledProgram& program, u16 segment)
+{
+  UninstallRecompiledProgram();
+
+  s_program = &program;
+  s_segment = segment;
+  s_valid = true;
+
+  for (u32 i = 0; i < program.instruction_count; i++) {
+    const u32 address = Memory::VirtToPhys(segment, program.offsets[i]);
+
+    for (u32 k = address; k < address + program.sizes[i]; k++) {
+      const u32 j = k & Memory::ADDRESS_MASK;
+
+      s_recompiled_bytes[j] = true;
+      Memory::page_flags[j >> Memory::PAGE_SHIFT] |=
+          Memory::PAGE_FLAG_RECOMPILED;
+    }
+  }
+}
+
+void UninstallRecompiledProgram()
+{
+  s_program = nullptr;
+  s_valid = false;
+  s_recompiled_bytes.reset();
+
+  for (auto& flags : Memory::page_flags)
+    flags &= ~Memory::PAGE_FLAG_RECOMPILED;
+}
+
+u16 GetRecompiledSegment() { return s_segment; }
+
+bool IsRecompiledCodeValid() { return s_valid; }
+
+u32 ExecuteRecompiled(u32 max_instructions, u64 cycle_limit)
+{
+  if (s_program == nullptr || !s_valid || CS != s_segment || HasBreakpoints() ||
+      HasWatchpoints())
+    return 0;
+
+  return s_program->code(max_instructions, cycle_limit);
+}
+
+void InvalidateRecompiledCode(u32 address, u32 size)
+{
+  for (u32 i = address; i < address + size && i < Memory::SIZE; i++) {
+    if (!s_recompiled_bytes[i])
+      continue;
+
+    // The translation can't tell which of its instructions are still
+    // accurate, so the rest of the program runs in the interpreter
+    LOG("Recompiled code got overwritten, falling back to the interpreter");
+    UninstallRecompiledProgram();
+    return;
+  }
+}
+} // namespace Core::CPU
@@ -0,0 +1,62 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include "Common/Types.h"
+
+namespace Core::CPU
+{
+/**
+ * @brief Native translation of a COM program, emitted by the Recompile tool.
+ * The image still gets loaded and executed by the interpreter whenever the
+ * translation doesn't know how to continue
+ */
+struct RecompiledProgram {
+  //! Contents of the COM file
+  const u8* image;
+  u32 image_size;
+  //! Offsets of the translated instructions within the load segment
+  const u16* offsets;
+  //! Sizes of the translated instructions
+  const u8* sizes;
+  u32 instruction_count;
+  /**
+   * @brief Runs from CS:IP for as long as execution stays within translated
+   * code, until max_instructions got retired, the cycles counter reached
+   * cycle_limit or work is pending for the CPU.
+   * @return Instructions retired, 0 if the instruction at CS:IP has to be
+   * interpreted
+   */
+  u32 (*code)(u32 max_instructions, u64 cycle_limit);
+};
+
+/**
+ * @brief Let ExecuteRecompiled() run the program, whose image has already
+ * been loaded to segment:0100
+ */
+void InstallRecompiledProgram(const RecompiledProgram& program, u16 segment);
+
+void UninstallRecompiledProgram();
+
+//! Segment the installed program got loaded to
+u16 GetRecompiledSegment();
+
+//! Whether the installed program may still run, i.e. none of the instructions
+//! it was translated from got overwritten since
+bool IsRecompiledCodeValid();
+
+/**
+ * @brief Run the installed program's native code at CS:IP, if there is any,
+ * for at most max_instructions and until the cycles counter reaches
+ * cycle_limit
+ * @return Instructions retired, 0 if nothing was executed, in which case the
+ * caller should Tick() instead
+ */
+u32 ExecuteRecompiled(u32 max_instructions, u64 cycle_limit);
+
+//! Called when physical memory got written to
+void InvalidateRecompiledCode(u32 address, u32 size);
+} // namespace Core::CPU
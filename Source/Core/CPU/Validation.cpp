@@ -0,0 +1,236 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/Validation.h"
+
+#include "Common/Logger.h"
+
+#include "Core/CPU/Exception.h"
+
+namespace Core::CPU
+{
+using Type = Instruction::Type;
+using Parameter = Instruction::Parameter;
+using PType = Parameter::Type;
+
+enum class Access { Read, Write };
+
+// Mirrors what ParameterTo<u8> and ParameterTo<u8&> accept
+static void ValidateByte(const Parameter& parameter, Access access)
+{
+  const PType type = parameter.GetType();
+
+  if (parameter.IsWord()) {
+    LOG("[BYTE] Tried to convert a WORD parameter to BYTE for " +
+        parameter.ToString() + "!");
+    throw ParameterLengthMismatchException(parameter);
+  }
+
+  if ((type >= PType::AL && type <= PType::DH) || parameter.IsMemory())
+    return;
+
+  if (access == Access::Read) {
+    switch (type) {
+    case PType::Implied_0:
+    case PType::Implied_1:
+    case PType::Implied_3:
+    case PType::Literal_Byte:
+    case PType::Literal_Byte_Immediate:
+      return;
+    default:
+      break;
+    }
+  }
+
+  LOG("[BYTE] Unknown type: " + ParameterTypeToString(type));
+  throw UnhandledParameterException(parameter);
+}
+
+// Mirrors what ParameterTo<u16> and ParameterTo<u16&> accept
+static void ValidateWord(const Parameter& parameter, Access access)
+{
+  const PType type = parameter.GetType();
+
+  if (!parameter.IsWord())
+    throw ParameterLengthMismatchException(parameter);
+
+  if ((type >= PType::AX && type <= PType::SI) || parameter.IsMemory())
+    return;
+
+  if (access == Access::Read) {
+    switch (type) {
+    case PType::Literal_Word:
+    case PType::Literal_Word_Immediate:
+    case PType::Literal_WordOffset:
+      return;
+    default:
+      break;
+    }
+  }
+
+  LOG("[WORD] Unknown type: " + ParameterTypeToString(type));
+  throw UnhandledParameterException(parameter);
+}
+
+static void Validate(const Parameter& parameter, bool word, Access access)
+{
+  if (word)
+    ValidateWord(parameter, access);
+  else
+    ValidateByte(parameter, access);
+}
+
+static void ValidateSameWidth(const Instruction& ins)
+{
+  const auto& dst = ins.GetParameters()[0];
+  const auto& src = ins.GetParameters()[1];
+
+  if (dst.IsWord() != src.IsWord())
+    throw ParameterLengthMismatchException(ins, dst, src);
+}
+
+// Word operations take byte operands as sign extended bytes
+static void ValidateBinary(const Instruction& ins, Access dst_access)
+{
+  const auto& dst = ins.GetParameters()[0];
+  const auto& src = ins.GetParameters()[1];
+
+  Validate(dst, dst.IsWord(), dst_access);
+  Validate(src, dst.IsWord() && src.IsWord(), Access::Read);
+}
+
+static void ValidateJump(const Parameter& parameter)
+{
+  switch (parameter.GetType()) {
+  case PType::Literal_Offset:
+  case PType::Literal_WordOffset:
+  case PType::Literal_LongAddress_Immediate:
+  case PType::Value_BP_Offset_Word:
+    return;
+  default:
+    LOG("[JMP] Don't know what to do with parameter type: " +
+        ParameterTypeToString(parameter.GetType()));
+    throw UnhandledParameterException(parameter);
+  }
+}
+
+static void ValidateLoop(const Parameter& parameter)
+{
+  if (parameter.GetType() == PType::Literal_Offset)
+    return;
+
+  LOG("[LOOP] Don't know what to do with parameter type: " +
+      ParameterTypeToString(parameter.GetType()));
+  throw UnhandledParameterException(parameter);
+}
+
+void ValidateOperands(const Instruction& ins)
+{
+  const auto& parameters = ins.GetParameters();
+
+  switch (ins.GetType()) {
+  case Type::ADC:
+  case Type::ADD:
+  case Type::AND:
+  case Type::OR:
+  case Type::SBB:
+  case Type::SUB:
+  case Type::XOR:
+    ValidateBinary(ins, Access::Write);
+    break;
+  case Type::CMP:
+  case Type::TEST:
+    ValidateBinary(ins, Access::Read);
+    break;
+  case Type::MOV:
+    ValidateSameWidth(ins);
+    Validate(parameters[0], parameters[0].IsWord(), Access::Write);
+    Validate(parameters[1], parameters[0].IsWord(), Access::Read);
+    break;
+  case Type::XCHG:
+    ValidateSameWidth(ins);
+    Validate(parameters[0], parameters[0].IsWord(), Access::Write);
+    Validate(parameters[1], parameters[0].IsWord(), Access::Write);
+    break;
+  case Type::INC:
+  case Type::DEC:
+  case Type::NEG:
+    Validate(parameters[0], parameters[0].IsWord(), Access::Write);
+    break;
+  case Type::ROL:
+  case Type::ROR:
+  case Type::SHL:
+  case Type::SHR:
+    Validate(parameters[0], parameters[0].IsWord(), Access::Write);
+    ValidateByte(parameters[1], Access::Read);
+    break;
+  case Type::DIV:
+  case Type::IDIV:
+  case Type::MUL:
+  case Type::IMUL:
+    Validate(parameters[0], parameters[0].IsWord(), Access::Read);
+    break;
+  case Type::LDS:
+  case Type::LEA:
+  case Type::LES:
+    ValidateSameWidth(ins);
+
+    if (!parameters[0].IsWord())
+      throw UnsupportedParameterException(ins, parameters[0]);
+
+    // LDS, LEA and LES take the address of their source, registers don't
+    // have one
+    if (!parameters[1].IsMemory())
+      throw UnsupportedParameterException(ins, parameters[1]);
+
+    ValidateWord(parameters[0], Access::Write);
+    break;
+  case Type::PUSH:
+  case Type::POP:
+    if (!parameters[0].IsWord())
+      throw UnsupportedParameterException(ins, parameters[0]);
+
+    ValidateWord(parameters[0], ins.GetType() == Type::PUSH ? Access::Read
+                                                            : Access::Write);
+    break;
+  case Type::CALL:
+    if (parameters[0].GetType() == PType::Literal_LongAddress_Immediate)
+      break;
+
+    if (!parameters[0].IsWord())
+      throw UnsupportedParameterException(ins, parameters[0]);
+
+    ValidateWord(parameters[0], Access::Read);
+    break;
+  case Type::JMP:
+  case Type::JA:
+  case Type::JB:
+  case Type::JBE:
+  case Type::JNB:
+  case Type::JCXZ:
+  case Type::JG:
+  case Type::JGE:
+  case Type::JL:
+  case Type::JLE:
+  case Type::JO:
+  case Type::JNO:
+  case Type::JPE:
+  case Type::JPO:
+  case Type::JS:
+  case Type::JNS:
+  case Type::JZ:
+  case Type::JNZ:
+    ValidateJump(parameters[0]);
+    break;
+  case Type::LOOP:
+  case Type::LOOPNZ:
+    ValidateLoop(parameters[0]);
+    break;
+  default:
+    // Everything else either takes no operands or reads its immediate
+    // directly
+    break;
+  }
+}
+} // namespace Core::CPU
@@ -0,0 +1,20 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include "Core/CPU/Instruction.h"
+
+namespace Core::CPU
+{
+/**
+ * @brief Check that the handler of a decoded instruction can deal with its
+ * operands (their width and kind), so handlers don't have to check them on
+ * every execution
+ * @throws ParameterLengthMismatchException, UnhandledParameterException,
+ * UnsupportedParameterException
+ */
+void ValidateOperands(const Instruction& ins);
+} // namespace Core::CPU
@@ -0,0 +1,209 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Core/CPU/Watchpoint.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include "Core/CPU/CPU.h"
+#include "Core/Memory.h"
+
+namespace Core::CPU
+{
+namespace
+{
+// What the threads adding and removing watchpoints see
+std::mutex s_mutex;
+std::vector<Watchpoint> s_watchpoints;
+std::optional<WatchpointHit> s_last_hit;
+std::atomic<bool> s_changed = false;
+std::atomic<u32> s_count = 0;
+
+// Owned by the CPU thread, which is the only one touching page flags
+struct Watched {
+  Watchpoint watchpoint;
+  //! Contents of the range as of the last check, for WATCH_CHANGE
+  std::vector<u8> contents;
+};
+
+std::vector<Watched> s_watched;
+std::optional<WatchpointHit> s_hit;
+bool s_check_contents = false;
+
+bool Overlaps(const Watchpoint& w, u32 address, u32 size)
+{
+  return address < w.address + w.size && w.address < address + size;
+}
+
+// Only the first hit of an instruction is reported
+void Record(const Watchpoint& w, u8 access)
+{
+  if (!s_hit)
+    s_hit = WatchpointHit{w, access, LAST_CS, LAST_IP};
+}
+
+void Apply()
+{
+  {
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    s_watched.clear();
+
+    for (const Watchpoint& w : s_watchpoints)
+      s_watched.push_back({w, {}});
+  }
+
+  for (u8& flags : Memory::page_flags)
+    flags &= ~Memory::PAGE_FLAG_WATCHED;
+
+  for (Watched& watched : s_watched) {
+    const Watchpoint& w = watched.watchpoint;
+
+    for (u32 page = w.address >> Memory::PAGE_SHIFT;
+         page <= (w.address + w.size - 1) >> Memory::PAGE_SHIFT; page++)
+      Memory::page_flags[page] |= Memory::PAGE_FLAG_WATCHED;
+
+    const auto begin = Memory::Get().begin() + w.address;
+    watched.contents.assign(begin, begin + w.size);
+  }
+
+  s_check_contents = false;
+}
+
+void CheckContents()
+{
+  for (Watched& watched : s_watched) {
+    const Watchpoint& w = watched.watchpoint;
+
+    if (!(w.flags & WATCH_CHANGE))
+      continue;
+
+    const u8* current = Memory::Get().data() + w.address;
+
+    if (std::memcmp(watched.contents.data(), current, w.size) == 0)
+      continue;
+
+    std::copy(current, current + w.size, watched.contents.begin());
+    Record(w, WATCH_CHANGE);
+  }
+}
+} // namespace
+
+void AddWatchpoint(Watchpoint w)
+{
+  if (w.size == 0 || w.address >= Memory::SIZE)
+    return;
+
+  w.size = std::min(w.size, Memory::SIZE - w.address);
+
+  std::lock_guard<std::mutex> lock(s_mutex);
+
+  auto it = std::find_if(s_watchpoints.begin(), s_watchpoints.end(),
+                         [&w](const Watchpoint& other) {
+                           return other.address == w.address &&
+                                  other.size == w.size;
+                         });
+
+  if (it != s_watchpoints.end())
+    *it = w;
+  else
+    s_watchpoints.push_back(w);
+
+  s_count = static_cast<u32>(s_watchpoints.size());
+  s_changed = true;
+  RequestWork(PENDING_WATCHPOINTS);
+}
+
+void RemoveWatchpoint(Watchpoint w)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+
+  const auto it = std::remove_if(
+      s_watchpoints.begin(), s_watchpoints.end(),
+      [&w](const Watchpoint& other) {
+        return other.address == w.address &&
+               other.size == std::min(w.size, Memory::SIZE - w.address);
+      });
+
+  if (it == s_watchpoints.end())
+    return;
+
+  s_watchpoints.erase(it, s_watchpoints.end());
+
+  s_count = static_cast<u32>(s_watchpoints.size());
+  s_changed = true;
+  RequestWork(PENDING_WATCHPOINTS);
+}
+
+std::vector<Watchpoint> GetWatchpoints()
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  return s_watchpoints;
+}
+
+bool HasWatchpoints() { return s_count.load(std::memory_order_relaxed) != 0; }
+
+std::optional<WatchpointHit> GetLastWatchpointHit()
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  return s_last_hit;
+}
+
+bool IsWatchpointHit()
+{
+  ClearWork(PENDING_WATCHPOINTS);
+
+  if (s_check_contents) {
+    s_check_contents = false;
+    CheckContents();
+  }
+
+  if (s_changed.exchange(false))
+    Apply();
+
+  if (!s_hit)
+    return false;
+
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_last_hit = s_hit;
+  s_hit.reset();
+
+  return true;
+}
+
+void WatchedRead(u32 address, u32 size)
+{
+  for (const Watched& watched : s_watched) {
+    const Watchpoint& w = watched.watchpoint;
+
+    if ((w.flags & WATCH_READ) && Overlaps(w, address, size)) {
+      Record(w, WATCH_READ);
+      RequestWork(PENDING_WATCHPOINTS);
+    }
+  }
+}
+
+void WatchedWrite(u32 address, u32 size)
+{
+  for (const Watched& watched : s_watched) {
+    const Watchpoint& w = watched.watchpoint;
+
+    if (!(w.flags & (WATCH_WRITE | WATCH_CHANGE)) ||
+        !Overlaps(w, address, size))
+      continue;
+
+    if (w.flags & WATCH_WRITE)
+      Record(w, WATCH_WRITE);
+
+    // The value only gets written once the reference is handed out
+    if (w.flags & WATCH_CHANGE)
+      s_check_contents = true;
+
+    RequestWork(PENDING_WATCHPOINTS);
+  }
+}
+} // namespace Core::CPU
@@ -0,0 +1,67 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include <optional>
+#include <vector>
+
+#include "Common/Types.h"
+
+namespace Core::CPU
+{
+//! What a watchpoint reacts to
+enum WatchFlag : u8 {
+  //! Reads by the CPU. Read-modify-write instructions count as writes
+  WATCH_READ = 1 << 0,
+  //! Writes, by the CPU or by devices
+  WATCH_WRITE = 1 << 1,
+  //! Writes that leave a different value behind
+  WATCH_CHANGE = 1 << 2,
+};
+
+//! Range of physical memory to watch
+struct Watchpoint {
+  u32 address;
+  u32 size;
+  u8 flags;
+};
+
+struct WatchpointHit {
+  Watchpoint watchpoint;
+  //! The WatchFlag that triggered
+  u8 access;
+  //! Instruction that made the access
+  u16 segment, offset;
+};
+
+/**
+ * @brief Watchpoints may be added and removed from any thread. The CPU
+ * thread picks changes up before its next instruction and pauses right after
+ * the instruction that hit one, like it does for breakpoints.
+ *
+ * Only accesses to watched pages take the slow path that checks them, and
+ * native code doesn't run while any watchpoint is set.
+ */
+void AddWatchpoint(Watchpoint w);
+//! Removes the watchpoint with the same address and size
+void RemoveWatchpoint(Watchpoint w);
+std::vector<Watchpoint> GetWatchpoints();
+//! Whether any watchpoint is set at all
+bool HasWatchpoints();
+
+//! The watchpoint that paused the CPU last, if any
+std::optional<WatchpointHit> GetLastWatchpointHit();
+
+//! \cond PRIVATE
+//! Picks up added and removed watchpoints and checks for a hit since the
+//! last call. CPU thread only
+bool IsWatchpointHit();
+
+//! Slow paths of accesses to watched pages
+void WatchedRead(u32 address, u32 size);
+void WatchedWrite(u32 address, u32 size);
+//! \endcond PRIVATE
+} // namespace Core::CPU
@@ -6,7 +6,11 @@
 
 #include "Common/Logger.h"
 
+#include <fstream>
+#include <iterator>
+
 #include "Core/CPU/CPU.h"
+#include "Core/CPU/Recompiled.h"
 #include "Core/HW/FloppyDrive.h"
 #include "Core/HW/VGA.h"
 #include "Core/TTY.h"
@@ -25,6 +29,8 @@ bool BootFloppy()
   if (!HW::FloppyDrive::Read(0, 512, Memory::GetPtr<u8>(0x0000, 0x7C00)))
     return false;
 
+  Memory::MarkWritten(0x0000, 0x7C00, 512);
+
   CPU::CS = 0;
   CPU::IP = 0x7C00;
 
@@ -37,26 +43,16 @@ void Stop() { CPU::Stop(); }
 
 void Pause() { CPU::SetPaused(!CPU::IsPaused()); }
 
-bool BootCOM(const std::string& file, const std::string&& parameters)
+void LoadCOM(const u8* image, size_t size, const std::string& parameters)
 {
-  Init();
-
-  std::ifstream ifs(file, std::ios::binary);
-
-  if (!ifs.good())
-    return false;
-
   CPU::DS = 0;
   CPU::IP = 0x100;
   CPU::simulate_msdos = true;
 
-  size_t index;
-  for (index = 0; !ifs.eof(); index++) {
-    Memory::Get<u8>(0x0000, static_cast<u16>(0x0100 + index)) =
-        static_cast<u8>(ifs.get());
-  }
+  for (size_t index = 0; index < size; index++)
+    Memory::Get<u8>(0x0000, static_cast<u16>(0x0100 + index)) = image[index];
 
-  LOG("Loaded " + std::to_string(index - 1) + " bytes into memory");
+  LOG("Loaded " + std::to_string(size) + " bytes into memory");
 
   Memory::Get<u8>(0x0000, 0x0080) = static_cast<u8>(parameters.size());
 
@@ -68,11 +64,39 @@ bool BootCOM(const std::string& file, const std::string&& parameters)
   Memory::Get<char>(0x0000, offset) = '\0';
 
   LOG("Command line parameters are \"" + parameters + "\"");
+}
+
+bool BootCOM(const std::string& file, const std::string&& parameters)
+{
+  Init();
 
-  ifs.close();
+  std::ifstream ifs(file, std::ios::binary);
+
+  if (!ifs.good())
+    return false;
+
+  const std::vector<u8> image((std::istreambuf_iterator<char>(ifs)),
+                              std::istreambuf_iterator<char>());
+
+  LoadCOM(image.data(), image.size(), parameters);
 
   CPU::Start();
 
   return true;
 }
+
+bool BootRecompiledCOM(const CPU::RecompiledProgram& program,
+                       const std::string& parameters)
+{
+  Init();
+
+  LoadCOM(program.image, program.image_size, parameters);
+  CPU::InstallRecompiledProgram(program, 0x0000);
+
+  CPU::Start();
+
+  CPU::UninstallRecompiledProgram();
+
+  return true;
+}
 } // namespace Core::Machine
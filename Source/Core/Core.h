@@ -7,6 +7,13 @@
 
 #include <string>
 
+#include "Common/Types.h"
+
+namespace Core::CPU
+{
+struct RecompiledProgram;
+}
+
 //! Representation of a PC
 namespace Core
 {
@@ -23,4 +30,12 @@ void Pause();
 
 //! Directly execute a COM file
 bool BootCOM(const std::string& file, const std::string&& parameters = "");
+
+//! Load a COM image to 0000:0100 and set up the registers like DOS would,
+//! without starting the CPU
+void LoadCOM(const u8* image, size_t size, const std::string& parameters = "");
+
+//! Directly execute a COM program translated by the Recompile tool
+bool BootRecompiledCOM(const CPU::RecompiledProgram& program,
+                       const std::string& parameters = "");
 } // namespace Core::Machine
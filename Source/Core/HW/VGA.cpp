@@ -7,6 +7,7 @@
 #include "Common/Logger.h"
 #include "Common/String.h"
 
+#include "Core/CPU/CPU.h"
 #include "Core/Core.h"
 #include "Core/Memory.h"
 
@@ -14,6 +15,13 @@ Core::HW::VGABackend* g_VGABackend = nullptr;
 
 using namespace Core::HW;
 
+// Text mode memory, B800:0000 to B800:7FFF. The output only gets refreshed
+// once in a while, so writes just ask for that
+static const Core::Memory::Device s_text_memory = {
+    nullptr,
+    [](u32, u32) { Core::CPU::RequestWork(Core::CPU::PENDING_REFRESH); },
+};
+
 void VGA::Init()
 {
   for (size_t y = 0; y < 25; y++)
@@ -21,6 +29,8 @@ void VGA::Init()
       GetBuffer()[(y * 80 + x) * sizeof(u16)] = ' ';
       GetBuffer()[(y * 80 + x) * sizeof(u16) + 1] = 0x0F;
     }
+
+  Memory::MapDevice(0xB8000, 0x8000, s_text_memory);
 }
 
 bool VGA::IsPresent() { return g_VGABackend != nullptr; }
@@ -37,4 +47,4 @@ void VGA::Update()
     g_VGABackend->Update();
 }
 
-u8* VGA::GetBuffer() { return Memory::GetPtr<u8>(0xB000, 0x8000); }
+u8* VGA::GetBuffer() { return &Memory::Get()[0xB8000]; }
@@ -16,6 +16,9 @@ void Update();
 bool IsPresent();
 
 void SetMode(u8 mode);
+
+//! Text mode memory. Writes through it have to be followed by
+//! Memory::MarkWritten() for the output to get refreshed
 u8* GetBuffer();
 } // namespace VGA
 
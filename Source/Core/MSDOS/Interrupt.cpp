@@ -82,6 +82,7 @@ bool CPU::CallMSDOSInterrupt(u8 vector)
       auto read = File::Read(BX, CX, Memory::GetPtr<u8>(DS, DX));
 
       if (read) {
+        Memory::MarkWritten(DS, DX, read.value());
         AX = read.value();
       } else {
         AX = 0x05;
@@ -115,7 +116,8 @@ bool CPU::CallMSDOSInterrupt(u8 vector)
 
     default:
       LOG("[INT 0x21] Unhandled parameter AH = " + String::ToHex(AH));
-      throw UnhandledInterruptException();
+      RaiseFault(FaultKind::UnhandledInterrupt,
+                 UnhandledInterruptException());
     }
     return true;
   }
@@ -1,14 +1,257 @@
 #include "Core/Memory.h"
 
-#include "Core/CPU/Exception.h"
+#include <algorithm>
+#include <vector>
+
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/JIT.h"
+#include "Core/CPU/Recompiled.h"
+#include "Core/CPU/Watchpoint.h"
 
 using namespace Core;
 
-static std::vector<u8> m_data(1024 * 1024);
+alignas(Memory::PAGE_SIZE) std::array<u8, Memory::SIZE + Memory::HMA_SIZE>
+    Memory::ram;
+
+std::array<u8, Memory::PAGE_COUNT + 1> Memory::page_flags;
+
+namespace
+{
+// Who handles each page mapped to a device
+std::array<const Memory::Device*, Memory::PAGE_COUNT> s_devices{};
+
+struct DeviceWrite {
+  const Memory::Device* device;
+  u32 address, size;
+};
+
+// Writes the devices haven't been told about yet
+std::vector<DeviceWrite> s_device_writes;
+
+bool s_dirty_tracking = false;
+std::bitset<Memory::PAGE_COUNT> s_dirty_pages;
+
+// Flags of the pages [address, address + size) touches, and how much of it
+// is within RAM
+u8 GetFlags(u32 address, u32& size)
+{
+  size = std::min(size, Memory::SIZE - address);
+
+  const u32 last = (address + size - 1) >> Memory::PAGE_SHIFT;
+
+  u8 flags = 0;
+
+  for (u32 page = address >> Memory::PAGE_SHIFT; page <= last; page++)
+    flags |= Memory::page_flags[page];
+
+  return flags;
+}
+
+void SetPageType(u32 address, u32 size, u8 flags,
+                 const Memory::Device* device)
+{
+  if (size == 0 || address >= Memory::SIZE)
+    return;
+
+  size = std::min(size, Memory::SIZE - address);
+
+  const u32 last = (address + size - 1) >> Memory::PAGE_SHIFT;
+
+  for (u32 page = address >> Memory::PAGE_SHIFT; page <= last; page++) {
+    Memory::page_flags[page] &=
+        ~(Memory::PAGE_FLAG_DEVICE | Memory::PAGE_FLAG_ROM);
+    Memory::page_flags[page] |= flags;
+    s_devices[page] = device;
+  }
+}
+
+// Calls f(device, address, size) for every part of [address, address + size)
+// mapped to a device
+template <typename F> void ForEachDevice(u32 address, u32 size, F f)
+{
+  const u32 end = address + size;
+
+  for (u32 page = address >> Memory::PAGE_SHIFT;
+       page <= (end - 1) >> Memory::PAGE_SHIFT; page++) {
+    if (s_devices[page] == nullptr)
+      continue;
+
+    const u32 first = std::max(address, page << Memory::PAGE_SHIFT);
+    const u32 last = std::min(end, (page + 1) << Memory::PAGE_SHIFT);
+
+    f(*s_devices[page], first, last - first);
+  }
+}
+
+void MarkDirty(u32 address, u32 size)
+{
+  const u32 last = (address + size - 1) >> Memory::PAGE_SHIFT;
+
+  for (u32 page = address >> Memory::PAGE_SHIFT; page <= last; page++) {
+    Memory::page_flags[page] &= ~Memory::PAGE_FLAG_CLEAN;
+    s_dirty_pages[page] = true;
+  }
+}
+
+void QueueDeviceWrite(const Memory::Device& device, u32 address, u32 size)
+{
+  if (device.write == nullptr)
+    return;
+
+  // String instructions write one element after the other, in either
+  // direction
+  if (!s_device_writes.empty() && s_device_writes.back().device == &device) {
+    DeviceWrite& last = s_device_writes.back();
+
+    if (last.address + last.size == address) {
+      last.size += size;
+      return;
+    }
+
+    if (address + size == last.address) {
+      last.address = address;
+      last.size += size;
+      return;
+    }
+  }
+
+  s_device_writes.push_back({&device, address, size});
+  CPU::RequestWork(CPU::PENDING_DEVICES);
+}
+} // namespace
+
+void Memory::MapRAM(u32 address, u32 size)
+{
+  SetPageType(address, size, 0, nullptr);
+}
+
+void Memory::MapROM(u32 address, u32 size)
+{
+  SetPageType(address, size, PAGE_FLAG_ROM, nullptr);
+}
+
+void Memory::MapDevice(u32 address, u32 size, const Device& device)
+{
+  SetPageType(address, size, PAGE_FLAG_DEVICE, &device);
+}
+
+Memory::PageType Memory::GetPageType(u32 address)
+{
+  const u8 flags = page_flags[(address & ADDRESS_MASK) >> PAGE_SHIFT];
+
+  if (flags & PAGE_FLAG_DEVICE)
+    return PageType::Device;
+
+  if (flags & PAGE_FLAG_ROM)
+    return PageType::ROM;
+
+  return PageType::RAM;
+}
+
+void Memory::SetDirtyTracking(bool enabled)
+{
+  s_dirty_tracking = enabled;
+  s_dirty_pages.reset();
+
+  for (u32 page = 0; page < PAGE_COUNT; page++) {
+    if (enabled)
+      page_flags[page] |= PAGE_FLAG_CLEAN;
+    else
+      page_flags[page] &= ~PAGE_FLAG_CLEAN;
+  }
+}
+
+bool Memory::IsDirtyTracking() { return s_dirty_tracking; }
+
+std::bitset<Memory::PAGE_COUNT> Memory::CollectDirtyPages()
+{
+  const std::bitset<PAGE_COUNT> dirty = s_dirty_pages;
+
+  // Only the pages written since need their flag back
+  for (u32 page = 0; page < PAGE_COUNT && s_dirty_tracking; page++) {
+    if (s_dirty_pages[page])
+      page_flags[page] |= PAGE_FLAG_CLEAN;
+  }
+
+  s_dirty_pages.reset();
+
+  return dirty;
+}
+
+void Memory::NotifyDevices()
+{
+  CPU::ClearWork(CPU::PENDING_DEVICES);
+
+  // Devices may write to memory themselves
+  std::vector<DeviceWrite> writes;
+  writes.swap(s_device_writes);
+
+  for (const DeviceWrite& write : writes)
+    write.device->write(write.address, write.size);
+}
 
-std::vector<u8>& Memory::Get() { return m_data; }
+u8* Memory::HandleWrite(u32 address, u32 size)
+{
+  if (size == 0)
+    return &ram[address];
+
+  const u8 flags = GetFlags(address, size);
+
+  if (flags & PAGE_FLAG_WATCHED)
+    CPU::WatchedWrite(address, size);
+
+  // Nothing changes, so nothing else has to know
+  if (flags & PAGE_FLAG_ROM) {
+    alignas(8) static std::array<u8, 8> s_scratch;
+    return s_scratch.data();
+  }
+
+  if (flags & PAGE_FLAG_CLEAN)
+    MarkDirty(address, size);
+
+  if (flags & PAGE_FLAG_CODE)
+    CPU::InvalidateInstructionCache(address, size);
+
+  if (flags & PAGE_FLAG_TRANSLATED)
+    CPU::InvalidateTranslations(address, size);
+
+  if (flags & PAGE_FLAG_RECOMPILED)
+    CPU::InvalidateRecompiledCode(address, size);
+
+  if (flags & PAGE_FLAG_DEVICE)
+    ForEachDevice(address, size, QueueDeviceWrite);
+
+  return &ram[address];
+}
+
+void Memory::HandleRead(u32 address, u32 size)
+{
+  const u8 flags = GetFlags(address, size);
+
+  if (flags & PAGE_FLAG_WATCHED)
+    CPU::WatchedRead(address, size);
+
+  if (flags & PAGE_FLAG_DEVICE) {
+    ForEachDevice(address, size, [](const Device& device, u32 first, u32 n) {
+      if (device.read != nullptr)
+        device.read(first, n);
+    });
+  }
+}
+
+u16 Memory::ReadWrapped(u32 address, u32 next)
+{
+  return Read<u8>(address) | (Read<u8>(next) << 8);
+}
+
+void Memory::WriteWrapped(u32 address, u32 next, u16 value)
+{
+  Write<u8>(address, static_cast<u8>(value));
+  Write<u8>(next, static_cast<u8>(value >> 8));
+}
 
-u32 Memory::VirtToPhys(u16 segment, u16 offset)
+void Memory::MarkWritten(u16 segment, u16 offset, u32 size)
 {
-  return segment * 0x10 + offset;
+  HandleWrite(VirtToPhys(segment, offset), size);
 }
@@ -1,31 +1,274 @@
 #pragma once
 //! \file
 
-#include <vector>
+#include <array>
+#include <bitset>
+#include <cstring>
 
 #include "Common/Types.h"
 
-#include "Core/CPU/Exception.h"
-
 namespace Core
 {
 //! Wrapper around emulated RAM
 namespace Memory
 {
+//! Size of the emulated RAM in bytes
+constexpr u32 SIZE = 1024 * 1024;
+
+/**
+ * @brief What segment:offset pairs from FFFF:0010 up reach above 1 MiB. A
+ * 286 with its A20 line enabled gets the HMA there, the 8088 only has 20
+ * address lines and wraps around to 0 instead, see VirtToPhys()
+ */
+constexpr u32 HMA_SIZE = 0x10000;
+
+//! Physical addresses are 20 bits wide
+constexpr u32 ADDRESS_MASK = SIZE - 1;
+
+//! log2 of the granularity used for tracking writes
+constexpr u32 PAGE_SHIFT = 12;
+//! Granularity used for tracking writes
+constexpr u32 PAGE_SIZE = 1 << PAGE_SHIFT;
+//! Amount of pages in RAM
+constexpr u32 PAGE_COUNT = SIZE / PAGE_SIZE;
+
+//! Page flags. Writes to pages with any flag set take the slow path, reads
+//! only do for PAGE_FLAG_DEVICE and PAGE_FLAG_WATCHED
+enum PageFlag : u8 {
+  //! The instruction cache holds instructions decoded from this page
+  PAGE_FLAG_CODE = 1 << 0,
+  //! The JIT translated code from this page
+  PAGE_FLAG_TRANSLATED = 1 << 1,
+  //! Instructions of the installed recompiled program live on this page
+  PAGE_FLAG_RECOMPILED = 1 << 2,
+  //! A device gets told about accesses to this page, see MapDevice()
+  PAGE_FLAG_DEVICE = 1 << 3,
+  //! A watchpoint covers part of this page
+  PAGE_FLAG_WATCHED = 1 << 4,
+  //! Writes to this page are dropped, see MapROM()
+  PAGE_FLAG_ROM = 1 << 5,
+  //! Dirty tracking is on and the page wasn't written since the last
+  //! CollectDirtyPages(). Only the first write to it takes the slow path
+  PAGE_FLAG_CLEAN = 1 << 6,
+};
+
+/**
+ * @brief Memory-mapped device. Its pages are still backed by RAM, which is
+ * what the guest reads and where its writes end up, so guest code doesn't
+ * take a detour through the device for every access.
+ */
+struct Device {
+  //! Called before the guest reads [address, address + size), so the device
+  //! can update those bytes. May be nullptr
+  void (*read)(u32 address, u32 size);
+  //! Called with what the guest wrote, once the instruction writing it
+  //! finished. Adjacent writes get merged. May be nullptr
+  void (*write)(u32 address, u32 size);
+};
+
+//! What a page is backed by
+enum class PageType : u8 {
+  RAM,
+  ROM,
+  Device,
+};
+
+//! Flags for every page, plus one for the guard after RAM that multi-byte
+//! accesses at the very end of it touch
+extern std::array<u8, PAGE_COUNT + 1> page_flags;
+
+/**
+ * @brief RAM, followed by HMA_SIZE bytes of guard. Every physical address is
+ * below SIZE, so any access of a few bytes from one stays within the array
+ * without checking. Only the value helpers below wrap multi-byte accesses
+ * at the end of RAM around to 0, like the 8088 does; references into the
+ * guard don't.
+ */
+alignas(PAGE_SIZE) extern std::array<u8, SIZE + HMA_SIZE> ram;
+
 //! Get the contents of RAM
-std::vector<u8>& Get();
+inline std::array<u8, SIZE + HMA_SIZE>& Get() { return ram; }
+
+//! Converts a virtual address to a physical one, wrapping around at 1 MiB
+inline u32 VirtToPhys(u16 segment, u16 offset)
+{
+  return ((static_cast<u32>(segment) << 4) + offset) & ADDRESS_MASK;
+}
+
+/**
+ * @brief Map the pages covering [address, address + size) as plain RAM, which
+ * is what all of memory starts out as
+ */
+void MapRAM(u32 address, u32 size);
+
+//! Map the pages covering [address, address + size) as ROM. Whatever is in
+//! them stays, only the guest can't change it anymore
+void MapROM(u32 address, u32 size);
+
+//! Hand the pages covering [address, address + size) to device, which has to
+//! stay around as long as they're mapped to it
+void MapDevice(u32 address, u32 size, const Device& device);
+
+PageType GetPageType(u32 address);
+
+/**
+ * @brief Tell devices about the writes since the last call. The CPU does so
+ * between instructions, see CPU::PENDING_DEVICES
+ */
+void NotifyDevices();
+
+/**
+ * @brief Start or stop tracking which pages get written, which costs one
+ * slow path write per page and collection. Starting marks all pages clean
+ */
+void SetDirtyTracking(bool enabled);
+bool IsDirtyTracking();
+
+/**
+ * @brief Pages written since the last call or since tracking started, one bit
+ * per page. They are clean again afterwards. Not safe to call while the CPU
+ * is running on another thread
+ */
+std::bitset<PAGE_COUNT> CollectDirtyPages();
+
+//! Slow path for writes touching flagged pages. Returns where the bytes go,
+//! which is scratch memory for ROM
+u8* HandleWrite(u32 address, u32 size);
+
+//! Slow path for reads touching device or watched pages
+void HandleRead(u32 address, u32 size);
+
+//! Slow path of word accesses wrapping around the end of RAM or of a
+//! segment: the low byte is at address, the high one at next
+u16 ReadWrapped(u32 address, u32 next);
+void WriteWrapped(u32 address, u32 next, u16 value);
+
+/**
+ * @brief Notify the memory subsystem that a range was written to behind its
+ * back (e.g. by a device reading straight into a pointer)
+ */
+void MarkWritten(u16 segment, u16 offset, u32 size);
+
+//! Whether the sizeof(T) bytes at address touch a page with any of flags
+template <typename T> bool HasPageFlags(u32 address, u8 flags)
+{
+  return (page_flags[address >> PAGE_SHIFT] |
+          page_flags[(address + sizeof(T) - 1) >> PAGE_SHIFT]) &
+         flags;
+}
+
+//! Get a reference to memory at a physical address. This is treated as a
+//! write. Words at the very end of RAM don't wrap, see Write()
+template <typename T> T& Get(u32 address)
+{
+  if (HasPageFlags<T>(address, 0xFF))
+    return *reinterpret_cast<T*>(HandleWrite(address, sizeof(T)));
 
-//! Converts a virtual address to an absolute one
-u32 VirtToPhys(u16 segment, u16 offset);
+  return *reinterpret_cast<T*>(&ram[address]);
+}
 
+//! Get a reference to memory. This is treated as a write
 template <typename T> T& Get(u16 segment, u16 offset)
 {
-  u32 address = VirtToPhys(segment, offset);
+  return Get<T>(VirtToPhys(segment, offset));
+}
+
+//! Read from a physical address without marking it as written
+template <typename T> T Read(u32 address)
+{
+  if constexpr (sizeof(T) > 1) {
+    if (address == SIZE - 1)
+      return static_cast<T>(ReadWrapped(address, 0));
+  }
 
-  if (address + sizeof(T) >= Get().size())
-    throw Core::CPU::MemoryOutOfRangeException();
+  if (HasPageFlags<T>(address, PAGE_FLAG_DEVICE | PAGE_FLAG_WATCHED))
+    HandleRead(address, sizeof(T));
+
+  T value;
+  std::memcpy(&value, &ram[address], sizeof(T));
+  return value;
+}
+
+/**
+ * @brief Read from memory without marking it as written. A word at offset
+ * FFFF wraps around to offset 0 of the same segment
+ */
+template <typename T> T Read(u16 segment, u16 offset)
+{
+  if constexpr (sizeof(T) > 1) {
+    if (offset == 0xFFFF)
+      return static_cast<T>(
+          ReadWrapped(VirtToPhys(segment, offset), VirtToPhys(segment, 0)));
+  }
 
-  return *reinterpret_cast<T*>(&Get()[address]);
+  return Read<T>(VirtToPhys(segment, offset));
+}
+
+//! Write to a physical address
+template <typename T> void Write(u32 address, T value)
+{
+  if constexpr (sizeof(T) > 1) {
+    if (address == SIZE - 1)
+      return WriteWrapped(address, 0, value);
+  }
+
+  u8* destination = &ram[address];
+
+  if (HasPageFlags<T>(address, 0xFF))
+    destination = HandleWrite(address, sizeof(T));
+
+  std::memcpy(destination, &value, sizeof(T));
+}
+
+//! Write to memory, wrapping around like Read()
+template <typename T> void Write(u16 segment, u16 offset, T value)
+{
+  if constexpr (sizeof(T) > 1) {
+    if (offset == 0xFFFF)
+      return WriteWrapped(VirtToPhys(segment, offset), VirtToPhys(segment, 0),
+                          value);
+  }
+
+  Write<T>(VirtToPhys(segment, offset), value);
+}
+
+//! Read, modify and write back memory, wrapping around like Read(). modify
+//! gets a T&
+template <typename T, typename F>
+void Modify(u16 segment, u16 offset, F modify)
+{
+  const u32 address = VirtToPhys(segment, offset);
+
+  // Plain RAM that doesn't wrap can be changed in place
+  if ((sizeof(T) == 1 || (offset != 0xFFFF && address != SIZE - 1)) &&
+      !HasPageFlags<T>(address, 0xFF)) {
+    T value;
+    std::memcpy(&value, &ram[address], sizeof(T));
+    modify(value);
+    std::memcpy(&ram[address], &value, sizeof(T));
+    return;
+  }
+
+  T value = Read<T>(segment, offset);
+  modify(value);
+  Write<T>(segment, offset, value);
+}
+
+/**
+ * @brief Read() that isn't an access by the guest, so it doesn't trigger
+ * watchpoints or devices. For instruction fetch and the debugger
+ */
+template <typename T> T Peek(u32 address)
+{
+  T value;
+  std::memcpy(&value, &ram[address], sizeof(T));
+  return value;
+}
+
+//! Peek() at a virtual address
+template <typename T> T Peek(u16 segment, u16 offset)
+{
+  return Peek<T>(VirtToPhys(segment, offset));
 }
 
 template <typename T> T* GetPtr(u16 segment, u16 offset)
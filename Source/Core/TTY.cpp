@@ -10,6 +10,7 @@
 #include "Common/String.h"
 
 #include "Core/HW/VGA.h"
+#include "Core/Memory.h"
 
 static u8 s_column = 0;
 static u8 s_row = 0;
@@ -46,7 +47,10 @@ void TTY::Write(const char c)
     return;
   }
 
-  Core::HW::VGA::GetBuffer()[(s_row * 80 + s_column) * sizeof(u16)] = c;
+  const u16 offset = static_cast<u16>((s_row * 80 + s_column) * sizeof(u16));
+
+  Core::HW::VGA::GetBuffer()[offset] = c;
+  Core::Memory::MarkWritten(0xB800, offset, 1);
   s_column++;
 
   s_column %= 80;
@@ -83,6 +87,8 @@ void TTY::Clear()
       Core::HW::VGA::GetBuffer()[(y * 80 + x) * sizeof(u16)] = 0;
     }
   }
+
+  Core::Memory::MarkWritten(0xB800, 0, 80 * 80 * sizeof(u16));
 }
 
 char TTY::Read()
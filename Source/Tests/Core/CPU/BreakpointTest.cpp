@@ -0,0 +1,214 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Breakpoint.h"
+#include "Core/Memory.h"
+#include "Tests/Core/Program.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Core::CPU;
+namespace CPU = Core::CPU;
+
+static void Load(const std::vector<u8>& program)
+{
+  LoadProgram(program);
+  SetPaused(false);
+}
+
+// INC AX; JMP -3
+static const std::vector<u8> s_loop = {0x40, 0xEB, 0xFD};
+
+TEST(Breakpoint, AddRemove)
+{
+  EXPECT_FALSE(HasBreakpoints());
+
+  AddBreakpoint({0x1000, 0x0001});
+  EXPECT_TRUE(HasBreakpoints());
+  EXPECT_TRUE(IsBreakpoint(0x1000, 0x0001));
+  EXPECT_FALSE(IsBreakpoint(0x1000, 0x0000));
+  EXPECT_FALSE(IsBreakpoint(0x1000, 0x0002));
+
+  // Adding it twice doesn't take removing it twice
+  AddBreakpoint({0x1000, 0x0001});
+  RemoveBreakpoint({0x1000, 0x0001});
+  EXPECT_FALSE(IsBreakpoint(0x1000, 0x0001));
+  EXPECT_FALSE(HasBreakpoints());
+
+  // Removing what isn't there is harmless
+  RemoveBreakpoint({0x1000, 0x0001});
+  EXPECT_FALSE(HasBreakpoints());
+}
+
+TEST(Breakpoint, Aliases)
+{
+  // 0x1000:0x0010 and 0x1001:0x0000 are the same byte
+  AddBreakpoint({0x1000, 0x0010});
+  EXPECT_TRUE(IsBreakpoint(0x1001, 0x0000));
+
+  AddBreakpoint({0x1001, 0x0000});
+  RemoveBreakpoint({0x1000, 0x0010});
+  EXPECT_TRUE(IsBreakpoint(0x1000, 0x0010));
+  EXPECT_TRUE(HasBreakpoints());
+
+  RemoveBreakpoint({0x1001, 0x0000});
+  EXPECT_FALSE(IsBreakpoint(0x1000, 0x0010));
+  EXPECT_FALSE(HasBreakpoints());
+
+  // Above 1 MiB wraps around to 0
+  AddBreakpoint({0x0000, 0x0000});
+  EXPECT_TRUE(IsBreakpoint(0xFFFF, 0x0010));
+  RemoveBreakpoint({0x0000, 0x0000});
+  EXPECT_FALSE(IsBreakpoint(0xFFFF, 0x0010));
+
+  AddBreakpoint({0xFFFF, 0xFFFF});
+  EXPECT_TRUE(IsBreakpoint(0x0FFE, 0x000F));
+  RemoveBreakpoint({0xFFFF, 0xFFFF});
+  EXPECT_FALSE(IsBreakpoint(0xFFFF, 0xFFFF));
+}
+
+TEST(Breakpoint, Hit)
+{
+  Load(s_loop);
+
+  // Through an alias of the JMP
+  AddBreakpoint({0x0FFF, 0x0011});
+
+  RunResult result = CPU::Run(10);
+  EXPECT_EQ(result.status, RunStatus::Breakpoint);
+  EXPECT_EQ(result.retired, 1u);
+  EXPECT_EQ(IP, 1);
+
+  RemoveBreakpoint({0x0FFF, 0x0011});
+  SetPaused(false);
+
+  EXPECT_EQ(CPU::Run(10).retired, 10u);
+}
+
+TEST(Breakpoint, UpdatedWhileRunning)
+{
+  Load(s_loop);
+
+  std::atomic<bool> done = false;
+
+  // Toggles breakpoints the loop never reaches while the CPU runs
+  std::thread thread([&done] {
+    for (u16 i = 0; !done; i++) {
+      AddBreakpoint({0x2000, i});
+      RemoveBreakpoint({0x2000, i});
+    }
+  });
+
+  u64 retired = 0;
+
+  for (int i = 0; i < 1000; i++) {
+    const RunResult result = CPU::Run(1000);
+    EXPECT_EQ(result.status, RunStatus::Completed);
+    retired += result.retired;
+  }
+
+  done = true;
+  thread.join();
+
+  EXPECT_EQ(retired, 1000u * 1000u);
+  EXPECT_FALSE(HasBreakpoints());
+}
+
+TEST(Breakpoint, Conditional)
+{
+  Load(s_loop);
+  AX = 0;
+
+  std::string error;
+  EXPECT_FALSE(AddConditionalBreakpoint({0x1000, 0x0001}, "ax ==", &error));
+  EXPECT_FALSE(error.empty());
+  EXPECT_FALSE(HasBreakpoints());
+
+  // At the JMP, once INC made AX 5
+  ASSERT_TRUE(AddConditionalBreakpoint({0x1000, 0x0001}, "AX == 5"));
+
+  RunResult result = CPU::Run(100);
+  EXPECT_EQ(result.status, RunStatus::Breakpoint);
+  EXPECT_EQ(result.retired, 9u);
+  EXPECT_EQ(AX, 5);
+
+  // Replacing it with a plain one hits right away
+  SetPaused(false);
+  CPU::Run(1);
+  AddBreakpoint({0x1000, 0x0001});
+  result = CPU::Run(100);
+  EXPECT_EQ(result.status, RunStatus::Breakpoint);
+  EXPECT_EQ(result.retired, 1u);
+
+  RemoveBreakpoint({0x1000, 0x0001});
+  SetPaused(false);
+}
+
+TEST(Breakpoint, Tracepoint)
+{
+  Load(s_loop);
+  AX = 0;
+  TakeTraceRecords();
+
+  std::string error;
+  EXPECT_FALSE(AddTracepoint({0x1000, 0x0000}, "", "ax, foo", &error));
+  EXPECT_EQ(error, "Unknown name 'foo' at column 2");
+  EXPECT_FALSE(
+      AddTracepoint({0x1000, 0x0000}, "", "1, 2, 3, 4, 5, 6, 7, 8, 9", &error));
+  EXPECT_FALSE(HasBreakpoints());
+
+  // Every odd AX at the INC, without pausing
+  ASSERT_TRUE(AddTracepoint({0x1000, 0x0000}, "ax & 1", "ax, cs, byte[cs:ip]"));
+
+  RunResult result = CPU::Run(20);
+  EXPECT_EQ(result.status, RunStatus::Completed);
+  EXPECT_EQ(result.retired, 20u);
+
+  const std::vector<TraceRecord> records = TakeTraceRecords();
+  ASSERT_EQ(records.size(), 5u);
+
+  for (u32 i = 0; i < records.size(); i++) {
+    EXPECT_EQ(records[i].segment, 0x1000);
+    EXPECT_EQ(records[i].offset, 0);
+    ASSERT_EQ(records[i].count, 3);
+    EXPECT_EQ(records[i].values[0], 2 * i + 1);
+    EXPECT_EQ(records[i].values[1], 0x1000u);
+    EXPECT_EQ(records[i].values[2], 0x40u);
+  }
+
+  EXPECT_LT(records[0].cycles, records[1].cycles);
+  EXPECT_TRUE(TakeTraceRecords().empty());
+
+  // A full buffer drops the newest records
+  const u64 dropped = GetDroppedTraceRecords();
+  AddTracepoint({0x1000, 0x0000}, "", "");
+
+  CPU::Run(2 * (TRACE_BUFFER_SIZE + 10));
+  EXPECT_EQ(TakeTraceRecords().size(), TRACE_BUFFER_SIZE);
+  EXPECT_EQ(GetDroppedTraceRecords() - dropped, 10u);
+
+  RemoveBreakpoint({0x1000, 0x0000});
+}
+
+TEST(Breakpoint, TracepointAndBreakpoint)
+{
+  Load(s_loop);
+  TakeTraceRecords();
+
+  // Both at the same byte. Continuing doesn't trace it a second time
+  AddTracepoint({0x1000, 0x0000}, "", "ip");
+  AddBreakpoint({0x0FFF, 0x0010});
+
+  EXPECT_EQ(CPU::Run(10).status, RunStatus::Breakpoint);
+  SetPaused(false);
+  EXPECT_EQ(CPU::Run(1).retired, 1u);
+  EXPECT_EQ(TakeTraceRecords().size(), 1u);
+
+  RemoveBreakpoint({0x1000, 0x0000});
+  RemoveBreakpoint({0x0FFF, 0x0010});
+  EXPECT_FALSE(HasBreakpoints());
+}
@@ -0,0 +1,143 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/Memory.h"
+#include "Tests/Core/Program.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace Core::CPU;
+namespace CPU = Core::CPU;
+
+static void Load(const std::vector<u8>& program)
+{
+  LoadProgram(program);
+  DS = ES = 0x1000;
+  SS = 0x2000;
+  SP = 0x0100;
+  BX = SI = DI = BP = 0;
+  DF = false;
+}
+
+// Cycles the program takes from its start until IP reaches end
+static u64 Count(const std::vector<u8>& program, u16 end)
+{
+  Load(program);
+
+  const u64 start = cycles;
+
+  while (IP != end && !HasFault())
+    Step();
+
+  EXPECT_FALSE(HasFault());
+
+  return cycles - start;
+}
+
+static u16 Cycles(const std::vector<u8>& instruction)
+{
+  Load(instruction);
+
+  return DecodeInstruction(0x1000, 0).GetCycles();
+}
+
+// Reference timings are from the 8086 manual, plus 4 cycles for every word
+// the 8088 transfers over its 8 bit bus
+TEST(Cycles, Registers)
+{
+  EXPECT_EQ(Cycles({0x01, 0xD8}), 3);       // ADD AX, BX
+  EXPECT_EQ(Cycles({0x89, 0xD8}), 2);       // MOV AX, BX
+  EXPECT_EQ(Cycles({0xB8, 0x34, 0x12}), 4); // MOV AX, 0x1234
+  EXPECT_EQ(Cycles({0x05, 0x34, 0x12}), 4); // ADD AX, 0x1234
+  EXPECT_EQ(Cycles({0xA8, 0x01}), 4);       // TEST AL, 1
+  EXPECT_EQ(Cycles({0xF6, 0xC3, 0x01}), 5); // TEST BL, 1
+  EXPECT_EQ(Cycles({0x40}), 2);             // INC AX
+  EXPECT_EQ(Cycles({0xFE, 0xC0}), 3);       // INC AL
+  EXPECT_EQ(Cycles({0x93}), 3);             // XCHG BX, AX
+  EXPECT_EQ(Cycles({0x8E, 0xD8}), 2);       // MOV DS, AX
+  EXPECT_EQ(Cycles({0xF6, 0xE3}), 70);      // MUL BL
+  EXPECT_EQ(Cycles({0xF7, 0xF3}), 144);     // DIV BX
+  EXPECT_EQ(Cycles({0xD1, 0xE0}), 2);       // SHL AX, 1
+  EXPECT_EQ(Cycles({0x50}), 15);            // PUSH AX
+  EXPECT_EQ(Cycles({0x5B}), 12);            // POP BX
+  EXPECT_EQ(Cycles({0x9C}), 14);            // PUSHF
+}
+
+TEST(Cycles, Memory)
+{
+  // MOV AX, [BX+SI]: 8 + EA 7 + one word
+  EXPECT_EQ(Cycles({0x8B, 0x00}), 19);
+  // MOV [BX+DI+0x10], AL: 9 + EA 12
+  EXPECT_EQ(Cycles({0x88, 0x41, 0x10}), 21);
+  // ADD [BP+0x1234], AX: 16 + EA 9 + two words
+  EXPECT_EQ(Cycles({0x01, 0x86, 0x34, 0x12}), 33);
+  // CMP [SI], 0x12: 10 + EA 5
+  EXPECT_EQ(Cycles({0x80, 0x3C, 0x12}), 15);
+  // MOV AX, ES:[BX]: 8 + EA 5 + one word + segment override 2
+  EXPECT_EQ(Cycles({0x26, 0x8B, 0x07}), 19);
+  // MOV AL, [0x1234] has no ModRM
+  EXPECT_EQ(Cycles({0xA0, 0x34, 0x12}), 10);
+  // LEA SI, [BP+DI]: 2 + EA 7
+  EXPECT_EQ(Cycles({0x8D, 0x33}), 9);
+  // INC word [0x1234]: 15 + EA 6 + two words
+  EXPECT_EQ(Cycles({0xFF, 0x06, 0x34, 0x12}), 29);
+}
+
+TEST(Cycles, ControlFlow)
+{
+  EXPECT_EQ(Cycles({0xEB, 0x00}), 15);       // JMP short
+  EXPECT_EQ(Cycles({0xE8, 0x00, 0x00}), 23); // CALL near
+  EXPECT_EQ(Cycles({0xC3}), 12);             // RET
+  EXPECT_EQ(Cycles({0xCD, 0x21}), 71);       // INT 0x21
+
+  // MOV CX, 3; LOOP to itself: taken twice (17) and falling through (5)
+  EXPECT_EQ(Count({0xB9, 0x03, 0x00, 0xE2, 0xFE}, 5), 4 + 17 + 17 + 5u);
+
+  // XOR AX, AX; JZ +0 (taken, 16); JNZ +0 (not taken, 4)
+  EXPECT_EQ(Count({0x31, 0xC0, 0x74, 0x00, 0x75, 0x00}, 6), 3 + 16 + 4u);
+
+  // JCXZ with CX = 0 is taken
+  CX = 0;
+  EXPECT_EQ(Count({0xE3, 0x00}, 2), 18u);
+}
+
+TEST(Cycles, ShiftByCL)
+{
+  // MOV CL, 3; SHL AX, CL: 8 + 4 per bit
+  EXPECT_EQ(Count({0xB1, 0x03, 0xD3, 0xE0}, 4), 4 + 8 + 3 * 4u);
+}
+
+TEST(Cycles, Strings)
+{
+  EXPECT_EQ(Cycles({0xAA}), 11); // STOSB
+  EXPECT_EQ(Cycles({0xAB}), 15); // STOSW
+  EXPECT_EQ(Cycles({0xA5}), 26); // MOVSW
+
+  // MOV CX, 4; REP STOSB: 9 + 10 per byte
+  EXPECT_EQ(Count({0xB9, 0x04, 0x00, 0xF3, 0xAA}, 5), 4 + 9 + 4 * 10u);
+
+  // MOV CX, 2; REP MOVSW: 9 + 25 per word
+  EXPECT_EQ(Count({0xB9, 0x02, 0x00, 0xF3, 0xA5}, 5), 4 + 9 + 2 * 25u);
+}
+
+TEST(Cycles, Run)
+{
+  // MOV CX, 0x0100; INC AX; LOOP -3; HLT
+  Load({0xB9, 0x00, 0x01, 0x40, 0xE2, 0xFD, 0xF4});
+
+  RunResult result = CPU::Run(1 + 2 * 0x100);
+  EXPECT_EQ(result.cycles, 4 + 0x100 * (2 + 17) - 12u);
+
+  // Budgets in cycles stop at the first instruction reaching them
+  Load({0xB9, 0x00, 0x01, 0x40, 0xE2, 0xFD, 0xF4});
+
+  result = RunCycles(4 + 2 + 17);
+  EXPECT_EQ(result.retired, 3u);
+  EXPECT_EQ(result.cycles, 4 + 2 + 17u);
+
+  result = RunCycles(1);
+  EXPECT_EQ(result.retired, 1u);
+  EXPECT_EQ(result.cycles, 2u);
+}
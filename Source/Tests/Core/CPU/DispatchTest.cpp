@@ -0,0 +1,147 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/Memory.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace Core::CPU;
+
+// Covers every operand form the threaded interpreter specialises
+static const std::vector<u8> s_program = {
+    0xB8, 0xF0, 0x7F,       // MOV AX, 0x7FF0
+    0xBB, 0x10, 0x00,       // MOV BX, 0x0010
+    0xB1, 0x81,             // MOV CL, 0x81
+    0x01, 0xD8,             // ADD AX, BX
+    0x05, 0x20, 0x00,       // ADD AX, 0x0020
+    0x00, 0xCD,             // ADD CH, CL
+    0x03, 0x47, 0x02,       // ADD AX, [BX+0x02]
+    0x01, 0x47, 0x04,       // ADD [BX+0x04], AX
+    0x80, 0x47, 0x06, 0x90, // ADD byte [BX+0x06], 0x90
+    0x83, 0xC0, 0xF0,       // ADD AX, -0x10
+    0x83, 0x47, 0x04, 0x7F, // ADD word [BX+0x04], 0x7F
+    0x11, 0xD8,             // ADC AX, BX
+    0x14, 0x33,             // ADC AL, 0x33
+    0x29, 0xC3,             // SUB BX, AX
+    0x2D, 0x01, 0x00,       // SUB AX, 0x0001
+    0x2A, 0x6F, 0x01,       // SUB CH, [BX+0x01]
+    0x19, 0x47, 0x02,       // SBB [BX+0x02], AX
+    0x83, 0xDB, 0x80,       // SBB BX, -0x80
+    0x39, 0xD8,             // CMP AX, BX
+    0x3C, 0x80,             // CMP AL, 0x80
+    0x38, 0x4F, 0x07,       // CMP [BX+0x07], CL
+    0x21, 0xD8,             // AND AX, BX
+    0x24, 0x0F,             // AND AL, 0x0F
+    0x09, 0xC3,             // OR BX, AX
+    0x0C, 0xF0,             // OR AL, 0xF0
+    0x31, 0xC0,             // XOR AX, AX
+    0x32, 0x6F, 0x03,       // XOR CH, [BX+0x03]
+    0x85, 0xDB,             // TEST BX, BX
+    0xA8, 0x80,             // TEST AL, 0x80
+    0x40,                   // INC AX
+    0xFE, 0xC9,             // DEC CL
+    0xFF, 0x47, 0x08,       // INC word [BX+0x08]
+    0xFE, 0x4F, 0x0A,       // DEC byte [BX+0x0A]
+    0xF7, 0xD8,             // NEG AX
+    0xF6, 0x5F, 0x09,       // NEG byte [BX+0x09]
+    0xD1, 0xE0,             // SHL AX, 1
+    0xD2, 0xED,             // SHR CH, CL
+    0xD1, 0x47, 0x0B,       // ROL word [BX+0x0B], 1
+    0xD0, 0xC9,             // ROR CL, 1
+    0xD3, 0xCB,             // ROR BX, CL
+    0x89, 0x47, 0x0C,       // MOV [BX+0x0C], AX
+    0x8A, 0x57, 0x0C,       // MOV DL, [BX+0x0C]
+    0xC6, 0x47, 0x0E, 0x55, // MOV byte [BX+0x0E], 0x55
+    0x8E, 0xC3,             // MOV ES, BX
+    0x8C, 0xC6,             // MOV SI, ES
+    0x50,                   // PUSH AX
+    0x5F,                   // POP DI
+    0xF4,                   // HLT
+};
+
+struct Snapshot {
+  u16 ax, bx, cx, dx, si, di, sp, bp, cs, ds, es, ss, ip;
+  bool cf, of, sf, zf, pf;
+  std::vector<u8> data;
+
+  bool operator==(const Snapshot& o) const
+  {
+    return ax == o.ax && bx == o.bx && cx == o.cx && dx == o.dx &&
+           si == o.si && di == o.di && sp == o.sp && bp == o.bp &&
+           cs == o.cs && ds == o.ds && es == o.es && ss == o.ss &&
+           ip == o.ip && cf == o.cf && of == o.of && sf == o.sf &&
+           zf == o.zf && pf == o.pf && data == o.data;
+  }
+};
+
+static Snapshot RunProgram(DispatchMode mode)
+{
+  dispatch_mode = mode;
+  FlushInstructionCache();
+
+  auto& memory = Core::Memory::Get();
+  std::copy(s_program.begin(), s_program.end(),
+            memory.begin() + Core::Memory::VirtToPhys(0x1000, 0));
+
+  // The data segment gets reset for every run, so both see the same memory
+  const u32 data = Core::Memory::VirtToPhys(0x2000, 0);
+  for (u32 i = 0; i < 0x10000; i++)
+    memory[data + i] = static_cast<u8>(i * 37 + 11);
+
+  AX = BX = CX = DX = SI = DI = BP = 0;
+  CS = 0x1000;
+  IP = 0;
+  DS = ES = SS = 0x2000;
+  SP = 0x0100;
+  CF = OF = SF = ZF = PF = false;
+
+  while (Core::Memory::Read<u8>(CS, IP) != 0xF4)
+    Tick();
+
+  return {AX, BX, CX, DX, SI, DI, SP, BP, CS, DS, ES, SS, IP, CF, OF, SF, ZF, PF,
+          std::vector<u8>(memory.begin() + data,
+                          memory.begin() + data + 0x10000)};
+}
+
+TEST(Dispatch, ThreadedMatchesSwitch)
+{
+  const Snapshot reference = RunProgram(DispatchMode::Switch);
+  const Snapshot threaded = RunProgram(DispatchMode::Threaded);
+
+  ASSERT_TRUE(reference == threaded);
+  ASSERT_EQ(threaded.ip, s_program.size() - 1);
+}
+
+TEST(Dispatch, SpecialisedHandlers)
+{
+  // ADD AX, BX and ADD AX, [BX+SI] share nothing but the generic handler
+  Instruction reg(0x01);
+  ASSERT_TRUE(reg.Resolve(0xD8, nullptr));
+
+  Instruction mem(0x03);
+  ASSERT_TRUE(mem.Resolve(0x00, nullptr));
+
+  ASSERT_NE(SelectHandler(reg), SelectHandler(mem));
+  ASSERT_NE(SelectHandler(reg), &ADD);
+  ASSERT_NE(SelectHandler(mem), &ADD);
+
+  // Byte immediates of word operations get their own form
+  const u8 minus_one = 0xFF;
+  Instruction imm8(0x83);
+  ASSERT_TRUE(imm8.Resolve(0xC0, &minus_one));
+  ASSERT_NE(SelectHandler(imm8), &ADD);
+
+  Instruction shl(0xD1);
+  ASSERT_TRUE(shl.Resolve(0xE0, nullptr));
+  ASSERT_NE(SelectHandler(shl), &SHL);
+
+  // MUL has no specialisations
+  Instruction mul(0xF7);
+  ASSERT_TRUE(mul.Resolve(0xE3, nullptr));
+  ASSERT_EQ(SelectHandler(mul), &MUL);
+}
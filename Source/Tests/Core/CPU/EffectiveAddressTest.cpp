@@ -0,0 +1,117 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/EffectiveAddress.h"
+#include "Core/Memory.h"
+
+#include <array>
+
+#include <gtest/gtest.h>
+
+using namespace Core::CPU;
+using Prefix = Instruction::SegmentPrefix;
+
+// Decode a ModRM instruction from its bytes
+static Instruction Decode(const std::array<u8, 6>& bytes)
+{
+  Instruction ins(bytes[0]);
+  EXPECT_TRUE(ins.Resolve(bytes[1], &bytes[2]));
+
+  return ins;
+}
+
+// Address formula of the 8086 manuals, for every mod and rm
+static u16 Reference(u8 mod, u8 rm, u16 displacement)
+{
+  static const std::array<u16 (*)(), 8> bases = {
+      [] { return static_cast<u16>(BX + SI); },
+      [] { return static_cast<u16>(BX + DI); },
+      [] { return static_cast<u16>(BP + SI); },
+      [] { return static_cast<u16>(BP + DI); },
+      [] { return SI; },
+      [] { return DI; },
+      [] { return BP; },
+      [] { return BX; },
+  };
+
+  if (mod == 0 && rm == 6)
+    return displacement;
+
+  const u16 base = bases[rm]();
+
+  switch (mod) {
+  case 1:
+    return static_cast<u16>(base + static_cast<i8>(displacement));
+  case 2:
+    return static_cast<u16>(base + displacement);
+  default:
+    return base;
+  }
+}
+
+TEST(EffectiveAddress, AllForms)
+{
+  BX = 0x1234;
+  BP = 0xFF00;
+  SI = 0x0F0F;
+  DI = 0x8001;
+
+  for (u8 mod = 0; mod < 3; mod++) {
+    for (u8 rm = 0; rm < 8; rm++) {
+      // MOV AX, r/m16 with an 0x80 byte / 0xC080 word displacement, to catch
+      // missing sign extension and wrapping
+      const Instruction ins = Decode({0x8B, static_cast<u8>(mod << 6 | rm),
+                                      0x80, 0xC0, 0x00, 0x00});
+      const auto& src = ins.GetParameters()[1];
+
+      ASSERT_TRUE(src.IsMemory());
+      EXPECT_EQ(EffectiveOffset(src),
+                Reference(mod, rm, mod == 1 ? 0x80 : 0xC080))
+          << "mod " << int(mod) << " rm " << int(rm);
+    }
+  }
+}
+
+TEST(EffectiveAddress, DefaultSegment)
+{
+  // MOV AX, [BP+SI]
+  EXPECT_EQ(Decode({0x8B, 0x02, 0, 0, 0, 0}).GetSegment(), Prefix::SS);
+  // MOV AX, [BP+0x10]
+  EXPECT_EQ(Decode({0x8B, 0x46, 0x10, 0, 0, 0}).GetSegment(), Prefix::SS);
+  // MOV [BP+0x1000], AL
+  EXPECT_EQ(Decode({0x88, 0x86, 0x00, 0x10, 0, 0}).GetSegment(), Prefix::SS);
+  // MOV AX, [0x1234] takes the place of [BP] and uses DS
+  EXPECT_EQ(Decode({0x8B, 0x06, 0x34, 0x12, 0, 0}).GetSegment(), Prefix::DS);
+  // MOV AX, [BX+SI]
+  EXPECT_EQ(Decode({0x8B, 0x00, 0, 0, 0, 0}).GetSegment(), Prefix::DS);
+  // MOV AX, BP
+  EXPECT_EQ(Decode({0x8B, 0xC5, 0, 0, 0, 0}).GetSegment(), Prefix::DS);
+
+  // ES: MOV AX, [BP+DI]
+  Instruction prefixed(Instruction(0x26), 0x8B);
+  const u8 data[4] = {};
+  ASSERT_TRUE(prefixed.Resolve(0x03, data));
+  EXPECT_EQ(prefixed.GetSegment(), Prefix::ES);
+}
+
+TEST(EffectiveAddress, BPAddressesTheStack)
+{
+  auto& memory = Core::Memory::Get();
+
+  DS = 0x1000;
+  SS = 0x2000;
+  BP = 0x0010;
+  AX = 0;
+
+  memory[Core::Memory::VirtToPhys(DS, 0x000E)] = 0x11;
+  memory[Core::Memory::VirtToPhys(SS, 0x000E)] = 0x22;
+
+  // MOV AL, [BP-2]
+  const Instruction ins = Decode({0x8A, 0x46, 0xFE, 0, 0, 0});
+  MOV(ins);
+  EXPECT_EQ(AL, 0x22);
+
+  // LEA AX, [BP-2] only computes the offset
+  const Instruction lea = Decode({0x8D, 0x46, 0xFE, 0, 0, 0});
+  LEA(lea);
+  EXPECT_EQ(AX, 0x000E);
+}
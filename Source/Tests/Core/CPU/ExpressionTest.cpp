@@ -0,0 +1,119 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Expression.h"
+#include "Core/Memory.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace Core::CPU;
+
+static u32 Evaluate(const std::string& text)
+{
+  std::string error;
+  const auto expression = Expression::Compile(text, &error);
+
+  EXPECT_TRUE(expression) << text << ": " << error;
+
+  return expression ? expression->Evaluate() : 0xDEADBEEF;
+}
+
+static std::string Error(const std::string& text)
+{
+  std::string error;
+  EXPECT_FALSE(Expression::Compile(text, &error)) << text;
+
+  return error;
+}
+
+TEST(Expression, Arithmetic)
+{
+  EXPECT_EQ(Evaluate("1 + 2 * 3"), 7u);
+  EXPECT_EQ(Evaluate("(1 + 2) * 3"), 9u);
+  EXPECT_EQ(Evaluate("0x10 - 1"), 15u);
+  EXPECT_EQ(Evaluate("10 / 3"), 3u);
+  EXPECT_EQ(Evaluate("10 % 3"), 1u);
+  EXPECT_EQ(Evaluate("10 / 0"), 0u);
+  EXPECT_EQ(Evaluate("-1"), 0xFFFFFFFFu);
+  EXPECT_EQ(Evaluate("~0x0F & 0xFF"), 0xF0u);
+  EXPECT_EQ(Evaluate("1 << 4 | 1"), 17u);
+  EXPECT_EQ(Evaluate("0x12 ^ 0x10"), 2u);
+  EXPECT_EQ(Evaluate("0xFFFFFFFF"), 0xFFFFFFFFu);
+}
+
+TEST(Expression, Logic)
+{
+  EXPECT_EQ(Evaluate("1 < 2"), 1u);
+  EXPECT_EQ(Evaluate("2 <= 1"), 0u);
+  EXPECT_EQ(Evaluate("3 > 2 && 2 >= 2"), 1u);
+  EXPECT_EQ(Evaluate("1 == 2 || 3 != 3"), 0u);
+  EXPECT_EQ(Evaluate("!0"), 1u);
+  EXPECT_EQ(Evaluate("!!5"), 1u);
+  // Comparisons bind tighter than &, like in C
+  EXPECT_EQ(Evaluate("1 & 2 == 2"), 1u);
+}
+
+TEST(Expression, Registers)
+{
+  AX = 0x4C00;
+  BX = 0x1234;
+  CS = 0x1000;
+  IP = 0x0100;
+  CF = true;
+  ZF = false;
+  IF = true;
+
+  EXPECT_EQ(Evaluate("AX == 0x4C00"), 1u);
+  EXPECT_EQ(Evaluate("ah"), 0x4Cu);
+  EXPECT_EQ(Evaluate("bl + 1"), 0x35u);
+  EXPECT_EQ(Evaluate("cs << 4 | ip"), 0x10100u);
+  EXPECT_EQ(Evaluate("CF && !ZF && IF"), 1u);
+
+  // Compiled once, the current values get read every time
+  const auto expression = Expression::Compile("ax + 1");
+  ASSERT_TRUE(expression);
+  EXPECT_EQ(expression->Evaluate(), 0x4C01u);
+  AX = 1;
+  EXPECT_EQ(expression->Evaluate(), 2u);
+  EXPECT_EQ(expression->GetText(), "ax + 1");
+}
+
+TEST(Expression, Memory)
+{
+  auto& memory = Core::Memory::Get();
+  memory[0x20010] = 0x34;
+  memory[0x20011] = 0x12;
+
+  DS = 0x2000;
+  SI = 0x0010;
+
+  EXPECT_EQ(Evaluate("byte[ds:si]"), 0x34u);
+  EXPECT_EQ(Evaluate("word[DS:SI]"), 0x1234u);
+  EXPECT_EQ(Evaluate("word[0x20010]"), 0x1234u);
+  EXPECT_EQ(Evaluate("byte[ds:si + 1] == 0x12"), 1u);
+
+  // Past the end of memory
+  EXPECT_EQ(Evaluate("word[0xFFFF:0xFFFF]"), 0u);
+  EXPECT_FALSE(HasFault());
+}
+
+TEST(Expression, Errors)
+{
+  EXPECT_EQ(Error(""), "Unexpected end at column 1");
+  EXPECT_EQ(Error("ax =="), "Unexpected end at column 6");
+  EXPECT_EQ(Error("(1 + 2"), "Expected ')' at column 7");
+  EXPECT_EQ(Error("foo + 1"), "Unknown name 'foo' at column 1");
+  EXPECT_EQ(Error("1 2"), "Unexpected '2' at column 3");
+  EXPECT_EQ(Error("byte[ds:si"), "Expected ']' at column 11");
+  EXPECT_EQ(Error("0x"), "Expected digits at column 3");
+  EXPECT_EQ(Error("0x100000000"), "Number too large at column 11");
+  EXPECT_EQ(Error("ax = 1"), "Unexpected '=' at column 4");
+
+  std::string deep;
+  for (int i = 0; i < 40; i++)
+    deep += "1 + (";
+  deep += "1" + std::string(40, ')');
+
+  EXPECT_EQ(Error(deep), "Too deeply nested at column 242");
+}
@@ -0,0 +1,76 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Fault.h"
+#include "Core/Memory.h"
+#include "Tests/Core/Program.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace Core::CPU;
+namespace CPU = Core::CPU;
+
+TEST(Fault, RunCompletes)
+{
+  LoadProgram({0x90, 0x90, 0x90, 0xF4}); // NOP, NOP, NOP, HLT
+
+  const RunResult result = CPU::Run(3);
+  EXPECT_EQ(result.status, RunStatus::Completed);
+  EXPECT_EQ(result.retired, 3u);
+  EXPECT_EQ(IP, 3);
+  EXPECT_FALSE(HasFault());
+}
+
+TEST(Fault, RunStopsAtDecodeFault)
+{
+  LoadProgram({
+      0xB8, 0x01, 0x00, // MOV AX, 1
+      0x40,             // INC AX
+      0xFF, 0xE0,       // JMP AX, which isn't implemented
+      0x40,             // INC AX
+  });
+
+  const RunResult result = CPU::Run(100);
+  EXPECT_EQ(result.status, RunStatus::Fault);
+  EXPECT_EQ(result.retired, 2u);
+  EXPECT_EQ(AX, 2);
+  EXPECT_EQ(IP, 4);
+
+  const Fault& fault = GetFault();
+  EXPECT_EQ(fault.kind, FaultKind::Decode);
+  EXPECT_EQ(fault.segment, 0x1000);
+  EXPECT_EQ(fault.offset, 4);
+
+  // Nothing runs until the fault got taken care of
+  EXPECT_EQ(CPU::Run(100).status, RunStatus::Fault);
+  EXPECT_EQ(IP, 4);
+
+  EXPECT_THROW(ThrowFault(), UnhandledParameterException);
+  EXPECT_FALSE(HasFault());
+}
+
+TEST(Fault, TickThrows)
+{
+  LoadProgram({0xFF, 0xE0}); // JMP AX
+
+  EXPECT_THROW(Tick(), UnhandledParameterException);
+  EXPECT_FALSE(HasFault());
+}
+
+TEST(Fault, FirstFaultWins)
+{
+  LoadProgram({});
+
+  LAST_CS = 0x1000;
+  LAST_IP = 0x0010;
+  RaiseFault(FaultKind::UnhandledInterrupt, UnhandledInterruptException());
+
+  LAST_IP = 0x0020;
+  RaiseFault(FaultKind::JITMismatch,
+             JITMismatchException(0x1000, 0x0020, "mismatch"));
+
+  EXPECT_EQ(GetFault().kind, FaultKind::UnhandledInterrupt);
+  EXPECT_EQ(GetFault().offset, 0x0010);
+  EXPECT_THROW(ThrowFault(), UnhandledInterruptException);
+}
@@ -0,0 +1,130 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/Memory.h"
+
+#include <algorithm>
+#include <initializer_list>
+
+#include <gtest/gtest.h>
+
+using namespace Core::CPU;
+
+static void Load(u16 segment, u16 offset, std::initializer_list<u8> bytes)
+{
+  auto& memory = Core::Memory::Get();
+  std::copy(bytes.begin(), bytes.end(),
+            memory.begin() + Core::Memory::VirtToPhys(segment, offset));
+  Core::Memory::MarkWritten(segment, offset, static_cast<u32>(bytes.size()));
+}
+
+static void Execute(u16 segment, u16 offset, int count)
+{
+  CS = segment;
+  IP = offset;
+
+  for (int i = 0; i < count; i++)
+    Tick();
+}
+
+class InstructionCache : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    use_instruction_cache = true;
+    FlushInstructionCache();
+    ResetInstructionCacheStats();
+
+    DS = ES = SS = 0x3000;
+    SP = 0xFFFE;
+  }
+};
+
+TEST_F(InstructionCache, HitsOnReexecution)
+{
+  // MOV AX, 0x1234; MOV [0x0200], AX
+  Load(0x1000, 0, {0xB8, 0x34, 0x12, 0xA3, 0x00, 0x02});
+
+  Execute(0x1000, 0, 2);
+  ASSERT_EQ(GetInstructionCacheStats().misses, 2u);
+  ASSERT_EQ(GetInstructionCacheStats().hits, 0u);
+
+  Execute(0x1000, 0, 2);
+  ASSERT_EQ(GetInstructionCacheStats().misses, 2u);
+  ASSERT_EQ(GetInstructionCacheStats().hits, 2u);
+}
+
+TEST_F(InstructionCache, SelfModifyingCode)
+{
+  // MOV AX, 0x1111; MOV [CS:0x0001], BX
+  Load(0x1000, 0, {0xB8, 0x11, 0x11, 0x2E, 0x89, 0x1E, 0x01, 0x00});
+
+  Execute(0x1000, 0, 1);
+  ASSERT_EQ(AX, 0x1111);
+
+  BX = 0x2222;
+  Execute(0x1000, 3, 1);
+  ASSERT_EQ(GetInstructionCacheStats().invalidations, 1u);
+
+  Execute(0x1000, 0, 1);
+  ASSERT_EQ(AX, 0x2222);
+}
+
+TEST_F(InstructionCache, DataWritesNextToCode)
+{
+  // MOV [CS:0x0010], AX
+  Load(0x1000, 0, {0x2E, 0xA3, 0x10, 0x00});
+
+  for (int i = 0; i < 10; i++)
+    Execute(0x1000, 0, 1);
+
+  ASSERT_EQ(GetInstructionCacheStats().invalidations, 0u);
+  ASSERT_EQ(GetInstructionCacheStats().hits, 9u);
+}
+
+TEST_F(InstructionCache, ExternalWrites)
+{
+  // MOV AX, 0x1111
+  Load(0x1000, 0, {0xB8, 0x11, 0x11});
+  Execute(0x1000, 0, 1);
+
+  // Simulate a sector being loaded over the code
+  Load(0x1000, 0, {0xB8, 0x33, 0x33});
+  Execute(0x1000, 0, 1);
+
+  ASSERT_EQ(AX, 0x3333);
+  ASSERT_EQ(GetInstructionCacheStats().invalidations, 1u);
+}
+
+TEST_F(InstructionCache, Disabled)
+{
+  use_instruction_cache = false;
+
+  // MOV AX, 0x1234
+  Load(0x1000, 0, {0xB8, 0x34, 0x12});
+
+  Execute(0x1000, 0, 1);
+  Execute(0x1000, 0, 1);
+
+  ASSERT_EQ(GetInstructionCacheStats().hits, 0u);
+}
+
+TEST_F(InstructionCache, DecodesAcrossWraps)
+{
+  // MOV AX, 0x1234 at the end of the segment, the immediate at offset 0
+  Load(0x2000, 0xFFFE, {0xB8, 0x34});
+  Load(0x2000, 0x0000, {0x12});
+
+  const Instruction segment_wrap = DecodeInstruction(0x2000, 0xFFFE);
+  EXPECT_EQ(segment_wrap.GetSize(), 3u);
+  EXPECT_EQ(segment_wrap.GetParameters()[1].GetData<u16>(), 0x1234);
+
+  // MOV BX, [0x5678] at the end of memory, continuing at address 0
+  Load(0xFFFF, 0x000E, {0x8B, 0x1E});
+  Load(0x0000, 0x0000, {0x78, 0x56});
+
+  const Instruction memory_wrap = DecodeInstruction(0xFFFF, 0x000E);
+  EXPECT_EQ(memory_wrap.GetSize(), 4u);
+  EXPECT_EQ(memory_wrap.GetParameters()[1].GetData<u16>(), 0x5678);
+}
@@ -0,0 +1,125 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Instruction.h"
+#include "Core/Memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+using Core::CPU::Instruction;
+
+static std::atomic<u64> s_allocations{0};
+
+void* operator new(std::size_t size)
+{
+  s_allocations++;
+
+  if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    return ptr;
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+TEST(Instruction, TriviallyCopyable)
+{
+  ASSERT_TRUE(std::is_trivially_copyable_v<Instruction>);
+}
+
+TEST(Instruction, ResolveFromPointer)
+{
+  // MOV [BX+SI+0x04], AX
+  const u8 bytes[] = {0x89, 0x40, 0x04};
+
+  Instruction ins(bytes[0]);
+  ASSERT_FALSE(ins.IsResolved());
+  ASSERT_EQ(ins.GetLength(bytes[1]), 1);
+  ASSERT_TRUE(ins.Resolve(bytes[1], &bytes[2]));
+
+  ASSERT_EQ(ins.GetParameterCount(), 2);
+  ASSERT_EQ(ins.GetSize(), sizeof(bytes));
+  ASSERT_EQ(ins.GetParameters()[0].GetType(),
+            Instruction::Parameter::Type::Value_BX_SI_Offset_Word);
+  ASSERT_EQ(ins.GetParameters()[0].GetData<u8>(), 0x04);
+  ASSERT_EQ(ins.GetParameters()[1].GetType(),
+            Instruction::Parameter::Type::AX);
+}
+
+TEST(Instruction, ImmediateFollowsDisplacement)
+{
+  // ADD byte [BX+0x02], 0x05
+  const u8 bytes[] = {0x80, 0x47, 0x02, 0x05};
+
+  Instruction ins(bytes[0]);
+  ASSERT_EQ(ins.GetLength(bytes[1]), 2);
+  ASSERT_TRUE(ins.Resolve(bytes[1], &bytes[2]));
+
+  ASSERT_EQ(ins.GetType(), Instruction::Type::ADD);
+  ASSERT_EQ(ins.GetParameters()[0].GetData<u8>(), 0x02);
+  ASSERT_EQ(ins.GetParameters()[1].GetData<u8>(), 0x05);
+}
+
+TEST(Instruction, RepeatPrefix)
+{
+  // ES: REP STOSW
+  Instruction ins(0x26);
+  ins = Instruction(ins, 0xF3);
+  ins = Instruction(ins, 0xAB);
+
+  ASSERT_EQ(ins.GetType(), Instruction::Type::STOSW);
+  ASSERT_EQ(ins.GetPrefix(), Instruction::SegmentPrefix::ES);
+  ASSERT_EQ(ins.GetRepeatMode(), Core::CPU::RepeatMode::Repeat);
+  ASSERT_EQ(ins.GetSize(), 3);
+
+  // REPZ CMPSB
+  ins = Instruction(Instruction(0xF3), 0xA6);
+  ASSERT_EQ(ins.GetRepeatMode(), Core::CPU::RepeatMode::Repeat_Zero);
+}
+
+TEST(Instruction, TickDoesNotAllocate)
+{
+  // clang-format off
+  const u8 program[] = {
+    0xB8, 0x34, 0x12,       // MOV AX, 0x1234
+    0x01, 0xD8,             // ADD AX, BX
+    0x89, 0x40, 0x04,       // MOV [BX+SI+0x04], AX
+    0x80, 0x47, 0x02, 0x05, // ADD byte [BX+0x02], 0x05
+    0x40,                   // INC AX
+    0xB9, 0x04, 0x00,       // MOV CX, 0x0004
+    0xF3, 0xAB,             // REP STOSW
+    0xEB, 0xEC,             // JMP short 0x0000
+  };
+  // clang-format on
+
+  using namespace Core::CPU;
+
+  auto& memory = Core::Memory::Get();
+  std::copy(std::begin(program), std::end(program),
+            memory.begin() + Core::Memory::VirtToPhys(0x1000, 0));
+
+  CS = 0x1000;
+  IP = 0;
+  DS = ES = SS = 0x2000;
+  BX = SI = DI = 0;
+
+  // Warm up anything that is lazily initialized
+  for (int i = 0; i < 8; i++)
+    Tick();
+
+  ASSERT_EQ(IP, 0);
+
+  const u64 before = s_allocations;
+
+  for (int i = 0; i < 8 * 1000; i++)
+    Tick();
+
+  ASSERT_EQ(s_allocations - before, 0u);
+  ASSERT_EQ(IP, 0);
+}
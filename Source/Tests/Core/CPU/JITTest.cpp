@@ -0,0 +1,188 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/JIT.h"
+#include "Core/Memory.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace Core::CPU;
+
+// Mixes inlined moves, specialised and generic handlers, the stack and memory
+static const std::vector<u8> s_loop = {
+    0xB9, 0x00, 0x02,       // MOV CX, 0x0200
+    0xBE, 0x00, 0x00,       // MOV SI, 0x0000
+    0x8B, 0x04,             // MOV AX, [SI]
+    0x01, 0xC8,             // ADD AX, CX
+    0x89, 0x04,             // MOV [SI], AX
+    0x11, 0xC2,             // ADC DX, AX
+    0x46,                   // INC SI
+    0x46,                   // INC SI
+    0x81, 0xE6, 0xFF, 0x00, // AND SI, 0x00FF
+    0x88, 0xC3,             // MOV BL, AL
+    0x30, 0xDF,             // XOR BH, BL
+    0xF5,                   // CMC
+    0xBD, 0x34, 0x12,       // MOV BP, 0x1234
+    0x50,                   // PUSH AX
+    0x5F,                   // POP DI
+    0xE2, 0xE6,             // LOOP 0x0006
+    0xF4,                   // HLT
+};
+
+// Increments the immediate of its own ADD on every iteration
+static const std::vector<u8> s_self_modifying = {
+    0xB9, 0x40, 0x00,       // MOV CX, 0x0040
+    0x05, 0x01, 0x00,       // ADD AX, 0x0001
+    0xFE, 0x06, 0x04, 0x00, // INC byte [0x0004]
+    0xE2, 0xF7,             // LOOP 0x0003
+    0xF4,                   // HLT
+};
+
+struct Snapshot {
+  std::vector<u16> registers;
+  std::vector<bool> flags;
+  std::vector<u8> memory;
+  u64 cycles = 0;
+  u64 retired = 0;
+
+  bool operator==(const Snapshot& o) const
+  {
+    return registers == o.registers && flags == o.flags &&
+           memory == o.memory && cycles == o.cycles && retired == o.retired;
+  }
+};
+
+static Snapshot RunProgram(const std::vector<u8>& program, u16 data_segment)
+{
+  FlushInstructionCache();
+  FlushTranslations();
+
+  auto& memory = Core::Memory::Get();
+  std::fill(memory.begin(), memory.end(), 0);
+  std::copy(program.begin(), program.end(),
+            memory.begin() + Core::Memory::VirtToPhys(0x1000, 0));
+
+  AX = BX = CX = DX = SI = DI = BP = 0;
+  CS = 0x1000;
+  IP = 0;
+  DS = ES = data_segment;
+  SS = 0x3000;
+  SP = 0x0100;
+  AF = CF = OF = SF = ZF = PF = false;
+  cycles = 0;
+
+  u64 retired = 0;
+
+  // Stop right after the HLT
+  while (IP != program.size()) {
+    if (const u32 block = ExecuteBlock()) {
+      retired += block;
+    } else {
+      Tick();
+      retired++;
+    }
+  }
+
+  return {{AX, BX, CX, DX, SI, DI, BP, SP, CS, DS, ES, SS, IP},
+          {AF, CF, OF, SF, ZF, PF},
+          {memory.begin(), memory.end()},
+          cycles,
+          retired};
+}
+
+static Snapshot Interpret(const std::vector<u8>& program, u16 data_segment)
+{
+  use_jit = false;
+  return RunProgram(program, data_segment);
+}
+
+static Snapshot Translate(const std::vector<u8>& program, u16 data_segment,
+                          bool lockstep)
+{
+  use_jit = true;
+  jit_lockstep = lockstep;
+  ResetJITStats();
+
+  const Snapshot snapshot = RunProgram(program, data_segment);
+
+  use_jit = false;
+  jit_lockstep = false;
+
+  return snapshot;
+}
+
+TEST(JIT, MatchesInterpreter)
+{
+  if (!IsJITAvailable())
+    GTEST_SKIP();
+
+  const Snapshot reference = Interpret(s_loop, 0x2000);
+  const Snapshot translated = Translate(s_loop, 0x2000, false);
+
+  ASSERT_TRUE(reference == translated);
+
+  const JITStats stats = GetJITStats();
+  ASSERT_GT(stats.translations, 0u);
+  ASSERT_GT(stats.links, 0u);
+  // Most of the 0x200 iterations should have run as host code
+  ASSERT_GT(stats.executions, 0x100u);
+  ASSERT_GT(stats.instructions, stats.executions);
+}
+
+// Resets the statistics in the middle of every block reading its data
+static const Core::Memory::Device s_reset_stats = {
+    [](u32, u32) { ResetJITStats(); },
+    nullptr,
+};
+
+TEST(JIT, RetiredInstructionsIgnoreStats)
+{
+  if (!IsJITAvailable())
+    GTEST_SKIP();
+
+  Core::Memory::MapDevice(0x20000, Core::Memory::PAGE_SIZE, s_reset_stats);
+
+  const Snapshot reference = Interpret(s_loop, 0x2000);
+  const Snapshot translated = Translate(s_loop, 0x2000, false);
+
+  Core::Memory::MapRAM(0x20000, Core::Memory::PAGE_SIZE);
+
+  // 2 instructions before the loop, 14 in every iteration and the HLT
+  ASSERT_EQ(reference.retired, 2u + 14u * 0x200 + 1u);
+  ASSERT_TRUE(reference == translated);
+}
+
+TEST(JIT, Lockstep)
+{
+  if (!IsJITAvailable())
+    GTEST_SKIP();
+
+  const Snapshot reference = Interpret(s_loop, 0x2000);
+  Snapshot translated;
+
+  ASSERT_NO_THROW(translated = Translate(s_loop, 0x2000, true));
+  ASSERT_TRUE(reference == translated);
+}
+
+TEST(JIT, SelfModifyingCode)
+{
+  if (!IsJITAvailable())
+    GTEST_SKIP();
+
+  const Snapshot reference = Interpret(s_self_modifying, 0x1000);
+  ASSERT_EQ(reference.registers[0], 0x0820);
+
+  const Snapshot translated = Translate(s_self_modifying, 0x1000, false);
+  ASSERT_TRUE(reference == translated);
+
+  // Code of the overwritten blocks gets reused instead of filling the arena
+  const JITStats stats = GetJITStats();
+  ASSERT_GT(stats.invalidations, 0u);
+  ASSERT_GT(stats.reclaimed, 0u);
+  ASSERT_EQ(stats.flushes, 0u);
+
+  ASSERT_NO_THROW(Translate(s_self_modifying, 0x1000, true));
+}
@@ -0,0 +1,316 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/Instructions/Operations.h"
+#include "Core/Memory.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace Core::CPU;
+
+enum class Op { Add, Adc, Sub, Sbb, Cmp, And, Test, Or, Xor, Inc, Dec, Neg };
+
+constexpr Op ALL_OPS[] = {Op::Add, Op::Adc, Op::Sub, Op::Sbb,
+                          Op::Cmp, Op::And, Op::Test, Op::Or,
+                          Op::Xor, Op::Inc, Op::Dec, Op::Neg};
+
+struct Flags {
+  bool cf, pf, af, zf, sf, of;
+
+  bool operator==(const Flags& o) const
+  {
+    return cf == o.cf && pf == o.pf && af == o.af && zf == o.zf &&
+           sf == o.sf && of == o.of;
+  }
+};
+
+static std::ostream& operator<<(std::ostream& os, const Flags& f)
+{
+  return os << "CF=" << f.cf << " PF=" << f.pf << " AF=" << f.af
+            << " ZF=" << f.zf << " SF=" << f.sf << " OF=" << f.of;
+}
+
+static Flags ReadFlags() { return {CF, PF, AF, ZF, SF, OF}; }
+
+// Straightforward eager implementation to compare against
+template <typename T> static Flags Reference(Op op, T a, T b, bool carry)
+{
+  using S = std::make_signed_t<T>;
+
+  const i32 mask = std::numeric_limits<T>::max();
+  const i32 sa = static_cast<S>(a);
+  const i32 sb = static_cast<S>(b);
+
+  i32 result = 0;
+  i32 signed_result = 0;
+  bool cf = false;
+  bool af = false;
+  bool of = false;
+
+  switch (op) {
+  case Op::Adc:
+  case Op::Add:
+  case Op::Inc: {
+    const i32 c = op == Op::Adc ? carry : 0;
+    const i32 rhs = op == Op::Inc ? 1 : b;
+    const i32 signed_rhs = op == Op::Inc ? 1 : sb;
+
+    result = a + rhs + c;
+    signed_result = sa + signed_rhs + c;
+    cf = op == Op::Inc ? carry : result > mask;
+    af = (a & 0xF) + (rhs & 0xF) + c > 0xF;
+    of = signed_result < std::numeric_limits<S>::min() ||
+         signed_result > std::numeric_limits<S>::max();
+    break;
+  }
+  case Op::Sbb:
+  case Op::Sub:
+  case Op::Cmp:
+  case Op::Dec:
+  case Op::Neg: {
+    const i32 c = op == Op::Sbb ? carry : 0;
+    i32 lhs = a, signed_lhs = sa, rhs = b, signed_rhs = sb;
+
+    if (op == Op::Dec)
+      rhs = signed_rhs = 1;
+
+    if (op == Op::Neg) {
+      lhs = signed_lhs = 0;
+      rhs = a;
+      signed_rhs = sa;
+    }
+
+    result = lhs - rhs - c;
+    signed_result = signed_lhs - signed_rhs - c;
+    cf = op == Op::Dec ? carry : result < 0;
+    af = (lhs & 0xF) - (rhs & 0xF) - c < 0;
+    of = signed_result < std::numeric_limits<S>::min() ||
+         signed_result > std::numeric_limits<S>::max();
+    break;
+  }
+  case Op::And:
+  case Op::Test:
+    result = a & b;
+    break;
+  case Op::Or:
+    result = a | b;
+    break;
+  case Op::Xor:
+    result = a ^ b;
+    break;
+  }
+
+  result &= mask;
+
+  u32 bits = 0;
+
+  for (u32 i = 0; i < 8; i++)
+    bits += (result >> i) & 1;
+
+  return {cf,
+          bits % 2 == 0,
+          af,
+          result == 0,
+          (result & (1 << (sizeof(T) * 8 - 1))) != 0,
+          of};
+}
+
+template <typename T> static T Apply(Op op, T a, T b)
+{
+  switch (op) {
+  case Op::Add:
+    Operations::Add::Apply(a, b);
+    break;
+  case Op::Adc:
+    Operations::Adc::Apply(a, b);
+    break;
+  case Op::Sub:
+    Operations::Sub::Apply(a, b);
+    break;
+  case Op::Sbb:
+    Operations::Sbb::Apply(a, b);
+    break;
+  case Op::Cmp:
+    Operations::Cmp::Apply(a, b);
+    break;
+  case Op::And:
+    Operations::And::Apply(a, b);
+    break;
+  case Op::Test:
+    Operations::Test::Apply(a, b);
+    break;
+  case Op::Or:
+    Operations::Or::Apply(a, b);
+    break;
+  case Op::Xor:
+    Operations::Xor::Apply(a, b);
+    break;
+  case Op::Inc:
+    Operations::Inc::Apply(a);
+    break;
+  case Op::Dec:
+    Operations::Dec::Apply(a);
+    break;
+  case Op::Neg:
+    Operations::Neg::Apply(a);
+    break;
+  }
+
+  return a;
+}
+
+template <typename T> static void Check(Op op, T a, T b, bool carry)
+{
+  CF = carry;
+  Apply(op, a, b);
+
+  ASSERT_EQ(ReadFlags(), Reference(op, a, b, carry))
+      << "op " << static_cast<int>(op) << " a " << static_cast<int>(a)
+      << " b " << static_cast<int>(b) << " carry " << carry;
+}
+
+TEST(LazyFlags, SZPTable)
+{
+  for (u32 value = 0; value < 0x10000; value++) {
+    const auto expected = Reference<u16>(Op::Or, value, 0, false);
+    const u8 flags = SZPFlags<u16>(value);
+
+    ASSERT_EQ((flags & FLAG_SF) != 0, expected.sf);
+    ASSERT_EQ((flags & FLAG_ZF) != 0, expected.zf);
+    ASSERT_EQ((flags & FLAG_PF) != 0, expected.pf);
+  }
+}
+
+TEST(LazyFlags, ExhaustiveByteOperations)
+{
+  for (Op op : ALL_OPS) {
+    for (u32 a = 0; a < 0x100; a++) {
+      for (u32 b = 0; b < 0x100; b++) {
+        for (bool carry : {false, true})
+          Check<u8>(op, a, b, carry);
+      }
+    }
+  }
+}
+
+TEST(LazyFlags, RandomizedWordOperations)
+{
+  std::mt19937 rng(0x8086);
+  std::uniform_int_distribution<u32> word(0, 0xFFFF);
+
+  const std::vector<u16> edges = {0x0000, 0x0001, 0x000F, 0x0010, 0x007F,
+                                  0x0080, 0x00FF, 0x0100, 0x7FFF, 0x8000,
+                                  0x8001, 0xFFFE, 0xFFFF};
+
+  for (Op op : ALL_OPS) {
+    for (u16 a : edges) {
+      for (u16 b : edges) {
+        Check<u16>(op, a, b, false);
+        Check<u16>(op, a, b, true);
+      }
+    }
+
+    for (u32 i = 0; i < 100'000; i++)
+      Check<u16>(op, word(rng), word(rng), i & 1);
+  }
+}
+
+TEST(LazyFlags, MaterializedOnRead)
+{
+  u8 value = 0xFF;
+  Operations::Add::Apply<u8>(value, 1);
+
+  ASSERT_EQ(lazy_flags.pending, FLAGS_ARITHMETIC);
+
+  MaterializeFlags(FLAG_ZF | FLAG_CF);
+  ASSERT_EQ(lazy_flags.pending, FLAGS_ARITHMETIC & ~(FLAG_ZF | FLAG_CF));
+
+  ASSERT_TRUE(ZF);
+  ASSERT_TRUE(CF);
+  ASSERT_EQ(lazy_flags.pending, FLAGS_ARITHMETIC & ~(FLAG_ZF | FLAG_CF));
+
+  // Reading a pending flag derives the others as well
+  ASSERT_FALSE(SF);
+  ASSERT_EQ(lazy_flags.pending, 0);
+  ASSERT_TRUE(AF);
+}
+
+TEST(LazyFlags, PeekLeavesStateAlone)
+{
+  u8 value = 0x7F;
+  Operations::Add::Apply<u8>(value, 1);
+  SF = false;
+
+  const LazyFlagState before = lazy_flags;
+
+  ASSERT_TRUE(OF.Peek());
+  ASSERT_FALSE(ZF.Peek());
+  ASSERT_FALSE(SF.Peek());
+  ASSERT_EQ(PeekFlags(lazy_flags), FLAG_OF | FLAG_AF);
+
+  ASSERT_EQ(lazy_flags.pending, before.pending);
+  ASSERT_EQ(lazy_flags.values, before.values);
+  ASSERT_EQ(ReadFlags(), (Flags{false, false, true, false, false, true}));
+}
+
+TEST(LazyFlags, IncKeepsPendingCarry)
+{
+  u16 value = 0xFFFF;
+  Operations::Add::Apply<u16>(value, 1);
+
+  // CF has to be derived from the ADD before INC replaces the record
+  Operations::Inc::Apply(value);
+
+  ASSERT_TRUE(CF);
+  ASSERT_FALSE(ZF);
+  ASSERT_EQ(value, 1);
+}
+
+TEST(LazyFlags, WritesOverridePendingFlags)
+{
+  u8 value = 0x80;
+  Operations::Sub::Apply<u8>(value, 1);
+
+  CF = true;
+  OF = false;
+
+  ASSERT_TRUE(CF);
+  ASSERT_FALSE(OF);
+  ASSERT_TRUE(AF);
+}
+
+TEST(LazyFlags, PushfMaterializes)
+{
+  FlushInstructionCache();
+
+  auto& memory = Core::Memory::Get();
+  std::fill(memory.begin(), memory.end(), 0);
+
+  const std::vector<u8> program = {
+      0x00, 0xD8, // ADD AL, BL
+      0x9C,       // PUSHF
+  };
+
+  std::copy(program.begin(), program.end(), memory.begin());
+
+  CS = DS = ES = 0;
+  SS = 0x1000;
+  SP = 0x0100;
+  IP = 0;
+  AL = 0x80;
+  BL = 0x80;
+
+  Tick();
+  Tick();
+
+  const u16 flags = Core::Memory::Read<u16>(SS, SP);
+
+  // CF, PF, ZF and OF
+  ASSERT_EQ(flags & 0x08D5, 0x0845);
+}
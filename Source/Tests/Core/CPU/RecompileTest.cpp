@@ -0,0 +1,170 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/Recompiled.h"
+#include "Core/Core.h"
+#include "Core/Memory.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace Core::CPU;
+
+// Generated at build time from Data/RecompileTest.com:
+//
+// 0100 MOV CX, 0x0100
+// 0103 XOR SI, SI
+// 0105 MOV AX, [SI+0x0300]
+// 0109 ADD AX, CX
+// 010B MOV [SI+0x0300], AX
+// 010F ADC DX, AX
+// 0111 CALL 0x0125
+// 0114 INC SI
+// 0115 AND SI, 0x00FF
+// 0119 MOV BL, AL
+// 011B XOR BH, BL
+// 011D CMC
+// 011E LOOP 0x0105
+// 0120 MOV AX, 0x0131
+// 0123 PUSH AX
+// 0124 RET              ; 0131 is only reachable at runtime
+// 0125 XOR DX, CX
+// 0127 SUB BP, DX
+// 0129 CMP DX, 0x1234
+// 012D JZ 0x0130
+// 012F INC DI
+// 0130 RET
+// 0131 MOV BX, 0x0005
+// 0134 MOV CX, 0x0003
+// 0137 CALL 0x0125
+// 013A LOOP 0x0137
+// 013C MOV byte [0x0125], 0x31 ; Overwrites translated code
+// 0141 CALL 0x0125
+// 0144 HLT
+extern const RecompiledProgram recompiled_test;
+
+struct Snapshot {
+  std::vector<u16> registers;
+  std::vector<bool> flags;
+  std::vector<u8> memory;
+
+  bool operator==(const Snapshot& o) const
+  {
+    return registers == o.registers && flags == o.flags && memory == o.memory;
+  }
+};
+
+static void Load()
+{
+  FlushInstructionCache();
+  UninstallRecompiledProgram();
+
+  auto& memory = Core::Memory::Get();
+  std::fill(memory.begin(), memory.end(), 0);
+
+  Core::LoadCOM(recompiled_test.image, recompiled_test.image_size);
+
+  AX = BX = CX = DX = SI = DI = BP = 0;
+  CS = ES = 0;
+  SS = 0x3000;
+  SP = 0x0100;
+  AF = CF = OF = SF = ZF = PF = false;
+}
+
+static Snapshot Finish()
+{
+  const auto& memory = Core::Memory::Get();
+
+  return {{AX, BX, CX, DX, SI, DI, BP, SP, CS, DS, ES, SS, IP},
+          {AF, CF, OF, SF, ZF, PF},
+          std::vector<u8>(memory.begin(), memory.begin() + 0x40000)};
+}
+
+// Right behind the HLT
+constexpr u16 END = 0x0145;
+
+constexpr u32 NO_INSTRUCTION_LIMIT = std::numeric_limits<u32>::max();
+constexpr u64 NO_CYCLE_LIMIT = std::numeric_limits<u64>::max();
+
+static u32 ExecuteUnlimited()
+{
+  return ExecuteRecompiled(NO_INSTRUCTION_LIMIT, NO_CYCLE_LIMIT);
+}
+
+TEST(Recompile, MatchesInterpreter)
+{
+  Load();
+
+  while (IP != END)
+    Tick();
+
+  const Snapshot reference = Finish();
+
+  Load();
+  InstallRecompiledProgram(recompiled_test, 0x0000);
+
+  u32 native = 0;
+
+  while (IP != END) {
+    if (ExecuteUnlimited())
+      native++;
+    else
+      Tick();
+  }
+
+  const Snapshot recompiled = Finish();
+
+  ASSERT_TRUE(reference == recompiled);
+  ASSERT_GT(native, 0u);
+}
+
+TEST(Recompile, StopsAtLimits)
+{
+  Load();
+  InstallRecompiledProgram(recompiled_test, 0x0000);
+
+  // Straight into the loop at 0105, which doesn't leave translated code
+  ASSERT_EQ(ExecuteRecompiled(5, NO_CYCLE_LIMIT), 5u);
+  ASSERT_EQ(IP, 0x010F);
+
+  ASSERT_EQ(ExecuteRecompiled(1, NO_CYCLE_LIMIT), 1u);
+  ASSERT_EQ(IP, 0x0111);
+
+  // The limit is reached once the first instruction's cycles are counted
+  ASSERT_EQ(ExecuteRecompiled(NO_INSTRUCTION_LIMIT, cycles + 1), 1u);
+  ASSERT_EQ(IP, 0x0125);
+}
+
+TEST(Recompile, OverwrittenCodeFallsBack)
+{
+  Load();
+  InstallRecompiledProgram(recompiled_test, 0x0000);
+
+  ASSERT_TRUE(IsRecompiledCodeValid());
+
+  // Writes next to the code are fine
+  Core::Memory::Get<u8>(0x0000, 0x0145) = 0x90;
+  ASSERT_TRUE(IsRecompiledCodeValid());
+
+  Core::Memory::Get<u8>(0x0000, 0x0125) = 0x31;
+  ASSERT_FALSE(IsRecompiledCodeValid());
+  ASSERT_FALSE(ExecuteUnlimited());
+}
+
+TEST(Recompile, UntranslatedCode)
+{
+  Load();
+  InstallRecompiledProgram(recompiled_test, 0x0000);
+
+  // Only reached through RET, so the interpreter has to run it
+  IP = 0x0131;
+  ASSERT_FALSE(ExecuteUnlimited());
+
+  // Different segment
+  IP = 0x0100;
+  CS = 0x1000;
+  ASSERT_FALSE(ExecuteUnlimited());
+}
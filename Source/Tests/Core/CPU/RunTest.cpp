@@ -0,0 +1,300 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Breakpoint.h"
+#include "Core/HW/VGA.h"
+#include "Core/Memory.h"
+#include "Tests/Core/Program.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Core::CPU;
+namespace CPU = Core::CPU;
+
+// MOV CX, 0x0100; INC AX; LOOP -3; HLT
+static const std::vector<u8> s_loop = {0xB9, 0x00, 0x01, 0x40,
+                                       0xE2, 0xFD, 0xF4};
+
+TEST(Run, RetiresBatch)
+{
+  LoadProgram(s_loop);
+  AX = 0;
+
+  RunResult result = CPU::Run(101);
+  EXPECT_EQ(result.status, RunStatus::Completed);
+  EXPECT_EQ(result.retired, 101u);
+  EXPECT_EQ(AX, 50);
+
+  // The rest of the loop and the HLT, which stops the CPU
+  result = CPU::Run(1000);
+  EXPECT_EQ(result.status, RunStatus::Stopped);
+  EXPECT_EQ(result.retired, 1 + 2 * 0x100 + 1 - 101u);
+  EXPECT_EQ(AX, 0x100);
+
+  // Stopping got reported, so the next batch runs again
+  LoadProgram(s_loop);
+  EXPECT_EQ(CPU::Run(1).retired, 1u);
+}
+
+TEST(Run, Pause)
+{
+  LoadProgram(s_loop);
+
+  SetPaused(true);
+  RunResult result = CPU::Run(10);
+  EXPECT_EQ(result.status, RunStatus::Paused);
+  EXPECT_EQ(result.retired, 0u);
+  EXPECT_EQ(IP, 0);
+
+  SetPaused(false);
+  result = CPU::Run(10);
+  EXPECT_EQ(result.status, RunStatus::Completed);
+  EXPECT_EQ(result.retired, 10u);
+}
+
+TEST(Run, StalePauseIsIgnored)
+{
+  LoadProgram(s_loop);
+
+  // What a breakpoint pausing on the CPU thread while the UI resumes could
+  // leave behind
+  SetPaused(false);
+  RequestWork(PENDING_PAUSE);
+
+  const RunResult result = CPU::Run(10);
+  EXPECT_EQ(result.status, RunStatus::Completed);
+  EXPECT_EQ(result.retired, 10u);
+  EXPECT_FALSE(pending_work & PENDING_PAUSE);
+}
+
+TEST(Run, Breakpoint)
+{
+  LoadProgram(s_loop);
+
+  AddBreakpoint({0x1000, 0x0004});
+
+  RunResult result = CPU::Run(10);
+  EXPECT_EQ(result.status, RunStatus::Breakpoint);
+  EXPECT_EQ(result.retired, 2u);
+  EXPECT_EQ(IP, 4);
+  EXPECT_TRUE(IsPaused());
+
+  // Continuing from the breakpoint runs the instruction there
+  SetPaused(false);
+  result = CPU::Run(1);
+  EXPECT_EQ(result.status, RunStatus::Completed);
+  EXPECT_EQ(IP, 3);
+
+  RemoveBreakpoint({0x1000, 0x0004});
+  EXPECT_FALSE(HasPendingWork());
+
+  EXPECT_EQ(CPU::Run(20).retired, 20u);
+}
+
+TEST(Run, Refresh)
+{
+  // MOV [0x8000], AL; INC AX
+  LoadProgram({0xA2, 0x00, 0x80, 0x40});
+
+  DS = 0xB000;
+  Core::HW::VGA::Init();
+
+  RunResult result = CPU::Run(10);
+  EXPECT_EQ(result.status, RunStatus::Refresh);
+  EXPECT_EQ(result.retired, 1u);
+
+  result = CPU::Run(1);
+  EXPECT_EQ(result.status, RunStatus::Completed);
+  EXPECT_EQ(IP, 4);
+
+  DS = 0;
+}
+
+TEST(Run, Interrupt)
+{
+  LoadProgram(s_loop);
+
+  // Nothing handles vector 0x99, which makes taking it visible as a fault
+  IF = false;
+  RequestInterrupt(0x99);
+
+  RunResult result = CPU::Run(10);
+  EXPECT_EQ(result.status, RunStatus::Completed);
+  EXPECT_EQ(result.retired, 10u);
+
+  IF = true;
+  result = CPU::Run(10);
+  EXPECT_EQ(result.status, RunStatus::Fault);
+  EXPECT_EQ(result.retired, 0u);
+  EXPECT_EQ(GetFault().kind, FaultKind::UnhandledInterrupt);
+
+  ClearFault();
+  EXPECT_FALSE(HasPendingWork());
+}
+
+TEST(Run, HaltWaitsForInterrupt)
+{
+  // STI; HLT; INC AX
+  LoadProgram({0xFB, 0xF4, 0x40});
+  AX = 0x0100;
+  AddInterruptSource();
+
+  RunResult result = CPU::Run(10);
+  EXPECT_EQ(result.status, RunStatus::Halted);
+  EXPECT_EQ(result.retired, 2u);
+
+  // Still halted
+  EXPECT_EQ(CPU::Run(10).status, RunStatus::Halted);
+
+  // INT 16h AH=01 is handled, so taking it ends HLT
+  RequestInterrupt(0x16);
+  result = CPU::Run(1);
+  EXPECT_EQ(result.status, RunStatus::Completed);
+  EXPECT_EQ(AX, 0x0101);
+  EXPECT_FALSE(HasPendingWork());
+
+  // Without interrupts HLT stops the CPU for good
+  LoadProgram({0xFA, 0xF4});
+  EXPECT_EQ(CPU::Run(10).status, RunStatus::Stopped);
+
+  // So it does when nothing could raise one
+  RemoveInterruptSource();
+  LoadProgram({0xFB, 0xF4});
+  EXPECT_EQ(CPU::Run(10).status, RunStatus::Stopped);
+}
+
+TEST(Run, IdleKeyboardPolling)
+{
+  // MOV AH, 1; INT 16h; JZ 0
+  LoadProgram({0xB4, 0x01, 0xCD, 0x16, 0x74, 0xFA});
+
+  RunResult result = CPU::Run(1000);
+  EXPECT_EQ(result.status, RunStatus::Idle);
+  EXPECT_LT(result.retired, 100u);
+
+  // Keeps idling while the loop goes on
+  EXPECT_EQ(CPU::Run(1000).status, RunStatus::Idle);
+}
+
+TEST(Run, IdleTimeGrows)
+{
+  // MOV AH, 1; INT 16h; JZ 0
+  LoadProgram({0xB4, 0x01, 0xCD, 0x16, 0x74, 0xFA});
+
+  // Long enough since the last poll of an earlier test to start over
+  cycles += 1'000'000;
+
+  std::vector<long long> idle_times;
+
+  for (u32 i = 0; i < 8; i++) {
+    ASSERT_EQ(CPU::Run(1000).status, RunStatus::Idle);
+    idle_times.push_back(GetIdleTime().count());
+
+    // Start() catches up with the time it waited, 16 ms at 4.77 MHz
+    cycles += 76'000;
+    idle_cycles += 76'000;
+  }
+
+  EXPECT_EQ(idle_times, (std::vector<long long>{500, 1'000, 2'000, 4'000,
+                                                8'000, 16'000, 16'000,
+                                                16'000}));
+}
+
+TEST(Run, StartSleepsWhileHalted)
+{
+  // STI; HLT; CLI; HLT
+  LoadProgram({0xFB, 0xF4, 0xFA, 0xF4});
+  AX = 0x0100;
+  AddInterruptSource();
+
+  std::thread thread([] { Start(); });
+
+  // Halted until the interrupt, then the second HLT stops the CPU
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_TRUE(IsRunning());
+  EXPECT_EQ(IP, 2);
+
+  RequestInterrupt(0x16);
+  thread.join();
+  RemoveInterruptSource();
+
+  EXPECT_EQ(IP, 4);
+  EXPECT_FALSE(IsRunning());
+}
+
+TEST(Run, StartStopsHaltedWithoutInterruptSources)
+{
+  // STI; HLT
+  LoadProgram({0xFB, 0xF4});
+
+  std::atomic<bool> returned = false;
+  std::thread thread([&returned] {
+    Start();
+    returned = true;
+  });
+
+  for (u32 i = 0; i < 500 && !returned; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  const bool stopped = returned;
+
+  // Don't hang the test if it didn't
+  if (!stopped)
+    Stop();
+
+  thread.join();
+
+  EXPECT_TRUE(stopped);
+  EXPECT_EQ(IP, 2);
+}
+
+static std::mutex s_state_mutex;
+static std::condition_variable s_state_changed;
+static std::vector<State> s_states;
+
+static void RecordState(State state)
+{
+  std::lock_guard<std::mutex> lock(s_state_mutex);
+  s_states.push_back(state);
+  s_state_changed.notify_all();
+}
+
+static bool WaitForStates(size_t count)
+{
+  std::unique_lock<std::mutex> lock(s_state_mutex);
+  return s_state_changed.wait_for(lock, std::chrono::seconds(5),
+                                  [&] { return s_states.size() >= count; });
+}
+
+TEST(Run, StartReportsEachTransitionOnce)
+{
+  // JMP $
+  LoadProgram({0xEB, 0xFE});
+
+  RegisterStateChangedCallback(&RecordState);
+
+  std::thread thread([] { Start(); });
+
+  ASSERT_TRUE(WaitForStates(1));
+  SetPaused(true);
+  ASSERT_TRUE(WaitForStates(2));
+
+  // Staying paused doesn't report anything
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  SetPaused(false);
+  ASSERT_TRUE(WaitForStates(3));
+  Stop();
+  thread.join();
+
+  UnregisterStateChangedCallback(&RecordState);
+
+  EXPECT_EQ(s_states, (std::vector<State>{State::Running, State::Paused,
+                                          State::Running, State::Stopped}));
+}
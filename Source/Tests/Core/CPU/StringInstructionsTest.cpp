@@ -0,0 +1,156 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Watchpoint.h"
+#include "Core/Memory.h"
+#include "Tests/Core/Program.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace Core::CPU;
+namespace CPU = Core::CPU;
+namespace Memory = Core::Memory;
+
+static void Load(const std::vector<u8>& program)
+{
+  LoadProgram(program);
+  DS = 0x2000;
+  ES = 0x3000;
+  DF = false;
+}
+
+// Fill the segments the tests copy between with something recognizable
+static void Scramble()
+{
+  for (u32 i = 0; i < 0x20000; i++)
+    Memory::Get()[0x20000 + i] = static_cast<u8>(i * 7 + (i >> 8));
+}
+
+// REP STOS or MOVS done the way the 8088 does it, one element at a time
+static std::vector<u8> Expected(bool movs, u32 size, u16 si, u16 di, u16 cx)
+{
+  std::vector<u8> memory(Memory::Get().begin(),
+                         Memory::Get().begin() + Memory::SIZE);
+
+  for (; cx != 0; cx--) {
+    // The whole element gets read before any of it is written
+    u8 element[2] = {AL, AH};
+
+    for (u32 i = 0; movs && i < size; i++)
+      element[i] = memory[Memory::VirtToPhys(DS, static_cast<u16>(si + i))];
+
+    for (u32 i = 0; i < size; i++)
+      memory[Memory::VirtToPhys(ES, static_cast<u16>(di + i))] = element[i];
+
+    si += DF ? -size : size;
+    di += DF ? -size : size;
+  }
+
+  return memory;
+}
+
+static void Check(u8 opcode, u16 si, u16 di, u16 cx, bool df,
+                  u16 es = 0x3000)
+{
+  Load({0xF3, opcode}); // REP STOS/MOVS
+  Scramble();
+
+  ES = es;
+  SI = si;
+  DI = di;
+  CX = cx;
+  DF = df;
+  AX = 0xA55A;
+
+  const bool movs = opcode == 0xA4 || opcode == 0xA5;
+  const u32 size = (opcode & 1) ? 2 : 1;
+  const std::vector<u8> expected = Expected(movs, size, si, di, cx);
+  const u16 step = static_cast<u16>(cx * size);
+
+  CPU::Run(1);
+
+  SCOPED_TRACE(::testing::Message()
+               << "opcode " << int(opcode) << ", SI " << si << ", DI " << di
+               << ", CX " << cx << ", DF " << df);
+
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(),
+                         Memory::Get().begin()));
+  EXPECT_EQ(CX, 0);
+  EXPECT_EQ(DI, static_cast<u16>(df ? di - step : di + step));
+
+  if (movs) {
+    EXPECT_EQ(SI, static_cast<u16>(df ? si - step : si + step));
+  }
+}
+
+TEST(StringInstructions, RepWithoutCountDoesNothing)
+{
+  Load({0xF3, 0xAB}); // REP STOSW
+  Scramble();
+
+  const std::vector<u8> before(Memory::Get().begin(),
+                               Memory::Get().begin() + Memory::SIZE);
+
+  DI = 0x0100;
+  CX = 0;
+
+  const u64 start = cycles;
+
+  CPU::Run(1);
+  EXPECT_EQ(CX, 0);
+  EXPECT_EQ(DI, 0x0100);
+  EXPECT_EQ(IP, 2);
+  EXPECT_EQ(cycles - start, 9u);
+  EXPECT_TRUE(std::equal(before.begin(), before.end(), Memory::Get().begin()));
+}
+
+TEST(StringInstructions, Fill)
+{
+  for (u8 opcode : {0xAA, 0xAB}) {
+    for (bool df : {false, true}) {
+      Check(opcode, 0, 0x0100, 0x0080, df);
+      Check(opcode, 0, 0xFFF0, 0x8000, df);
+      // Wrapping around the segment
+      Check(opcode, 0, 0xFFF0, 0x0020, df);
+      Check(opcode, 0, 0x0010, 0x0020, df);
+      Check(opcode, 0, 0xFFFF, 0x0002, df);
+    }
+  }
+}
+
+TEST(StringInstructions, Copy)
+{
+  for (u8 opcode : {0xA4, 0xA5}) {
+    for (bool df : {false, true}) {
+      Check(opcode, 0x0100, 0x0200, 0x0080, df);
+      Check(opcode, 0xFFF0, 0x0010, 0x0020, df);
+      Check(opcode, 0x0000, 0x0000, 0x8000, df);
+    }
+  }
+}
+
+TEST(StringInstructions, OverlappingCopy)
+{
+  // Copying element by element repeats a pattern when the destination is
+  // ahead of the source in the direction of the copy
+  for (u8 opcode : {0xA4, 0xA5}) {
+    for (bool df : {false, true}) {
+      for (int distance : {-0x40, -3, -2, -1, 1, 2, 3, 0x40})
+        Check(opcode, 0x8000, static_cast<u16>(0x8000 + distance), 0x0100,
+              df, 0x2000);
+    }
+  }
+}
+
+TEST(StringInstructions, WatchedCopy)
+{
+  // Goes through every element, so the watchpoint still sees the read
+  AddWatchpoint({0x20100, 2, WATCH_READ});
+
+  Check(0xA5, 0x0000, 0x0000, 0x0100, false);
+  EXPECT_TRUE(IsWatchpointHit());
+
+  RemoveWatchpoint({0x20100, 2, WATCH_READ});
+}
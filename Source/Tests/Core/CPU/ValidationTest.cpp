@@ -0,0 +1,92 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/Validation.h"
+#include "Core/Memory.h"
+
+#include <gtest/gtest.h>
+
+using namespace Core::CPU;
+using Parameter = Instruction::Parameter;
+using PType = Parameter::Type;
+
+static Instruction Decode(u8 opcode, u8 mod)
+{
+  Instruction ins(opcode);
+
+  if (!ins.IsResolved()) {
+    const u8 data[Instruction::MAX_DATA_LENGTH] = {};
+    EXPECT_TRUE(ins.Resolve(mod, data));
+  }
+
+  return ins;
+}
+
+static Parameter Make(PType type, u32 data = 0)
+{
+  Parameter parameter(type);
+  parameter.Resolve(data);
+
+  return parameter;
+}
+
+TEST(Validation, WellFormedOperands)
+{
+  EXPECT_NO_THROW(ValidateOperands(Decode(0x01, 0xD8))); // ADD AX, BX
+  EXPECT_NO_THROW(ValidateOperands(Decode(0x83, 0x47))); // ADD [BX+0], 0
+  EXPECT_NO_THROW(ValidateOperands(Decode(0x88, 0xC4))); // MOV AH, AL
+  EXPECT_NO_THROW(ValidateOperands(Decode(0xD2, 0xE0))); // SHL AL, CL
+  EXPECT_NO_THROW(ValidateOperands(Decode(0x50, 0x00))); // PUSH AX
+  EXPECT_NO_THROW(ValidateOperands(Decode(0xEB, 0x00))); // JMP short
+  EXPECT_NO_THROW(ValidateOperands(Decode(0xE2, 0x00))); // LOOP
+}
+
+TEST(Validation, LengthMismatch)
+{
+  // MOV AL, AX
+  Instruction mov = Decode(0x88, 0xC0);
+  mov.GetParameter(1) = Make(PType::AX);
+
+  EXPECT_THROW(ValidateOperands(mov), ParameterLengthMismatchException);
+
+  // ADD AL, AX goes through ParameterTo<u8> for its source
+  Instruction add = Decode(0x00, 0xC0);
+  add.GetParameter(1) = Make(PType::AX);
+
+  EXPECT_THROW(ValidateOperands(add), ParameterLengthMismatchException);
+}
+
+TEST(Validation, UnsupportedOperands)
+{
+  // PUSH AL
+  Instruction push = Decode(0x50, 0x00);
+  push.GetParameter(0) = Make(PType::AL);
+
+  EXPECT_THROW(ValidateOperands(push), UnsupportedParameterException);
+
+  // Immediates can't be written to
+  Instruction inc = Decode(0xFE, 0xC0);
+  inc.GetParameter(0) = Make(PType::Literal_Byte, 0x12);
+
+  EXPECT_THROW(ValidateOperands(inc), UnhandledParameterException);
+}
+
+TEST(Validation, ThrowsWhenDecoding)
+{
+  // JMP AX isn't implemented
+  const u8 program[] = {0xFF, 0xE0};
+
+  for (u32 i = 0; i < sizeof(program); i++)
+    Core::Memory::Get()[Core::Memory::VirtToPhys(0x1000, i)] = program[i];
+  Core::Memory::MarkWritten(0x1000, 0, sizeof(program));
+
+  EXPECT_THROW(DecodeInstruction(0x1000, 0), UnhandledParameterException);
+
+  CS = 0x1000;
+  IP = 0;
+
+  // Neither executed nor cached
+  EXPECT_THROW(Tick(), UnhandledParameterException);
+  EXPECT_EQ(IP, 0);
+  EXPECT_THROW(FetchInstruction(0x1000, 0), UnhandledParameterException);
+}
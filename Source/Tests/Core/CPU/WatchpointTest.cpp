@@ -0,0 +1,122 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Watchpoint.h"
+#include "Core/Memory.h"
+#include "Tests/Core/Program.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace Core::CPU;
+namespace CPU = Core::CPU;
+
+static void Load(const std::vector<u8>& program)
+{
+  LoadProgram(program);
+  SetPaused(false);
+  DS = 0x1000;
+  AX = 0;
+}
+
+// MOV AX, [0x0100]; MOV [0x0102], AX; INC word [0x0104]; JMP -12
+static const std::vector<u8> s_program = {0xA1, 0x00, 0x01, 0xA3, 0x02,
+                                          0x01, 0xFF, 0x06, 0x04, 0x01,
+                                          0xEB, 0xF4};
+
+constexpr u32 DATA = 0x10100;
+
+TEST(Watchpoint, Read)
+{
+  Load(s_program);
+
+  AddWatchpoint({DATA, 2, WATCH_READ});
+  EXPECT_TRUE(HasWatchpoints());
+
+  // Stops right after the instruction reading it
+  RunResult result = CPU::Run(100);
+  EXPECT_EQ(result.status, RunStatus::Breakpoint);
+  EXPECT_EQ(result.retired, 1u);
+  EXPECT_EQ(IP, 3);
+  EXPECT_TRUE(IsPaused());
+
+  const auto hit = GetLastWatchpointHit();
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->watchpoint.address, DATA);
+  EXPECT_EQ(hit->access, WATCH_READ);
+  EXPECT_EQ(hit->segment, 0x1000);
+  EXPECT_EQ(hit->offset, 0);
+
+  // Once around the loop
+  SetPaused(false);
+  result = CPU::Run(100);
+  EXPECT_EQ(result.status, RunStatus::Breakpoint);
+  EXPECT_EQ(result.retired, 4u);
+  EXPECT_EQ(IP, 3);
+
+  RemoveWatchpoint({DATA, 2, WATCH_READ});
+  EXPECT_FALSE(HasWatchpoints());
+
+  SetPaused(false);
+  EXPECT_EQ(CPU::Run(100).retired, 100u);
+}
+
+TEST(Watchpoint, Write)
+{
+  Load(s_program);
+
+  // Writes only, the read right before doesn't count
+  AddWatchpoint({DATA, 4, WATCH_WRITE});
+
+  const RunResult result = CPU::Run(100);
+  EXPECT_EQ(result.status, RunStatus::Breakpoint);
+  EXPECT_EQ(result.retired, 2u);
+  EXPECT_EQ(IP, 6);
+  EXPECT_EQ(GetLastWatchpointHit()->access, WATCH_WRITE);
+  EXPECT_EQ(GetLastWatchpointHit()->offset, 3);
+
+  RemoveWatchpoint({DATA, 4, WATCH_WRITE});
+}
+
+TEST(Watchpoint, Change)
+{
+  Load(s_program);
+
+  Core::Memory::Get()[DATA] = 0x12;
+  Core::Memory::Get()[DATA + 2] = 0x12;
+
+  // Writing the value that's there already doesn't change it
+  AddWatchpoint({DATA + 2, 2, WATCH_CHANGE});
+  EXPECT_EQ(CPU::Run(100).status, RunStatus::Completed);
+
+  RemoveWatchpoint({DATA + 2, 2, WATCH_CHANGE});
+
+  // INC does every time
+  Load(s_program);
+  AddWatchpoint({DATA + 4, 1, WATCH_CHANGE});
+
+  const RunResult result = CPU::Run(100);
+  EXPECT_EQ(result.status, RunStatus::Breakpoint);
+  EXPECT_EQ(result.retired, 3u);
+  EXPECT_EQ(IP, 10);
+  EXPECT_EQ(GetLastWatchpointHit()->access, WATCH_CHANGE);
+
+  RemoveWatchpoint({DATA + 4, 1, WATCH_CHANGE});
+}
+
+TEST(Watchpoint, Unwatched)
+{
+  Load(s_program);
+
+  // Same page as the data and the code, but neither is accessed by the CPU.
+  // Fetching instructions doesn't count as reading them
+  AddWatchpoint({DATA + 8, 8, WATCH_READ | WATCH_WRITE | WATCH_CHANGE});
+  AddWatchpoint({0x10000, 12, WATCH_READ});
+
+  EXPECT_EQ(CPU::Run(1000).status, RunStatus::Completed);
+
+  RemoveWatchpoint({DATA + 8, 8, 0});
+  RemoveWatchpoint({0x10000, 12, 0});
+  EXPECT_FALSE(HasWatchpoints());
+  EXPECT_TRUE(GetWatchpoints().empty());
+}
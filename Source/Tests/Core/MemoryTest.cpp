@@ -0,0 +1,290 @@
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/Memory.h"
+#include "Tests/Core/Program.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace Core::CPU;
+namespace CPU = Core::CPU;
+namespace Memory = Core::Memory;
+
+TEST(Memory, AddressesWrapAt1MiB)
+{
+  EXPECT_EQ(Memory::VirtToPhys(0xFFFF, 0x000F), 0xFFFFFu);
+  EXPECT_EQ(Memory::VirtToPhys(0xFFFF, 0x0010), 0x00000u);
+  EXPECT_EQ(Memory::VirtToPhys(0xFFFF, 0xFFFF), 0x0FFEFu);
+  EXPECT_EQ(Memory::VirtToPhys(0x1234, 0x5678), 0x179B8u);
+}
+
+TEST(Memory, BytesWrap)
+{
+  Memory::Write<u8>(0xFFFF, 0x0010, 0x12);
+  EXPECT_EQ(Memory::Get()[0], 0x12);
+  EXPECT_EQ(Memory::Read<u8>(0x0000, 0x0000), 0x12);
+
+  Memory::Write<u8>(0xFFFF, 0xFFFF, 0x34);
+  EXPECT_EQ(Memory::Get()[0x0FFEF], 0x34);
+  EXPECT_EQ(Memory::Read<u8>(0x0FFE, 0x000F), 0x34);
+}
+
+TEST(Memory, WordsWrapAroundTheEndOfMemory)
+{
+  Memory::Write<u16>(0xFFFF, 0x000F, 0xBEEF);
+  EXPECT_EQ(Memory::Get()[0xFFFFF], 0xEF);
+  EXPECT_EQ(Memory::Get()[0x00000], 0xBE);
+
+  EXPECT_EQ(Memory::Read<u16>(0xFFFF, 0x000F), 0xBEEF);
+  EXPECT_EQ(Memory::Read<u16>(0xFFFFF), 0xBEEF);
+}
+
+TEST(Memory, WordsWrapAroundTheEndOfTheSegment)
+{
+  Memory::Write<u16>(0x2000, 0xFFFF, 0xCAFE);
+  EXPECT_EQ(Memory::Get()[0x2FFFF], 0xFE);
+  EXPECT_EQ(Memory::Get()[0x20000], 0xCA);
+
+  EXPECT_EQ(Memory::Read<u16>(0x2000, 0xFFFF), 0xCAFE);
+
+  // FFFF:FFFF wraps within the segment to FFFF:0000, not past 1 MiB
+  Memory::Write<u16>(0xFFFF, 0xFFFF, 0x5AA5);
+  EXPECT_EQ(Memory::Get()[0x0FFEF], 0xA5);
+  EXPECT_EQ(Memory::Get()[0xFFFF0], 0x5A);
+  EXPECT_EQ(Memory::Read<u16>(0xFFFF, 0xFFFF), 0x5AA5);
+}
+
+TEST(Memory, LoadAbove1MiBWraps)
+{
+  LoadProgram({0x8B, 0x07}); // MOV AX, [BX]
+
+  Memory::Get()[0] = 0x78;
+  Memory::Get()[1] = 0x56;
+
+  DS = 0xFFFF;
+  BX = 0x0010;
+  AX = 0;
+
+  const RunResult result = CPU::Run(1);
+  EXPECT_EQ(result.status, RunStatus::Completed);
+  EXPECT_FALSE(HasFault());
+  EXPECT_EQ(AX, 0x5678);
+}
+
+TEST(Memory, OperandsWrapAroundTheEndOfTheSegment)
+{
+  LoadProgram({
+      0x8B, 0x06, 0xFF, 0xFF, // MOV AX, [0xFFFF]
+      0x01, 0x06, 0xFF, 0xFF, // ADD [0xFFFF], AX
+      0xFF, 0x06, 0xFF, 0xFF, // INC word [0xFFFF]
+      0xC5, 0x36, 0xFE, 0xFF, // LDS SI, [0xFFFE]
+  });
+
+  auto& memory = Memory::Get();
+  memory[0x2FFFE] = 0x78;
+  memory[0x2FFFF] = 0x34;
+  memory[0x20000] = 0x12;
+  memory[0x20001] = 0x00;
+  memory[0x30000] = 0xEE;
+
+  DS = 0x2000;
+
+  CPU::Run(1);
+  EXPECT_EQ(AX, 0x1234);
+
+  CPU::Run(1);
+  EXPECT_EQ(memory[0x2FFFF], 0x68);
+  EXPECT_EQ(memory[0x20000], 0x24);
+
+  CPU::Run(1);
+  EXPECT_EQ(memory[0x2FFFF], 0x69);
+  EXPECT_EQ(memory[0x20000], 0x24);
+
+  // The segment comes from offset 0, not from the next paragraph
+  CPU::Run(1);
+  EXPECT_EQ(SI, 0x6978);
+  EXPECT_EQ(DS, 0x0024);
+
+  EXPECT_FALSE(HasFault());
+  EXPECT_EQ(memory[0x30000], 0xEE);
+
+  memory[0x30000] = 0;
+  DS = 0;
+}
+
+TEST(Memory, OperandsWrapAroundTheEndOfMemory)
+{
+  LoadProgram({
+      0x8B, 0x06, 0x0F, 0x00, // MOV AX, [0x000F]
+      0x01, 0x06, 0x0F, 0x00, // ADD [0x000F], AX
+      0x89, 0x1E, 0x0F, 0x00, // MOV [0x000F], BX
+  });
+
+  auto& memory = Memory::Get();
+  memory[0xFFFFF] = 0x22;
+  memory[0x00000] = 0x11;
+  memory[Memory::SIZE] = 0xEE;
+
+  DS = 0xFFFF;
+  BX = 0xBEEF;
+
+  CPU::Run(1);
+  EXPECT_EQ(AX, 0x1122);
+
+  CPU::Run(1);
+  EXPECT_EQ(memory[0xFFFFF], 0x44);
+  EXPECT_EQ(memory[0x00000], 0x22);
+
+  CPU::Run(1);
+  EXPECT_EQ(memory[0xFFFFF], 0xEF);
+  EXPECT_EQ(memory[0x00000], 0xBE);
+
+  EXPECT_FALSE(HasFault());
+  EXPECT_EQ(memory[Memory::SIZE], 0xEE);
+
+  memory[Memory::SIZE] = 0;
+  DS = 0;
+}
+
+TEST(Memory, PushWrapsAroundTheStackSegment)
+{
+  LoadProgram({0x50}); // PUSH AX
+
+  SS = 0x3000;
+  SP = 0x0001;
+  AX = 0x1122;
+
+  CPU::Run(1);
+  EXPECT_EQ(SP, 0xFFFF);
+  EXPECT_EQ(Memory::Get()[0x3FFFF], 0x22);
+  EXPECT_EQ(Memory::Get()[0x30000], 0x11);
+}
+
+TEST(Memory, ROMDropsWrites)
+{
+  Memory::Get()[0x50000] = 0xAA;
+  Memory::MapROM(0x50000, Memory::PAGE_SIZE);
+  EXPECT_EQ(Memory::GetPageType(0x50FFF), Memory::PageType::ROM);
+  EXPECT_EQ(Memory::GetPageType(0x51000), Memory::PageType::RAM);
+
+  Memory::Write<u8>(0x5000, 0x0000, 0x55);
+  Memory::Get<u16>(0x5000, 0x0000) = 0x5555;
+  EXPECT_EQ(Memory::Read<u8>(0x5000, 0x0000), 0xAA);
+
+  LoadProgram({0xA3, 0x00, 0x00}); // MOV [0x0000], AX
+
+  DS = 0x5000;
+  AX = 0x1234;
+
+  CPU::Run(1);
+  EXPECT_EQ(Memory::Get()[0x50000], 0xAA);
+
+  Memory::MapRAM(0x50000, Memory::PAGE_SIZE);
+  EXPECT_EQ(Memory::GetPageType(0x50000), Memory::PageType::RAM);
+
+  Memory::Write<u8>(0x5000, 0x0000, 0x55);
+  EXPECT_EQ(Memory::Get()[0x50000], 0x55);
+
+  DS = 0;
+}
+
+struct Access {
+  u32 address, size;
+  //! First byte there at the time
+  u8 value;
+
+  bool operator==(const Access& o) const
+  {
+    return address == o.address && size == o.size && value == o.value;
+  }
+};
+
+static std::vector<Access> s_reads, s_writes;
+
+static const Memory::Device s_device = {
+    [](u32 address, u32 size) {
+      s_reads.push_back({address, size, Memory::Get()[address]});
+      Memory::Get()[address] = 0x42;
+    },
+    [](u32 address, u32 size) {
+      s_writes.push_back({address, size, Memory::Get()[address]});
+    },
+};
+
+TEST(Memory, DevicesSeeAccesses)
+{
+  Memory::MapDevice(0x60000, 2 * Memory::PAGE_SIZE, s_device);
+  EXPECT_EQ(Memory::GetPageType(0x61FFF), Memory::PageType::Device);
+
+  LoadProgram({
+      0xB9, 0x04, 0x00, // MOV CX, 4
+      0xF3, 0xAB,       // REP STOSW
+      0xA0, 0x00, 0x10, // MOV AL, [0x1000]
+  });
+
+  ES = 0x6000;
+  DS = 0x6000;
+  DI = 0x0FFC;
+  AX = 0x1234;
+
+  // The whole string got written by the time the device is told, in one go
+  // even though it crosses pages
+  CPU::Run(2);
+  EXPECT_EQ(s_writes, (std::vector<Access>{{0x60FFC, 8, 0x34}}));
+  EXPECT_TRUE(s_reads.empty());
+
+  // Reads see what the device put there
+  CPU::Run(1);
+  EXPECT_EQ(s_reads, (std::vector<Access>{{0x61000, 1, 0x34}}));
+  EXPECT_EQ(AL, 0x42);
+
+  // The debugger looking doesn't count
+  EXPECT_EQ(Memory::Peek<u8>(0x61001), 0x12);
+  EXPECT_EQ(s_reads.size(), 1u);
+
+  Memory::MapRAM(0x60000, 2 * Memory::PAGE_SIZE);
+  ES = DS = 0;
+}
+
+TEST(Memory, DirtyPages)
+{
+  Memory::SetDirtyTracking(true);
+  EXPECT_TRUE(Memory::CollectDirtyPages().none());
+
+  LoadProgram({
+      0xB9, 0x00, 0x08, // MOV CX, 0x0800
+      0xF3, 0xAB,       // REP STOSW
+  });
+
+  // Clean again after collecting, loading the program dirtied its page
+  EXPECT_EQ(Memory::CollectDirtyPages().count(), 1u);
+
+  ES = 0x7000;
+  DI = 0x0800;
+
+  // 4 KiB from 0x70800 touch two pages
+  CPU::Run(2);
+
+  const auto dirty = Memory::CollectDirtyPages();
+  EXPECT_EQ(dirty.count(), 2u);
+  EXPECT_TRUE(dirty[0x70]);
+  EXPECT_TRUE(dirty[0x71]);
+
+  Memory::Write<u8>(0x71FFF, 1);
+  Memory::Write<u16>(0x0000, 0x0000, 1);
+  EXPECT_EQ(Memory::CollectDirtyPages().count(), 2u);
+  EXPECT_TRUE(Memory::CollectDirtyPages().none());
+
+  // Dropped writes don't change anything
+  Memory::MapROM(0x70000, Memory::PAGE_SIZE);
+  Memory::Write<u8>(0x70000, 1);
+  EXPECT_TRUE(Memory::CollectDirtyPages().none());
+  Memory::MapRAM(0x70000, Memory::PAGE_SIZE);
+
+  Memory::SetDirtyTracking(false);
+  Memory::Write<u8>(0x70000, 1);
+  EXPECT_TRUE(Memory::CollectDirtyPages().none());
+
+  ES = 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// CPU.h declares CPU::TEST, which has to be seen before gtest's TEST macro
+#include "Core/CPU/CPU.h"
+#include "Core/Memory.h"
+
+#include <vector>
+
+// Copy program to 1000:0000 and point CS:IP at it, without a recorded fault
+inline void LoadProgram(const std::vector<u8>& program)
+{
+  namespace Memory = Core::Memory;
+
+  for (u32 i = 0; i < program.size(); i++)
+    Memory::Get()[Memory::VirtToPhys(0x1000, i)] = program[i];
+  Memory::MarkWritten(0x1000, 0, static_cast<u32>(program.size()));
+
+  Core::CPU::ClearFault();
+  Core::CPU::CS = 0x1000;
+  Core::CPU::IP = 0;
+}
@@ -0,0 +1,71 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/Memory.h"
+
+using namespace Core;
+
+// Nearly every instruction has a memory operand, covering all three mods and
+// most base/index combinations
+static const std::vector<u8> s_program = {
+    0xB9, 0x00, 0x01,       // MOV CX, 0x0100
+    0x8B, 0x00,             // MOV AX, [BX+SI]
+    0x03, 0x41, 0x02,       // ADD AX, [BX+DI+0x02]
+    0x89, 0x42, 0xFC,       // MOV [BP+SI-0x04], AX
+    0x31, 0x83, 0x00, 0x01, // XOR [BP+DI+0x0100], AX
+    0x8A, 0x14,             // MOV DL, [SI]
+    0x00, 0x55, 0x08,       // ADD [DI+0x08], DL
+    0x3B, 0x46, 0x02,       // CMP AX, [BP+0x02]
+    0x8B, 0x16, 0x40, 0x00, // MOV DX, [0x0040]
+    0x21, 0x97, 0x80, 0x00, // AND [BX+0x0080], DX
+    0xFF, 0x47, 0x10,       // INC word [BX+0x10]
+    0x8D, 0x70, 0x01,       // LEA SI, [BX+SI+0x01]
+    0x81, 0xE6, 0xFF, 0x0F, // AND SI, 0x0FFF
+    0xE2, 0xD8,             // LOOP 0x0003
+    0xEB, 0xD3,             // JMP 0x0000
+};
+
+static void RunProgram(const std::string& name)
+{
+  constexpr u64 INSTRUCTIONS = 1 << 22;
+
+  std::copy(s_program.begin(), s_program.end(),
+            Memory::Get().begin() + Memory::VirtToPhys(0x1000, 0));
+  Memory::MarkWritten(0x1000, 0, static_cast<u32>(s_program.size()));
+
+  CPU::CS = 0x1000;
+  CPU::IP = 0;
+  CPU::DS = CPU::ES = 0x2000;
+  CPU::SS = 0x3000;
+  CPU::BX = 0x0100;
+  CPU::BP = 0x0200;
+  CPU::SI = CPU::DI = 0;
+
+  CPU::use_instruction_cache = true;
+  CPU::FlushInstructionCache();
+
+  const double seconds = Bench::Measure([] {
+    for (u64 i = 0; i < INSTRUCTIONS; i++)
+      CPU::Tick();
+  });
+
+  Bench::Report(name, INSTRUCTIONS, seconds, "ins");
+}
+
+void Bench::Addressing()
+{
+  CPU::dispatch_mode = CPU::DispatchMode::Switch;
+  RunProgram("addressing (switch)");
+
+  CPU::dispatch_mode = CPU::DispatchMode::Threaded;
+  RunProgram("addressing (threaded)");
+}
@@ -0,0 +1,94 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#pragma once
+//! \file
+
+#include <chrono>
+#include <string>
+
+#include "Common/Types.h"
+
+//! Tiny harness shared by all micro-benchmarks
+namespace Bench
+{
+//! Time a callable and return the elapsed wall-clock time in seconds
+template <typename F> double Measure(F&& f)
+{
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double>(end - start).count();
+}
+
+//! Print a result line in a uniform format
+void Report(const std::string& name, u64 operations, double seconds,
+            const std::string& unit);
+
+//! Keep the optimizer from discarding a value
+template <typename T> void DoNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+  static const volatile void* sink;
+  sink = &value;
+#else
+  asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+/**
+ * @brief Hardware branch-miss counter of the calling thread. Only Linux
+ * provides one, and even there it may not be accessible.
+ */
+class BranchMisses
+{
+public:
+  BranchMisses();
+  ~BranchMisses();
+
+  BranchMisses(const BranchMisses&) = delete;
+  BranchMisses& operator=(const BranchMisses&) = delete;
+
+  bool IsAvailable() const { return m_fd >= 0; }
+
+  void Start();
+  //! Misses since Start()
+  u64 Stop();
+
+private:
+  int m_fd = -1;
+};
+
+//! Guest code dominated by memory operands
+void Addressing();
+
+//! Run() with no, a few and many breakpoints set, none of them hit
+void Breakpoints();
+
+//! Evaluating breakpoint conditions and tracepoints
+void Conditions();
+
+//! Decode throughput on a mixed opcode stream
+void Decode();
+
+//! ALU operations and arithmetic-heavy guest code, i.e. flag handling
+void Flags();
+
+//! Tick() throughput on a small guest loop
+void Interpreter();
+
+//! Loads and stores of guest memory, and 64 KiB REP STOSW and MOVSW, with
+//! and without dirty page tracking
+void Memory();
+
+//! Host CPU time Start() uses while the CPU is paused
+void Pause();
+
+//! Run() against a loop of Tick() calls that each may throw
+void Step();
+
+//! Interleaved byte and word ALU code, with branch misses if available
+void Widths();
+} // namespace Bench
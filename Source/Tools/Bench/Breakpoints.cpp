@@ -0,0 +1,73 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Core/CPU/Breakpoint.h"
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/JIT.h"
+#include "Core/Memory.h"
+
+using namespace Core;
+
+static const std::vector<u8> s_program = {
+    0xB9, 0x00, 0x01, // MOV CX, 0x0100
+    0x40,             // INC AX
+    0x01, 0xC3,       // ADD BX, AX
+    0x4A,             // DEC DX
+    0x89, 0xC6,       // MOV SI, AX
+    0xE2, 0xF8,       // LOOP 0x0003
+    0xEB, 0xF3,       // JMP 0x0000
+};
+
+constexpr u64 INSTRUCTIONS = 1 << 22;
+
+// Far from the code, so none of them is ever hit
+static CPU::Breakpoint At(u32 i)
+{
+  return {static_cast<u16>(0x8000 + (i >> 12)), static_cast<u16>(i * 3)};
+}
+
+static void RunWith(u32 count)
+{
+  for (u32 i = 0; i < count; i++)
+    CPU::AddBreakpoint(At(i));
+
+  CPU::CS = 0x1000;
+  CPU::IP = 0;
+  CPU::ClearFault();
+
+  const double seconds = Bench::Measure([] {
+    for (u64 i = 0; i < INSTRUCTIONS; i += 4096)
+      CPU::Run(4096);
+  });
+
+  Bench::Report("breakpoints (" + std::to_string(count) + " set)",
+                INSTRUCTIONS, seconds, "ins");
+
+  for (u32 i = 0; i < count; i++)
+    CPU::RemoveBreakpoint(At(i));
+}
+
+void Bench::Breakpoints()
+{
+  CPU::use_jit = false;
+  CPU::use_instruction_cache = true;
+  CPU::dispatch_mode = CPU::DispatchMode::Threaded;
+  CPU::FlushInstructionCache();
+
+  std::copy(s_program.begin(), s_program.end(),
+            Memory::Get().begin() + Memory::VirtToPhys(0x1000, 0));
+  Memory::MarkWritten(0x1000, 0, static_cast<u32>(s_program.size()));
+
+  RunWith(0);
+  RunWith(10);
+  RunWith(10'000);
+}
@@ -0,0 +1,94 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Core/CPU/Breakpoint.h"
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/Expression.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/JIT.h"
+#include "Core/Memory.h"
+
+using namespace Core;
+
+static const std::vector<u8> s_program = {
+    0xB9, 0x00, 0x01, // MOV CX, 0x0100
+    0x40,             // INC AX
+    0x01, 0xC3,       // ADD BX, AX
+    0x4A,             // DEC DX
+    0x89, 0xC6,       // MOV SI, AX
+    0xE2, 0xF8,       // LOOP 0x0003
+    0xEB, 0xF3,       // JMP 0x0000
+};
+
+constexpr u64 EVALUATIONS = 1 << 22;
+constexpr u64 INSTRUCTIONS = 1 << 22;
+
+static void EvaluateOne(const std::string& name, const std::string& text)
+{
+  const auto expression = CPU::Expression::Compile(text);
+
+  u32 sum = 0;
+
+  const double seconds = Bench::Measure([&] {
+    for (u64 i = 0; i < EVALUATIONS; i++)
+      sum += expression->Evaluate();
+  });
+
+  Bench::DoNotOptimize(sum);
+  Bench::Report("conditions (" + name + ")", EVALUATIONS, seconds, "evals");
+}
+
+// Run() with something at the INC, which runs every 5th instruction
+static void RunWith(const std::string& name, void (*arm)())
+{
+  arm();
+
+  CPU::CS = 0x1000;
+  CPU::IP = 0;
+  CPU::ClearFault();
+
+  const double seconds = Bench::Measure([] {
+    for (u64 i = 0; i < INSTRUCTIONS; i += 4096) {
+      CPU::Run(4096);
+      CPU::TakeTraceRecords();
+    }
+  });
+
+  Bench::Report("conditions (run, " + name + ")", INSTRUCTIONS, seconds,
+                "ins");
+
+  CPU::RemoveBreakpoint({0x1000, 0x0003});
+}
+
+void Bench::Conditions()
+{
+  CPU::use_jit = false;
+  CPU::use_instruction_cache = true;
+  CPU::dispatch_mode = CPU::DispatchMode::Threaded;
+  CPU::FlushInstructionCache();
+
+  std::copy(s_program.begin(), s_program.end(),
+            Memory::Get().begin() + Memory::VirtToPhys(0x1000, 0));
+  Memory::MarkWritten(0x1000, 0, static_cast<u32>(s_program.size()));
+
+  EvaluateOne("register", "ax == 0x4c00");
+  EvaluateOne("memory", "ax == 0x4c00 && byte[ds:si] != 0");
+  EvaluateOne("mixed", "(cx & 0xff) * 3 + word[ss:sp] > di || zf");
+
+  // Never true, so they never pause
+  RunWith("no condition", [] {});
+  RunWith("condition", [] {
+    CPU::AddConditionalBreakpoint({0x1000, 0x0003}, "ax == 0xffff && cx == 0");
+  });
+  RunWith("tracepoint", [] {
+    CPU::AddTracepoint({0x1000, 0x0003}, "", "ax, byte[ds:si]");
+  });
+}
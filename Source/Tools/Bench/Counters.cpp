@@ -0,0 +1,71 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#if defined(__linux__)
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Bench
+{
+#if defined(__linux__)
+BranchMisses::BranchMisses()
+{
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+BranchMisses::~BranchMisses()
+{
+  if (IsAvailable())
+    close(m_fd);
+}
+
+void BranchMisses::Start()
+{
+  if (!IsAvailable())
+    return;
+
+  ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+  ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+u64 BranchMisses::Stop()
+{
+  if (!IsAvailable())
+    return 0;
+
+  ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+  u64 count = 0;
+  if (read(m_fd, &count, sizeof(count)) != sizeof(count))
+    return 0;
+
+  return count;
+}
+#else
+BranchMisses::BranchMisses() {}
+
+BranchMisses::~BranchMisses() {}
+
+void BranchMisses::Start() {}
+
+u64 BranchMisses::Stop() { return 0; }
+#endif
+} // namespace Bench
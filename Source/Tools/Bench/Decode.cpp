@@ -0,0 +1,94 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#include <random>
+#include <vector>
+
+#include "Core/CPU/Instruction.h"
+
+using Core::CPU::Instruction;
+
+// A representative mix of encodings: register/immediate moves, ALU forms with
+// every ModRM width, stack operations, branches, string ops and group opcodes.
+static const std::vector<std::vector<u8>> s_encodings = {
+    {0x90},                   // NOP
+    {0x40},                   // INC AX
+    {0x4B},                   // DEC BX
+    {0x50},                   // PUSH AX
+    {0x5B},                   // POP BX
+    {0xAA},                   // STOSB
+    {0xA5},                   // MOVSW
+    {0xF8},                   // CLC
+    {0xB8, 0x34, 0x12},       // MOV AX, 0x1234
+    {0xB1, 0x10},             // MOV CL, 0x10
+    {0x04, 0x01},             // ADD AL, 0x01
+    {0x3D, 0x00, 0x4C},       // CMP AX, 0x4C00
+    {0x75, 0xFE},             // JNZ -2
+    {0xE2, 0xFC},             // LOOP -4
+    {0xEB, 0x02},             // JMP +2
+    {0xE8, 0x00, 0x10},       // CALL +0x1000
+    {0x01, 0xD8},             // ADD AX, BX
+    {0x31, 0xC0},             // XOR AX, AX
+    {0x88, 0x07},             // MOV [BX], AL
+    {0x8B, 0x46, 0x04},       // MOV AX, [BP+4]
+    {0x89, 0x84, 0x00, 0x01}, // MOV [SI+0x100], AX
+    {0x8B, 0x1E, 0x00, 0x02}, // MOV BX, [0x200]
+    {0x80, 0xC3, 0x05},       // ADD BL, 5
+    {0x83, 0xF9, 0x08},       // CMP CX, 8
+    {0xD1, 0xE0},             // SHL AX, 1
+    {0xFE, 0xC0},             // INC AL
+    {0xFF, 0x06, 0x00, 0x03}, // INC word [0x300]
+    {0xF7, 0xE3},             // MUL BX
+    {0x26, 0x88, 0x05},       // MOV ES:[DI], AL
+    {0xCD, 0x21},             // INT 0x21
+};
+
+void Bench::Decode()
+{
+  constexpr size_t STREAM_LENGTH = 1 << 16;
+  constexpr u32 PASSES = 64;
+
+  std::mt19937 rng(0xA9E);
+  std::uniform_int_distribution<size_t> pick(0, s_encodings.size() - 1);
+
+  std::vector<u8> stream;
+  u64 count = 0;
+
+  while (stream.size() < STREAM_LENGTH) {
+    const auto& encoding = s_encodings[pick(rng)];
+    stream.insert(stream.end(), encoding.begin(), encoding.end());
+    count++;
+  }
+
+  // Padding so the final instruction may safely read ahead
+  stream.resize(stream.size() + 8);
+
+  const double seconds = Measure([&] {
+    for (u32 pass = 0; pass < PASSES; pass++) {
+      size_t offset = 0;
+
+      for (u64 i = 0; i < count; i++) {
+        const u32 address = static_cast<u32>(offset);
+        Instruction ins(stream[offset++], address);
+
+        while (ins.IsPrefix())
+          ins = Instruction(ins, stream[offset++], address);
+
+        if (!ins.IsResolved()) {
+          u8 mod = stream[offset++];
+          u8 length = ins.GetLength(mod);
+
+          ins.Resolve(mod, &stream[offset]);
+          offset += length;
+        }
+
+        DoNotOptimize(ins);
+      }
+    }
+  });
+
+  Report("decode", count * PASSES, seconds, "ins");
+}
@@ -0,0 +1,97 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/Instructions/Operations.h"
+#include "Core/Memory.h"
+
+using namespace Core;
+
+// Arithmetic-heavy checksum loop, only the LOOP's CX and a single JNZ look at
+// anything the ALU produces
+static const std::vector<u8> s_program = {
+    0xB9, 0x00, 0x01, // MOV CX, 0x0100
+    0x01, 0xC8,       // ADD AX, CX
+    0x11, 0xC3,       // ADC BX, AX
+    0x29, 0xDA,       // SUB DX, BX
+    0x19, 0xC6,       // SBB SI, AX
+    0x31, 0xF7,       // XOR DI, SI
+    0x21, 0xD5,       // AND BP, DX
+    0x09, 0xF8,       // OR AX, DI
+    0x40,             // INC AX
+    0x4B,             // DEC BX
+    0x39, 0xD0,       // CMP AX, DX
+    0x75, 0x00,       // JNZ 0x0017
+    0xE2, 0xEA,       // LOOP 0x0003
+    0xEB, 0xE5,       // JMP 0x0000
+};
+
+void Bench::Flags()
+{
+  constexpr u64 OPERATIONS = 1 << 24;
+
+  // The ALU operations on their own
+  u16 a = 1, b = 2, c = 3;
+  bool taken = false;
+
+  double seconds = Measure([&] {
+    for (u64 i = 0; i < OPERATIONS; i += 4) {
+      CPU::Operations::Add::Apply<u16>(a, b);
+      CPU::Operations::Sub::Apply<u16>(b, c);
+      CPU::Operations::Xor::Apply<u16>(c, a);
+      CPU::Operations::Inc::Apply(a);
+
+      // Something has to read them once in a while
+      if ((i & 0xFF) == 0)
+        taken ^= CPU::ZF;
+    }
+  });
+
+  DoNotOptimize(taken);
+  Report("flags (operations)", OPERATIONS, seconds, "op");
+
+  // Worst case, every flag of every result gets read
+  u8 sum = 0;
+
+  seconds = Measure([&] {
+    for (u64 i = 0; i < OPERATIONS; i += 2) {
+      CPU::Operations::Add::Apply<u16>(a, b);
+      sum += CPU::CF + CPU::PF + CPU::AF + CPU::ZF + CPU::SF + CPU::OF;
+
+      u8 byte = static_cast<u8>(i);
+      CPU::Operations::Sub::Apply<u8>(byte, static_cast<u8>(a));
+      sum += CPU::CF + CPU::PF + CPU::AF + CPU::ZF + CPU::SF + CPU::OF;
+    }
+  });
+
+  DoNotOptimize(sum);
+  Report("flags (all read)", OPERATIONS, seconds, "op");
+
+  // The same kind of work as guest code
+  constexpr u64 INSTRUCTIONS = 1 << 22;
+
+  std::copy(s_program.begin(), s_program.end(),
+            Memory::Get().begin() + Memory::VirtToPhys(0x1000, 0));
+  Memory::MarkWritten(0x1000, 0, static_cast<u32>(s_program.size()));
+
+  CPU::CS = 0x1000;
+  CPU::IP = 0;
+  CPU::use_instruction_cache = true;
+  CPU::dispatch_mode = CPU::DispatchMode::Threaded;
+  CPU::FlushInstructionCache();
+
+  seconds = Measure([] {
+    for (u64 i = 0; i < INSTRUCTIONS; i++)
+      CPU::Tick();
+  });
+
+  Report("flags (guest loop)", INSTRUCTIONS, seconds, "ins");
+}
@@ -0,0 +1,96 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/JIT.h"
+#include "Core/Memory.h"
+
+using namespace Core;
+
+// A small loop mixing memory operands, ALU ops, the stack and branches
+static const std::vector<u8> s_program = {
+    0xB9, 0x00, 0x01, // MOV CX, 0x0100
+    0x8B, 0x40, 0x04, // MOV AX, [BX+SI+4]
+    0x01, 0xC8,       // ADD AX, CX
+    0x89, 0x40, 0x04, // MOV [BX+SI+4], AX
+    0x46,             // INC SI
+    0x31, 0xC2,       // XOR DX, AX
+    0x50,             // PUSH AX
+    0x5A,             // POP DX
+    0x3D, 0x34, 0x12, // CMP AX, 0x1234
+    0xD1, 0xE2,       // SHL DX, 1
+    0xE2, 0xEC,       // LOOP 0x0003
+    0xEB, 0xE7,       // JMP 0x0000
+};
+
+// Either steps itself like the run loop used to, or lets Run() do it
+static void RunProgram(const std::string& name, bool batched = false)
+{
+  constexpr u64 INSTRUCTIONS = 1 << 22;
+
+  std::copy(s_program.begin(), s_program.end(),
+            Memory::Get().begin() + Memory::VirtToPhys(0x1000, 0));
+  Memory::MarkWritten(0x1000, 0, static_cast<u32>(s_program.size()));
+
+  CPU::CS = 0x1000;
+  CPU::IP = 0;
+  CPU::DS = CPU::ES = CPU::SS = 0x2000;
+  CPU::SP = 0xFFFE;
+  CPU::BX = CPU::SI = 0;
+
+  u64 executed = 0;
+
+  const double seconds = Bench::Measure([&] {
+    while (batched && executed < INSTRUCTIONS)
+      executed += CPU::Run(INSTRUCTIONS - executed).retired;
+
+    while (executed < INSTRUCTIONS) {
+      const u64 translated = CPU::GetJITStats().instructions;
+
+      if (CPU::ExecuteBlock()) {
+        executed += CPU::GetJITStats().instructions - translated;
+      } else {
+        CPU::Tick();
+        executed++;
+      }
+    }
+  });
+
+  Bench::Report(name, executed, seconds, "ins");
+}
+
+void Bench::Interpreter()
+{
+  CPU::dispatch_mode = CPU::DispatchMode::Switch;
+  CPU::use_instruction_cache = false;
+  RunProgram("interpreter (decode)");
+
+  CPU::use_instruction_cache = true;
+  CPU::FlushInstructionCache();
+  RunProgram("interpreter (icache, switch)");
+
+  CPU::dispatch_mode = CPU::DispatchMode::Threaded;
+  CPU::FlushInstructionCache();
+  RunProgram("interpreter (icache, threaded)");
+
+  CPU::FlushInstructionCache();
+  RunProgram("interpreter (icache, run)", true);
+
+  if (CPU::IsJITAvailable()) {
+    CPU::use_jit = true;
+    CPU::FlushTranslations();
+    RunProgram("interpreter (jit)");
+
+    CPU::FlushTranslations();
+    RunProgram("interpreter (jit, run)", true);
+    CPU::use_jit = false;
+  }
+}
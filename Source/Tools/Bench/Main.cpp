@@ -0,0 +1,96 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Common/ParameterParser.h"
+#include "Version.h"
+
+#include "Tools/Bench/Bench.h"
+
+struct Benchmark {
+  std::string name;
+  std::string description;
+  std::function<void()> fnc;
+};
+
+static const std::vector<Benchmark> s_benchmarks = {
+    {"addressing", "Guest code dominated by memory operands",
+     Bench::Addressing},
+    {"breakpoints", "Run() with breakpoints set elsewhere",
+     Bench::Breakpoints},
+    {"conditions", "Conditional breakpoints and tracepoints",
+     Bench::Conditions},
+    {"decode", "Instruction decoding on a mixed opcode stream", Bench::Decode},
+    {"flags", "ALU operations and arithmetic-heavy guest code", Bench::Flags},
+    {"interpreter", "Tick() on a small guest loop", Bench::Interpreter},
+    {"memory", "Guest memory loads and stores", Bench::Memory},
+    {"pause", "Host CPU usage while paused", Bench::Pause},
+    {"step", "Run() against Tick() in a try block", Bench::Step},
+    {"widths", "Interleaved byte and word ALU code", Bench::Widths},
+};
+
+void Bench::Report(const std::string& name, u64 operations, double seconds,
+                   const std::string& unit)
+{
+  std::cout << std::left << std::setw(32) << name << std::right
+            << std::setw(14) << std::fixed << std::setprecision(2)
+            << (operations / seconds / 1'000'000.0) << " M" << unit << "/s"
+            << std::setw(12) << std::setprecision(3) << seconds << " s"
+            << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  std::cerr << "Ape " << VERSION_STRING << " Benchmarks" << std::endl
+            << "(c) Ape Emulator Project, 2018" << std::endl
+            << std::endl;
+
+  ParameterParser p;
+
+  p.AddString("run");
+  p.AddCommand("list");
+  p.AddCommand("help");
+
+  if (!p.Parse(argc, argv)) {
+    std::cerr << "Failed to parse parameters." << std::endl
+              << "See --help for a list of options" << std::endl;
+    return 1;
+  }
+
+  if (p.CheckCommand("help")) {
+    std::cerr << "Usage: " << argv[0] << " [--list] [--run (benchmark)]"
+              << std::endl;
+    return 1;
+  }
+
+  if (p.CheckCommand("list")) {
+    for (const auto& b : s_benchmarks)
+      std::cout << std::left << std::setw(16) << b.name << b.description
+                << std::endl;
+    return 0;
+  }
+
+  const auto& filter = p.GetString("run");
+  bool ran = false;
+
+  for (const auto& b : s_benchmarks) {
+    if (!filter.empty() && filter != b.name)
+      continue;
+
+    b.fnc();
+    ran = true;
+  }
+
+  if (!ran) {
+    std::cerr << "Unknown benchmark " << filter << ". See --list" << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/Memory.h"
+
+using namespace Core;
+
+constexpr u64 ACCESSES = 1 << 26;
+
+// Walks a whole segment, so the wrapping at its end is part of it
+constexpr u16 SEGMENT = 0x2000;
+
+// Fills a whole segment over and over
+static const std::vector<u8> s_fill = {
+    0xB9, 0x00, 0x80, // MOV CX, 0x8000
+    0x31, 0xFF,       // XOR DI, DI
+    0xF3, 0xAB,       // REP STOSW
+    0xEB, 0xF7,       // JMP 0x0000
+};
+
+// Copies a whole segment over and over
+static const std::vector<u8> s_copy = {
+    0xB9, 0x00, 0x80, // MOV CX, 0x8000
+    0x31, 0xF6,       // XOR SI, SI
+    0x31, 0xFF,       // XOR DI, DI
+    0xF3, 0xA5,       // REP MOVSW
+    0xEB, 0xF5,       // JMP 0x0000
+};
+
+// Runs a pass of program, made of instructions instructions, over and over
+static void RunString(const std::string& name,
+                      const std::vector<u8>& program, u64 instructions,
+                      bool collect)
+{
+  constexpr u64 PASSES = 1 << 12;
+
+  std::copy(program.begin(), program.end(),
+            Memory::Get().begin() + Memory::VirtToPhys(0x1000, 0));
+  Memory::MarkWritten(0x1000, 0, static_cast<u32>(program.size()));
+
+  CPU::CS = 0x1000;
+  CPU::IP = 0;
+  CPU::DS = SEGMENT;
+  CPU::ES = SEGMENT + 0x1000;
+  CPU::DF = false;
+  CPU::use_instruction_cache = true;
+  CPU::FlushInstructionCache();
+
+  u64 dirty = 0;
+
+  const double seconds = Bench::Measure([&] {
+    for (u64 i = 0; i < PASSES; i++) {
+      CPU::Run(instructions);
+
+      // Every page is clean again for the next pass
+      if (collect)
+        dirty += Memory::CollectDirtyPages().count();
+    }
+  });
+
+  Bench::DoNotOptimize(dirty);
+  Bench::Report(name, PASSES * 0x10000, seconds, "B");
+
+  CPU::DS = CPU::ES = 0;
+}
+
+void Bench::Memory()
+{
+  u32 sum = 0;
+
+  double seconds = Measure([&] {
+    for (u64 i = 0; i < ACCESSES; i++)
+      sum += Memory::Read<u8>(SEGMENT, static_cast<u16>(i * 7));
+  });
+
+  DoNotOptimize(sum);
+  Report("memory (read byte)", ACCESSES, seconds, "acc");
+
+  seconds = Measure([&] {
+    for (u64 i = 0; i < ACCESSES; i++)
+      sum += Memory::Read<u16>(SEGMENT, static_cast<u16>(i * 7));
+  });
+
+  DoNotOptimize(sum);
+  Report("memory (read word)", ACCESSES, seconds, "acc");
+
+  seconds = Measure([] {
+    for (u64 i = 0; i < ACCESSES; i++)
+      Memory::Write<u16>(SEGMENT, static_cast<u16>(i * 7),
+                         static_cast<u16>(i));
+  });
+
+  DoNotOptimize(Memory::Get());
+  Report("memory (write word)", ACCESSES, seconds, "acc");
+
+  seconds = Measure([&] {
+    for (u64 i = 0; i < ACCESSES; i++) {
+      const u16 offset = static_cast<u16>(i * 7);
+
+      Memory::Write<u16>(SEGMENT, offset,
+                         Memory::Read<u16>(SEGMENT, offset) + 1);
+    }
+  });
+
+  DoNotOptimize(Memory::Get());
+  Report("memory (read-modify-write)", ACCESSES, seconds, "acc");
+
+  RunString("memory (rep stosw)", s_fill, 4, false);
+  RunString("memory (rep movsw)", s_copy, 5, false);
+
+  Memory::SetDirtyTracking(true);
+  RunString("memory (rep stosw, dirty)", s_fill, 4, true);
+  Memory::SetDirtyTracking(false);
+}
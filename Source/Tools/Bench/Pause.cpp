@@ -0,0 +1,61 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Core/CPU/CPU.h"
+#include "Core/Memory.h"
+
+using namespace Core;
+
+// JMP $
+static const std::vector<u8> s_program = {0xEB, 0xFE};
+
+constexpr std::chrono::milliseconds PAUSED_TIME{1000};
+
+void Bench::Pause()
+{
+  std::copy(s_program.begin(), s_program.end(),
+            Memory::Get().begin() + Memory::VirtToPhys(0x1000, 0));
+  Memory::MarkWritten(0x1000, 0, static_cast<u32>(s_program.size()));
+
+  CPU::CS = 0x1000;
+  CPU::IP = 0;
+  CPU::ClearFault();
+  CPU::pause_on_boot = false;
+
+  std::thread thread([] { CPU::Start(); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  CPU::SetPaused(true);
+
+  // Give the CPU thread time to notice
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // CPU time of the whole process, so this includes the CPU thread
+  const std::clock_t start = std::clock();
+  const double seconds =
+      Measure([] { std::this_thread::sleep_for(PAUSED_TIME); });
+  const std::clock_t end = std::clock();
+
+  CPU::SetPaused(false);
+  CPU::Stop();
+  thread.join();
+
+  const double cpu = static_cast<double>(end - start) / CLOCKS_PER_SEC;
+
+  std::cout << std::left << std::setw(32) << "pause (host cpu while paused)"
+            << std::right << std::setw(14) << std::fixed
+            << std::setprecision(2) << cpu / seconds * 100 << " %"
+            << std::setw(15) << std::setprecision(3) << seconds << " s"
+            << std::endl;
+}
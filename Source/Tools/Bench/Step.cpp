@@ -0,0 +1,92 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/CPU/JIT.h"
+#include "Core/Memory.h"
+
+using namespace Core;
+
+// Short instructions, so the loop around them matters
+static const std::vector<u8> s_program = {
+    0xB9, 0x00, 0x01, // MOV CX, 0x0100
+    0x40,             // INC AX
+    0x01, 0xC3,       // ADD BX, AX
+    0x4A,             // DEC DX
+    0x89, 0xC6,       // MOV SI, AX
+    0xE2, 0xF8,       // LOOP 0x0003
+    0xEB, 0xF3,       // JMP 0x0000
+};
+
+constexpr u64 INSTRUCTIONS = 1 << 22;
+
+static void Reset()
+{
+  std::copy(s_program.begin(), s_program.end(),
+            Memory::Get().begin() + Memory::VirtToPhys(0x1000, 0));
+  Memory::MarkWritten(0x1000, 0, static_cast<u32>(s_program.size()));
+
+  CPU::CS = 0x1000;
+  CPU::IP = 0;
+  CPU::ClearFault();
+}
+
+// Checks the result of every step
+static void RunSteps(const std::string& name, u64 batch)
+{
+  Reset();
+
+  u64 faults = 0;
+
+  const double seconds = Bench::Measure([&] {
+    for (u64 i = 0; i < INSTRUCTIONS; i += batch) {
+      if (CPU::Run(batch).status == CPU::RunStatus::Fault)
+        faults++;
+    }
+  });
+
+  Bench::DoNotOptimize(faults);
+  Bench::Report(name, INSTRUCTIONS, seconds, "ins");
+}
+
+void Bench::Step()
+{
+  CPU::use_jit = false;
+  CPU::use_instruction_cache = true;
+  CPU::dispatch_mode = CPU::DispatchMode::Threaded;
+  CPU::FlushInstructionCache();
+
+  // What callers had to do before faults got recorded: every step may throw
+  Reset();
+
+  u64 faults = 0;
+
+  double seconds = Measure([&] {
+    for (u64 i = 0; i < INSTRUCTIONS; i++) {
+      try {
+        CPU::Tick();
+      } catch (const CPU::CPUException&) {
+        faults++;
+      }
+    }
+  });
+
+  DoNotOptimize(faults);
+  Report("step (tick, try per step)", INSTRUCTIONS, seconds, "ins");
+
+  RunSteps("step (run, 1 per call)", 1);
+  RunSteps("step (run, 4096 per call)", 4096);
+
+  // Every instruction gets fetched from memory and decoded again
+  CPU::use_instruction_cache = false;
+  RunSteps("step (run, uncached)", 4096);
+  CPU::use_instruction_cache = true;
+}
@@ -0,0 +1,93 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include "Tools/Bench/Bench.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Core/CPU/CPU.h"
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/Memory.h"
+
+using namespace Core;
+
+// Byte and word forms of the same operations back to back, so a handler that
+// still branches on the width keeps guessing wrong
+static const std::vector<u8> s_program = {
+    0xB9, 0x00, 0x01,       // MOV CX, 0x0100
+    0x01, 0xD8,             // ADD AX, BX
+    0x00, 0xD8,             // ADD AL, BL
+    0x83, 0xC2, 0xFF,       // ADD DX, -1
+    0x11, 0x47, 0x02,       // ADC [BX+0x02], AX
+    0x10, 0x67, 0x03,       // ADC [BX+0x03], AH
+    0x29, 0xC6,             // SUB SI, AX
+    0x28, 0xE2,             // SUB DL, AH
+    0x83, 0xDE, 0x01,       // SBB SI, 1
+    0x31, 0xF7,             // XOR DI, SI
+    0x30, 0xD4,             // XOR AH, DL
+    0x21, 0xD5,             // AND BP, DX
+    0x20, 0xE6,             // AND DH, AH
+    0xD1, 0xE7,             // SHL DI, 1
+    0xD0, 0xEE,             // SHR DH, 1
+    0xD1, 0xC5,             // ROL BP, 1
+    0xD0, 0xC8,             // ROR AL, 1
+    0xF7, 0xDE,             // NEG SI
+    0xF6, 0xDA,             // NEG DL
+    0x39, 0xD0,             // CMP AX, DX
+    0x38, 0xF4,             // CMP AH, DH
+    0xE2, 0xD2,             // LOOP 0x0003
+    0xEB, 0xCD,             // JMP 0x0000
+};
+
+static void RunProgram(const std::string& name)
+{
+  constexpr u64 INSTRUCTIONS = 1 << 22;
+
+  std::copy(s_program.begin(), s_program.end(),
+            Memory::Get().begin() + Memory::VirtToPhys(0x1000, 0));
+  Memory::MarkWritten(0x1000, 0, static_cast<u32>(s_program.size()));
+
+  CPU::CS = 0x1000;
+  CPU::IP = 0;
+  CPU::DS = CPU::ES = CPU::SS = 0x2000;
+  CPU::BX = 0;
+
+  CPU::use_instruction_cache = true;
+  CPU::FlushInstructionCache();
+
+  Bench::BranchMisses misses;
+
+  misses.Start();
+  const double seconds = Bench::Measure([] {
+    for (u64 i = 0; i < INSTRUCTIONS; i++)
+      CPU::Tick();
+  });
+  const u64 missed = misses.Stop();
+
+  Bench::Report(name, INSTRUCTIONS, seconds, "ins");
+
+  std::cout << std::left << std::setw(32) << "  branch misses" << std::right
+            << std::setw(14);
+
+  if (misses.IsAvailable())
+    std::cout << std::fixed << std::setprecision(3)
+              << static_cast<double>(missed) / INSTRUCTIONS << " /ins";
+  else
+    std::cout << "n/a";
+
+  std::cout << std::endl;
+}
+
+void Bench::Widths()
+{
+  CPU::dispatch_mode = CPU::DispatchMode::Switch;
+  RunProgram("widths (switch)");
+
+  CPU::dispatch_mode = CPU::DispatchMode::Threaded;
+  RunProgram("widths (threaded)");
+}
@@ -71,7 +71,7 @@ int main(int argc, char** argv)
 
     auto ins = Instruction(opcode, address);
 
-    if (ins.IsPrefix())
+    while (ins.IsPrefix())
       ins = Instruction(ins, static_cast<u8>(ifs.get()), address);
 
     std::cout << String::ToHex(address) << " ";
@@ -0,0 +1,570 @@
+// Copyright 2018 Ape Emulator Project
+// Licensed under GPLv3+
+// Refer to the LICENSE file included.
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Common/Logger.h"
+#include "Common/ParameterParser.h"
+#include "Common/String.h"
+#include "Common/Types.h"
+#include "Version.h"
+
+#include "Core/CPU/Dispatch.h"
+#include "Core/CPU/Exception.h"
+#include "Core/CPU/Instruction.h"
+#include "Core/CPU/InstructionCache.h"
+#include "Core/Memory.h"
+
+using namespace Core::CPU;
+
+using Type = Instruction::Type;
+using PType = Instruction::Parameter::Type;
+
+// COM files get loaded right after the PSP
+constexpr u16 LOAD_OFFSET = 0x100;
+// Segment the image is decoded from. Generated code works with any segment
+constexpr u16 DECODE_SEGMENT = 0x1000;
+
+struct Decoded {
+  Instruction instruction;
+  u16 offset;
+  u16 next;
+};
+
+std::string Label(u16 offset)
+{
+  return "L_" + String::ToHex(offset).substr(2);
+}
+
+//! Name of the CPU global holding a register, empty if there is none
+std::string RegisterName(PType type)
+{
+  switch (type) {
+  case PType::AL:
+    return "AL";
+  case PType::AH:
+    return "AH";
+  case PType::BL:
+    return "BL";
+  case PType::BH:
+    return "BH";
+  case PType::CL:
+    return "CL";
+  case PType::CH:
+    return "CH";
+  case PType::DL:
+    return "DL";
+  case PType::DH:
+    return "DH";
+  case PType::AX:
+    return "AX";
+  case PType::BX:
+    return "BX";
+  case PType::CX:
+    return "CX";
+  case PType::DX:
+    return "DX";
+  case PType::DS:
+    return "DS";
+  case PType::ES:
+    return "ES";
+  case PType::SS:
+    return "SS";
+  case PType::BP:
+    return "BP";
+  case PType::SP:
+    return "SP";
+  case PType::DI:
+    return "DI";
+  case PType::SI:
+    return "SI";
+  default:
+    return "";
+  }
+}
+
+bool IsImmediate(PType type)
+{
+  return type == PType::Literal_Byte || type == PType::Literal_Byte_Immediate ||
+         type == PType::Literal_Word || type == PType::Literal_Word_Immediate;
+}
+
+bool IsBranch(Type type)
+{
+  switch (type) {
+  case Type::JMP:
+  case Type::JZ:
+  case Type::JNZ:
+  case Type::JC:
+  case Type::JNC:
+  case Type::JCXZ:
+  case Type::JPE:
+  case Type::JNS:
+  case Type::JNO:
+  case Type::JNE:
+  case Type::JL:
+  case Type::JLE:
+  case Type::JG:
+  case Type::JGE:
+  case Type::JA:
+  case Type::JB:
+  case Type::JNB:
+  case Type::JPO:
+  case Type::JO:
+  case Type::JS:
+  case Type::JBE:
+  case Type::LOOPNZ:
+  case Type::LOOPZ:
+  case Type::LOOP:
+  case Type::CALL:
+    return true;
+  default:
+    return false;
+  }
+}
+
+//! Whether execution can continue with the next instruction
+bool FallsThrough(const Instruction& ins)
+{
+  switch (ins.GetType()) {
+  case Type::JMP:
+  case Type::CALL:
+  case Type::RET:
+  case Type::RETF:
+  case Type::IRET:
+  case Type::HLT:
+    return false;
+  default:
+    return true;
+  }
+}
+
+//! Branch targets that can be found without running the program
+bool GetStaticTarget(const Decoded& decoded, u16& target)
+{
+  const auto& ins = decoded.instruction;
+
+  if (!IsBranch(ins.GetType()) || ins.GetParameterCount() != 1)
+    return false;
+
+  const auto& parameter = ins.GetParameters()[0];
+
+  switch (parameter.GetType()) {
+  case PType::Literal_Offset:
+    target = static_cast<u16>(decoded.next + parameter.GetData<i8>());
+    return true;
+  case PType::Literal_WordOffset:
+    target = static_cast<u16>(decoded.next + parameter.GetData<i16>());
+    return true;
+  default:
+    return false;
+  }
+}
+
+//! Follow every statically known path through the program
+std::map<u16, Decoded> Traverse(u32 image_size)
+{
+  std::map<u16, Decoded> code;
+  std::vector<u16> pending = {LOAD_OFFSET};
+
+  const u32 end = LOAD_OFFSET + image_size;
+
+  while (!pending.empty()) {
+    const u16 offset = pending.back();
+    pending.pop_back();
+
+    if (offset < LOAD_OFFSET || offset >= end || code.count(offset))
+      continue;
+
+    Decoded decoded;
+
+    try {
+      decoded.instruction = DecodeInstruction(DECODE_SEGMENT, offset);
+    } catch (const CPUException& e) {
+      WARN("Not translating " + String::ToHex(offset) + ": " + e.what());
+      continue;
+    }
+
+    decoded.offset = offset;
+    decoded.next = static_cast<u16>(offset + decoded.instruction.GetSize());
+
+    if (offset + decoded.instruction.GetSize() > end) {
+      WARN("Instruction at " + String::ToHex(offset) +
+           " runs past the end of the file");
+      continue;
+    }
+
+    code[offset] = decoded;
+
+    u16 target;
+
+    if (GetStaticTarget(decoded, target))
+      pending.push_back(target);
+
+    // Calls return right behind themselves
+    if (FallsThrough(decoded.instruction) ||
+        decoded.instruction.GetType() == Type::CALL)
+      pending.push_back(decoded.next);
+  }
+
+  return code;
+}
+
+//! Try to express the instruction directly in C++. Only forms that are
+//! guaranteed to behave exactly like their handler qualify
+bool EmitNative(std::ostream& out, const Instruction& ins)
+{
+  const auto& parameters = ins.GetParameters();
+
+  if (ins.GetParameterCount() == 1) {
+    const std::string dst = RegisterName(parameters[0].GetType());
+    const std::string width = parameters[0].IsWord() ? "u16" : "u8";
+
+    if (dst.empty())
+      return false;
+
+    switch (ins.GetType()) {
+    case Type::INC:
+      out << "  Operations::Inc::Apply<" << width << ">(" << dst << ");\n";
+      return true;
+    case Type::DEC:
+      out << "  Operations::Dec::Apply<" << width << ">(" << dst << ");\n";
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  if (ins.GetParameterCount() != 2 ||
+      parameters[0].IsWord() != parameters[1].IsWord())
+    return false;
+
+  const std::string dst = RegisterName(parameters[0].GetType());
+  const std::string width = parameters[0].IsWord() ? "u16" : "u8";
+  std::string src = RegisterName(parameters[1].GetType());
+
+  if (IsImmediate(parameters[1].GetType())) {
+    src = parameters[0].IsWord()
+              ? String::ToHex(parameters[1].GetData<u16>())
+              : String::ToHex(parameters[1].GetData<u8>());
+  }
+
+  if (dst.empty() || src.empty())
+    return false;
+
+  std::string operation;
+
+  switch (ins.GetType()) {
+  case Type::MOV:
+    out << "  " << dst << " = " << src << ";\n";
+    return true;
+  case Type::ADD:
+    operation = "Add";
+    break;
+  case Type::SUB:
+    operation = "Sub";
+    break;
+  case Type::CMP:
+    operation = "Cmp";
+    break;
+  case Type::AND:
+    operation = "And";
+    break;
+  case Type::TEST:
+    operation = "Test";
+    break;
+  case Type::OR:
+    operation = "Or";
+    break;
+  case Type::XOR:
+    operation = "Xor";
+    break;
+  default:
+    return false;
+  }
+
+  out << "  Operations::" << operation << "::Apply<" << width << ">(" << dst
+      << ", " << src << ");\n";
+
+  return true;
+}
+
+//! Continue at `to` if the instruction at `from` left IP there
+void EmitJump(std::ostream& out, const std::map<u16, Decoded>& code,
+              u16 from, u16 to)
+{
+  out << "  if (IP == " << String::ToHex(to) << ") {\n";
+
+  const auto it = code.find(to);
+
+  if (it == code.end() || !HasHandler(it->second.instruction))
+    out << "    goto dispatch;\n";
+  else {
+    // Backward jumps are where loops of inlined instructions spend their
+    // time, so check for pending work there
+    if (to <= from)
+      out << "    if (HasPendingWork())\n      return retired;\n";
+
+    out << "    goto " << Label(to) << ";\n";
+  }
+
+  out << "  }\n";
+}
+
+void EmitInstruction(std::ostream& out, const std::map<u16, Decoded>& code,
+                     const Decoded& decoded, u32 index)
+{
+  const auto& ins = decoded.instruction;
+
+  std::string disasm = ins.ToString();
+  disasm.erase(disasm.find_last_not_of(' ') + 1);
+
+  // Only reached by falling through from translated code
+  if (!HasHandler(ins)) {
+    out << "  // " << String::ToHex(decoded.offset) << ": " << disasm
+        << " is left to the interpreter\n";
+    out << "  return retired;\n";
+    return;
+  }
+
+  out << Label(decoded.offset) << ": // " << disasm << "\n";
+
+  out << "  if (retired == max_instructions || cycles >= cycle_limit)\n"
+      << "    return retired;\n";
+  out << "  retired++;\n";
+  out << "  cycles += " << ins.GetCycles() << ";\n";
+
+  out << "  LAST_IP = " << String::ToHex(decoded.offset) << ";\n";
+  out << "  IP = " << String::ToHex(decoded.next) << ";\n";
+
+  if (EmitNative(out, ins))
+    return;
+
+  out << "  Handle(" << index << ");\n";
+  out << "  if (!IsRecompiledCodeValid() || HasPendingWork())\n"
+      << "    return retired;\n";
+
+  switch (ins.GetType()) {
+  case Type::HLT:
+  case Type::INT:
+  case Type::INTO:
+    // These may stop the CPU
+    out << "  return retired;\n";
+    return;
+  default:
+    break;
+  }
+
+  u16 target;
+
+  if (GetStaticTarget(decoded, target)) {
+    EmitJump(out, code, decoded.offset, target);
+  }
+
+  if (IsBranch(ins.GetType()) && FallsThrough(ins)) {
+    EmitJump(out, code, decoded.offset, decoded.next);
+  }
+
+  if (IsBranch(ins.GetType()) || !FallsThrough(ins)) {
+    out << "  goto dispatch;\n";
+    return;
+  }
+
+  // Following instructions would have to be fetched from another segment
+  if (ins.GetParameterCount() > 0 &&
+      ins.GetParameters()[0].GetType() == PType::CS)
+    out << "  goto dispatch;\n";
+}
+
+void Emit(std::ostream& out, const std::string& file,
+          const std::vector<u8>& image, const std::map<u16, Decoded>& code,
+          const std::string& symbol, bool main)
+{
+  out << "// Generated by Ape's Recompile tool from " << file << "\n"
+      << "// Do not edit, regenerate it instead.\n\n"
+      << "#include <array>\n";
+
+  if (main)
+    out << "#include <string>\n";
+
+  out << "\n#include \"Core/CPU/CPU.h\"\n"
+      << "#include \"Core/CPU/InstructionCache.h\"\n"
+      << "#include \"Core/CPU/Instructions/Operations.h\"\n"
+      << "#include \"Core/CPU/Recompiled.h\"\n";
+
+  if (main)
+    out << "#include \"Core/Core.h\"\n";
+
+  out << "\nusing namespace Core::CPU;\n\nnamespace\n{\n";
+
+  out << "const u8 s_image[] = {";
+
+  for (size_t i = 0; i < image.size(); i++)
+    out << (i % 12 == 0 ? "\n    " : " ") << String::ToHex(image[i]) << ",";
+
+  out << "\n};\n\n";
+
+  out << "const u16 s_offsets[] = {";
+  for (const auto& [offset, decoded] : code)
+    out << String::ToHex(offset) << ", ";
+  out << "};\n\n";
+
+  out << "const u8 s_sizes[] = {";
+  for (const auto& [offset, decoded] : code)
+    out << static_cast<u32>(decoded.instruction.GetSize()) << ", ";
+  out << "};\n\n";
+
+  out << "constexpr u32 COUNT = " << code.size() << ";\n\n"
+      << "std::array<Instruction, COUNT> s_code;\n"
+      << "bool s_decoded = false;\n\n"
+      << "void Handle(u32 index) { s_code[index].GetHandler()(s_code[index]); "
+         "}\n\n";
+
+  out << "u32 Run(u32 max_instructions, u64 cycle_limit)\n{\n"
+      << "  if (!s_decoded) {\n"
+      << "    for (u32 i = 0; i < COUNT; i++)\n"
+      << "      s_code[i] = DecodeInstruction(CS, s_offsets[i]);\n\n"
+      << "    s_decoded = true;\n"
+      << "  }\n\n"
+      << "  u32 retired = 0;\n\n"
+      << "  goto enter;\n\n"
+      << "dispatch:\n"
+      << "  if (CS != GetRecompiledSegment() || !IsRecompiledCodeValid() ||\n"
+      << "      HasPendingWork())\n"
+      << "    return retired;\n\n"
+      << "enter:\n"
+      << "  LAST_CS = CS;\n\n"
+      << "  switch (IP) {\n";
+
+  // Instructions without a handler are left to the interpreter, which is also
+  // what gets them to fault
+  for (const auto& [offset, decoded] : code) {
+    if (HasHandler(decoded.instruction))
+      out << "  case " << String::ToHex(offset) << ":\n    goto "
+          << Label(offset) << ";\n";
+  }
+
+  out << "  default:\n    return retired;\n  }\n\n";
+
+  u32 index = 0;
+  auto it = code.begin();
+
+  while (it != code.end()) {
+    const Decoded& decoded = it->second;
+
+    EmitInstruction(out, code, decoded, index++);
+
+    ++it;
+
+    // Carry on with the next instruction if it doesn't directly follow
+    if (FallsThrough(decoded.instruction) &&
+        (it == code.end() || it->first != decoded.next)) {
+      EmitJump(out, code, decoded.offset, decoded.next);
+      out << "  goto dispatch;\n";
+    }
+
+    out << "\n";
+  }
+
+  out << "  goto dispatch;\n}\n} // namespace\n\n";
+
+  out << "extern const RecompiledProgram " << symbol << ";\n"
+      << "const RecompiledProgram " << symbol
+      << " = {s_image, sizeof(s_image), s_offsets, s_sizes, COUNT, &Run};\n";
+
+  if (main) {
+    out << "\nint main(int argc, char** argv)\n{\n"
+        << "  std::string parameters;\n\n"
+        << "  for (int i = 1; i < argc; i++)\n"
+        << "    parameters += (i > 1 ? \" \" : \"\") + std::string(argv[i]);"
+           "\n\n"
+        << "  return Core::BootRecompiledCOM(" << symbol
+        << ", parameters) ? 0 : 1;\n}\n";
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::cerr << "Ape " << VERSION_STRING << " COM Recompiler" << std::endl
+            << "(c) Ape Emulator Project, 2018" << std::endl
+            << std::endl;
+
+  ParameterParser p;
+
+  p.AddString("file");
+  p.AddString("output");
+  p.AddString("symbol");
+  p.AddCommand("no-main");
+  p.AddCommand("help");
+
+  if (!p.Parse(argc, argv)) {
+    std::cerr << "Failed to parse parameters." << std::endl
+              << "See --help for a list of options" << std::endl;
+  }
+
+  if (p.CheckCommand("help")) {
+    std::cerr << "Usage: " << argv[0]
+              << " --file (file) [--output (file)] [--symbol (name)]"
+                 " [--no-main]"
+              << std::endl;
+    return 1;
+  }
+
+  const auto& file = p.GetString("file");
+
+  if (file == "") {
+    std::cerr << "No file to recompile provided. Exiting." << std::endl;
+    return 2;
+  }
+
+  std::ifstream ifs(file, std::ios::binary);
+
+  if (!ifs.good()) {
+    ERROR("Failed to open " + file);
+    return 1;
+  }
+
+  const std::vector<u8> image((std::istreambuf_iterator<char>(ifs)),
+                              std::istreambuf_iterator<char>());
+
+  if (image.empty() || image.size() > 0x10000 - LOAD_OFFSET) {
+    ERROR(file + " is not a valid COM file");
+    return 1;
+  }
+
+  // Decode with the emulator's own decoder, straight from emulated memory
+  std::copy(image.begin(), image.end(),
+            Core::Memory::Get().begin() +
+                Core::Memory::VirtToPhys(DECODE_SEGMENT, LOAD_OFFSET));
+
+  const auto code = Traverse(static_cast<u32>(image.size()));
+
+  std::cerr << "Translated " << code.size() << " instructions" << std::endl;
+
+  const std::string symbol =
+      p.GetString("symbol") != "" ? p.GetString("symbol") : "recompiled";
+
+  if (p.GetString("output") == "") {
+    Emit(std::cout, file, image, code, symbol, !p.CheckCommand("no-main"));
+    return 0;
+  }
+
+  std::ofstream ofs(p.GetString("output"));
+
+  if (!ofs.good()) {
+    ERROR("Failed to open " + p.GetString("output"));
+    return 1;
+  }
+
+  Emit(ofs, file, image, code, symbol, !p.CheckCommand("no-main"));
+
+  return 0;
+}